@@ -0,0 +1,173 @@
+#include "bench_support.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <random>
+#include <string_view>
+
+namespace {
+
+// Each block carries its size in front of it, so operator delete knows how much is freed.
+constexpr std::size_t kBlockHeader = alignof(std::max_align_t);
+
+std::atomic<std::size_t> allocations{0};
+std::atomic<std::size_t> liveBytes{0};
+std::atomic<std::size_t> peakBytes{0};
+std::atomic<std::size_t> baselineBytes{0};
+
+void* allocate(std::size_t size) {
+    void* block = std::malloc(size + kBlockHeader);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *static_cast<std::size_t*>(block) = size;
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    std::size_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return static_cast<char*>(block) + kBlockHeader;
+}
+
+void release(void* pointer) {
+    if (!pointer) {
+        return;
+    }
+    void* block = static_cast<char*>(pointer) - kBlockHeader;
+    liveBytes.fetch_sub(*static_cast<std::size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+constexpr std::string_view kWords[] = {
+    "Bier", "Wein", "Grüntee", "Café", "Crème", "Käse", "Brötchen", "Schokolade",
+    "Mineralwasser", "Apfelsaft", "Rüebli", "Müesli", "Zopf", "Espresso", "Gipfeli", "Rosé",
+    "Salami", "Glacé", "Birnel", "Nüsse", "Orangina", "Tee", "Joghurt", "Spätzli",
+};
+
+constexpr std::string_view kSizes[] = {"3dl", "5dl", "1l", "1.5l", "100g", "250g", "500g", "1kg", "klein", "gross"};
+
+void appendNumber(std::string& out, std::uint64_t value, int minDigits = 1) {
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0 || count < minDigits);
+    while (count != 0) {
+        out += digits[--count];
+    }
+}
+
+// Twelve digits from `value` and the GS1 check digit behind them.
+void appendEan13(std::string& out, std::uint64_t value) {
+    char digits[13];
+    for (int i = 11; i >= 0; --i) {
+        digits[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    unsigned sum = 0;
+    for (int i = 0; i < 12; ++i) {
+        sum += static_cast<unsigned>(digits[i] - '0') * (i % 2 == 0 ? 1 : 3);
+    }
+    digits[12] = static_cast<char>('0' + (10 - sum % 10) % 10);
+    out.append(digits, 13);
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    release(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    release(pointer);
+}
+
+namespace cashsloth::bench {
+
+void resetAllocationStats() {
+    allocations.store(0);
+    baselineBytes.store(liveBytes.load());
+    peakBytes.store(liveBytes.load());
+}
+
+AllocationStats allocationStats() {
+    return AllocationStats{allocations.load(), peakBytes.load() - baselineBytes.load()};
+}
+
+void keep(std::size_t value) {
+    static std::atomic<std::size_t> sink{0};
+    sink.fetch_add(value, std::memory_order_relaxed);
+}
+
+std::string syntheticCatalogue(std::size_t articles, std::uint64_t seed) {
+    constexpr std::size_t kCategories = 100;
+    std::mt19937_64 random(seed);
+    std::string out;
+    out.reserve(articles * 190 + 4096);
+    out += "{\"version\": 1, \"categories\": [\n";
+    for (std::size_t category = 0; category < kCategories; ++category) {
+        out += "  {\"name\": \"Kategorie ";
+        appendNumber(out, category);
+        out += ' ';
+        out += kWords[category % std::size(kWords)];
+        out += "\", \"articles\": [\n";
+        const std::size_t first = articles * category / kCategories;
+        const std::size_t last = articles * (category + 1) / kCategories;
+        for (std::size_t article = first; article < last; ++article) {
+            out += "    {\"name\": \"";
+            out += kWords[random() % std::size(kWords)];
+            out += ' ';
+            out += kWords[random() % std::size(kWords)];
+            out += ' ';
+            out += kSizes[random() % std::size(kSizes)];
+            out += " Nr. ";
+            appendNumber(out, article);
+            out += "\", \"price\": ";
+            const std::uint64_t rappen = 5 + random() % 20000;
+            appendNumber(out, rappen / 100);
+            out += '.';
+            appendNumber(out, rappen % 100, 2);
+            out += ", \"barcode\": ";
+            const std::uint64_t kind = random() % 10;
+            if (kind < 7) {
+                out += '"';
+                appendEan13(out, 761000000000ull + article);
+                out += '"';
+            } else if (kind < 9) {
+                out += '"';
+                appendNumber(out, 1000 + article % 90000);
+                out += '"';
+            } else {
+                out += "null";
+            }
+            out += ", \"vendor_meta\": {\"sku\": \"S";
+            appendNumber(out, random() % 1000000, 6);
+            out += "\", \"vat\": 8.1, \"tags\": [\"a\", \"b\"]}}";
+            out += article + 1 < last ? ",\n" : "\n";
+        }
+        out += category + 1 < kCategories ? "  ]},\n" : "  ]}\n";
+    }
+    out += "]}\n";
+    return out;
+}
+
+} // namespace cashsloth::bench
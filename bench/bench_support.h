@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+// Shared by the programs in bench/, which are not part of the till. Every benchmark is
+// linked with bench_support.cpp, whose operator new counts the heap traffic of the code
+// under test.
+namespace cashsloth::bench {
+
+struct AllocationStats {
+    std::size_t allocations = 0;
+    // Largest number of bytes held at once since the last reset, beyond what was held then.
+    std::size_t peakBytes = 0;
+};
+
+void resetAllocationStats();
+AllocationStats allocationStats();
+
+// Runs `run` `repetitions` times and returns the fastest run in milliseconds, which is the
+// least disturbed by other work on the machine.
+template <typename Run>
+double bestMilliseconds(int repetitions, Run&& run) {
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < repetitions; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+// Keeps the compiler from dropping a result that is otherwise unused.
+void keep(std::size_t value);
+
+// A catalogue in the "categories" layout with `articles` articles spread over 100
+// categories, shaped like a supplier export: German names with umlauts and accents, prices
+// with two decimals, EAN-13 codes, PLUs and articles without a code, and vendor metadata
+// that the till skips. The same seed gives the same text.
+std::string syntheticCatalogue(std::size_t articles, std::uint64_t seed = 1);
+
+} // namespace cashsloth::bench
@@ -0,0 +1,128 @@
+// Type-ahead search on synthetic catalogues of increasing size: the time and heap it takes to
+// build the CatalogueSearch index and the latency of a query against it, next to a scan
+// that folds nothing at query time but compares the query with every article name, which is
+// what a search without an index has to do. Queries are what a cashier types: short
+// prefixes, whole words with and without umlauts, digits from an article number and text
+// that matches nothing.
+//
+//     cash-sloth-catalogue-search-bench [articles...]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "bench_support.h"
+#include "cash_sloth_catalogue.h"
+#include "cash_sloth_catalogue_search.h"
+
+namespace {
+
+// Roughly one screen of tiles.
+constexpr std::size_t kLimit = 24;
+
+constexpr std::string_view kQueries[] = {
+    "g", "gr", "grue", "gruentee", "Grüntee", "Käse", "tee", "nr. 4711", "schokolade 1kg", "xyz",
+};
+
+// Ranks like CatalogueSearch, article names only: names that start with the query, then
+// names with a word that does, then names that contain it, shorter names first.
+std::vector<std::size_t> scan(const std::vector<std::string>& folded, std::string_view query, std::size_t limit) {
+    const std::string needle = cashsloth::foldSearchText(query);
+    std::vector<std::tuple<int, std::size_t, std::size_t>> matches;
+    for (std::size_t article = 0; article < folded.size(); ++article) {
+        const std::string& name = folded[article];
+        const std::size_t at = name.find(needle);
+        if (at == std::string::npos) {
+            continue;
+        }
+        int tier = at == 0 ? 0 : 2;
+        for (std::size_t word = at; tier == 2 && word != std::string::npos; word = name.find(needle, word + 1)) {
+            if (name[word - 1] == ' ') {
+                tier = 1;
+            }
+        }
+        matches.emplace_back(tier, name.size(), article);
+    }
+    const std::size_t count = std::min(limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(count), matches.end());
+    std::vector<std::size_t> result;
+    result.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        result.push_back(std::get<2>(matches[i]));
+    }
+    return result;
+}
+
+// Best of five runs of `repetitions` calls, in microseconds per call.
+template <typename Run>
+double microsecondsPerCall(int repetitions, Run&& run) {
+    return cashsloth::bench::bestMilliseconds(5, [&] {
+        for (int i = 0; i < repetitions; ++i) {
+            run();
+        }
+    }) * 1e3 / repetitions;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(static_cast<std::size_t>(std::strtoull(argv[i], nullptr, 10)));
+    }
+    if (sizes.empty()) {
+        sizes = {10'000, 100'000, 500'000};
+    }
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "cash_sloth_bench_search.json";
+
+    for (const std::size_t articles : sizes) {
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << cashsloth::bench::syntheticCatalogue(articles);
+        }
+        cashsloth::Catalogue catalogue;
+        if (!catalogue.loadFromFile(path, cashsloth::Catalogue::SnapshotCache::Bypass)) {
+            std::fprintf(stderr, "catalogue did not load\n");
+            return 1;
+        }
+        const cashsloth::CatalogueStore& store = catalogue.store();
+
+        cashsloth::bench::resetAllocationStats();
+        const double buildMilliseconds = cashsloth::bench::bestMilliseconds(3, [&] {
+            const cashsloth::CatalogueSearch search(store);
+            cashsloth::bench::keep(search.find("a", 1).size());
+        });
+        const cashsloth::bench::AllocationStats stats = cashsloth::bench::allocationStats();
+        std::printf("%zu articles: index built in %.1f ms, %.1f MiB peak\n", articles, buildMilliseconds,
+                    static_cast<double>(stats.peakBytes) / (1024.0 * 1024.0));
+
+        const cashsloth::CatalogueSearch search(store);
+        std::vector<std::string> folded;
+        folded.reserve(store.articleCount());
+        for (std::size_t article = 0; article < store.articleCount(); ++article) {
+            folded.push_back(cashsloth::foldSearchText(store.name(article)));
+        }
+
+        std::printf("  %-18s %8s %12s %12s\n", "query", "matches", "index us", "scan us");
+        for (const std::string_view query : kQueries) {
+            const std::size_t matches = search.find(query, kLimit).size();
+            const double indexed = microsecondsPerCall(100, [&] {
+                cashsloth::bench::keep(search.find(query, kLimit).size());
+            });
+            const double scanned = microsecondsPerCall(3, [&] {
+                cashsloth::bench::keep(scan(folded, query, kLimit).size());
+            });
+            std::printf("  %-18.*s %8zu %12.2f %12.1f\n", static_cast<int>(query.size()), query.data(), matches,
+                        indexed, scanned);
+        }
+    }
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+    return 0;
+}
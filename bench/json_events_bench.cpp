@@ -0,0 +1,122 @@
+// Parse time and peak heap use of the ways a catalogue can be read: the JsonValue tree
+// alone, the tree walked into Category objects as the catalogue used to be loaded, the
+// JsonDocument tape with and without copying strings, the event API with a handler that keeps nothing, and Catalogue::loadFromFile, which streams
+// the file through JsonCursor and also builds the search index and display strings.
+//
+//     cash-sloth-json-events-bench [articles...]
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bench_support.h"
+#include "cash_sloth_catalogue.h"
+#include "cash_sloth_json.h"
+#include "cash_sloth_json_document.h"
+
+namespace {
+
+using cashsloth::JsonValue;
+
+class CountingHandler : public cashsloth::JsonHandler {
+public:
+    void onNull() override { ++events; }
+    void onBool(bool) override { ++events; }
+    void onNumber(double) override { ++events; }
+    void onString(std::string_view) override { ++events; }
+    void onKey(std::string_view) override { ++events; }
+    void onStartObject() override { ++events; }
+    void onEndObject() override { ++events; }
+    void onStartArray() override { ++events; }
+    void onEndArray() override { ++events; }
+
+    std::size_t events = 0;
+};
+
+std::vector<cashsloth::Category> categoriesFromTree(const JsonValue& root) {
+    std::vector<cashsloth::Category> categories;
+    for (const JsonValue& categoryValue : root.asObject().at("categories").asArray()) {
+        const JsonValue::Object& category = categoryValue.asObject();
+        cashsloth::Category& target = categories.emplace_back();
+        target.name = category.at("name").asString();
+        for (const JsonValue& articleValue : category.at("articles").asArray()) {
+            const JsonValue::Object& article = articleValue.asObject();
+            const cashsloth::JsonNumber& price = article.at("price").asDecimal();
+            const JsonValue& barcode = article.at("barcode");
+            target.articles.push_back(cashsloth::Article{
+                article.at("name").asString(),
+                cashsloth::Money::fromDecimal(price.mantissa(), price.exponent()).value_or(cashsloth::Money()),
+                barcode.isString() ? barcode.asString() : std::string()});
+        }
+    }
+    return categories;
+}
+
+template <typename Run>
+void report(const char* label, std::size_t bytes, Run&& run) {
+    cashsloth::bench::resetAllocationStats();
+    run();
+    const cashsloth::bench::AllocationStats stats = cashsloth::bench::allocationStats();
+    const double milliseconds = cashsloth::bench::bestMilliseconds(3, run);
+    std::printf("  %-34s %9.1f ms %8.1f MB/s %11zu allocs %8.1f MiB peak\n", label, milliseconds,
+                static_cast<double>(bytes) / 1e3 / milliseconds, stats.allocations,
+                static_cast<double>(stats.peakBytes) / (1024.0 * 1024.0));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(static_cast<std::size_t>(std::strtoull(argv[i], nullptr, 10)));
+    }
+    if (sizes.empty()) {
+        sizes = {10'000, 100'000, 300'000};
+    }
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "cash_sloth_bench_catalogue.json";
+
+    for (const std::size_t articles : sizes) {
+        const std::string text = cashsloth::bench::syntheticCatalogue(articles);
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << text;
+        }
+        std::printf("%zu articles, %.1f MB of JSON\n", articles, static_cast<double>(text.size()) / 1e6);
+
+        report("JsonParser::parse() tree", text.size(), [&] {
+            const JsonValue root = cashsloth::JsonParser(text).parse();
+            cashsloth::bench::keep(root.asObject().size());
+        });
+        report("tree walked into categories", text.size(), [&] {
+            const std::vector<cashsloth::Category> categories = categoriesFromTree(cashsloth::JsonParser(text).parse());
+            cashsloth::bench::keep(categories.size());
+        });
+        report("JsonDocument::parse() tape", text.size(), [&] {
+            const cashsloth::JsonDocument document = cashsloth::JsonDocument::parse(text);
+            cashsloth::bench::keep(document.root().asObject().size());
+        });
+        report("JsonDocument::parseInPlace() tape", text.size(), [&] {
+            const cashsloth::JsonDocument document = cashsloth::JsonDocument::parseInPlace(text);
+            cashsloth::bench::keep(document.root().asObject().size());
+        });
+        report("JsonParser::parse(handler) events", text.size(), [&] {
+            CountingHandler handler;
+            cashsloth::JsonParser(text).parse(handler);
+            cashsloth::bench::keep(handler.events);
+        });
+        report("Catalogue::loadFromFile", text.size(), [&] {
+            cashsloth::Catalogue catalogue;
+            if (!catalogue.loadFromFile(path, cashsloth::Catalogue::SnapshotCache::Bypass)) {
+                std::fprintf(stderr, "catalogue did not load\n");
+                std::exit(1);
+            }
+            cashsloth::bench::keep(catalogue.store().articleCount());
+        });
+    }
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Number parsing: JsonNumber::parse on number tokens against copying each token into a
+// std::string for std::stod, the way the parser used to read them, and the event parser
+// over a document that is almost only numbers (prices, quantities, RGB channels, metrics).
+// Reports nanoseconds per number and heap allocations.
+//
+//     cash-sloth-json-number-bench [numbers]
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bench_support.h"
+#include "cash_sloth_json.h"
+
+namespace {
+
+class SummingHandler : public cashsloth::JsonHandler {
+public:
+    void onNumber(double value) override {
+        sum += value;
+        ++numbers;
+    }
+
+    double sum = 0.0;
+    std::size_t numbers = 0;
+};
+
+// A mix of the number shapes catalogues and stylesheets contain. Full-precision metrics are
+// longer than a std::string holds without allocating.
+std::vector<std::string> numberTokens(std::size_t count) {
+    std::mt19937_64 random(4);
+    std::vector<std::string> tokens;
+    tokens.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint64_t value = random();
+        std::string token;
+        switch (i % 6) {
+        case 0:
+        case 1:
+            token = std::to_string(value % 20000 / 100);
+            token += '.';
+            token += std::to_string(10 + value % 90);
+            break;
+        case 2:
+            token = std::to_string(value % 256);
+            break;
+        case 3:
+            token = "-";
+            token += std::to_string(value % 1000);
+            token += ".5";
+            break;
+        case 4:
+            token = std::to_string(value % 10);
+            token += '.';
+            token += std::to_string(100000000000000 + value % 900000000000000);
+            token += "e-3";
+            break;
+        default:
+            token = std::to_string(value % 100000000);
+            break;
+        }
+        tokens.push_back(std::move(token));
+    }
+    return tokens;
+}
+
+template <typename Run>
+void report(const char* label, std::size_t numbers, Run&& run) {
+    cashsloth::bench::resetAllocationStats();
+    run();
+    const std::size_t allocations = cashsloth::bench::allocationStats().allocations;
+    const double milliseconds = cashsloth::bench::bestMilliseconds(5, run);
+    std::printf("  %-36s %7.1f ns/number %11zu allocs\n", label, milliseconds * 1e6 / static_cast<double>(numbers),
+                allocations);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : 1'000'000;
+    const std::vector<std::string> tokens = numberTokens(count);
+    std::vector<std::string_view> views(tokens.begin(), tokens.end());
+
+    std::string document = "[";
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        document += i % 8 == 0 ? "\n" : "";
+        document += tokens[i];
+        document += i + 1 < tokens.size() ? ", " : "]\n";
+    }
+    std::printf("%zu numbers, %.1f MB of JSON\n", count, static_cast<double>(document.size()) / 1e6);
+
+    report("std::stod on a std::string copy", count, [&] {
+        double sum = 0.0;
+        for (const std::string_view token : views) {
+            sum += std::stod(std::string(token));
+        }
+        cashsloth::bench::keep(static_cast<std::size_t>(sum));
+    });
+    report("JsonNumber::parse", count, [&] {
+        double sum = 0.0;
+        for (const std::string_view token : views) {
+            sum += cashsloth::JsonNumber::parse(token)->toDouble();
+        }
+        cashsloth::bench::keep(static_cast<std::size_t>(sum));
+    });
+    report("JsonNumber::parse and toCents", count, [&] {
+        std::int64_t cents = 0;
+        for (const std::string_view token : views) {
+            cents += cashsloth::JsonNumber::parse(token)->toCents().value_or(0);
+        }
+        cashsloth::bench::keep(static_cast<std::size_t>(cents));
+    });
+    report("JsonParser::parse(handler) document", count, [&] {
+        SummingHandler handler;
+        cashsloth::JsonParser(document).parse(handler);
+        cashsloth::bench::keep(handler.numbers);
+    });
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Money against the double arithmetic the till used before it: parsing typed amounts with
+// Money::parse and with the old parseAmount (clean a std::string copy, then std::stod),
+// formatting with Money::format and with the old formatCurrency (an ostringstream), and
+// totalling random carts in Rappen and in double. Reports nanoseconds and heap allocations
+// per amount or cart line, and checks that both totals agree to the Rappen.
+//
+//     cash-sloth-money-bench [carts]
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_support.h"
+#include "cash_sloth_money.h"
+
+namespace {
+
+using cashsloth::Money;
+
+std::optional<double> parseAmount(const std::string& text) {
+    std::string cleaned = text;
+    cleaned.erase(std::remove_if(cleaned.begin(), cleaned.end(), [](unsigned char ch) { return std::isspace(ch); }),
+                  cleaned.end());
+    std::replace(cleaned.begin(), cleaned.end(), ',', '.');
+    if (cleaned.empty()) {
+        return std::nullopt;
+    }
+    try {
+        std::size_t consumed = 0;
+        const double value = std::stod(cleaned, &consumed);
+        if (consumed == cleaned.size()) {
+            return value;
+        }
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+std::string formatCurrency(double amount) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << amount << " CHF";
+    return oss.str();
+}
+
+// As a cashier types them and as catalogue prices read: "3.50", "12", "4,5", "1 250.00".
+std::vector<std::string> typedAmounts(std::size_t count) {
+    std::mt19937_64 random(25);
+    std::vector<std::string> amounts;
+    amounts.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint64_t rappen = random() % 200000;
+        const std::uint64_t francs = rappen / 100;
+        std::string text;
+        if (i % 4 == 2 && francs >= 1000) {
+            text = std::to_string(francs / 1000);
+            text += ' ';
+            text += std::to_string(francs % 1000 / 100);
+            text += std::to_string(francs % 100 / 10);
+            text += std::to_string(francs % 10);
+        } else {
+            text = std::to_string(francs);
+        }
+        switch (i % 4) {
+        case 0:
+            break;
+        case 1:
+            text += ',';
+            text += std::to_string(rappen / 10 % 10);
+            break;
+        default:
+            text += '.';
+            text += std::to_string(rappen / 10 % 10);
+            text += std::to_string(rappen % 10);
+            break;
+        }
+        amounts.push_back(std::move(text));
+    }
+    return amounts;
+}
+
+struct CartLine {
+    Money price;
+    double priceDouble = 0.0;
+    std::int64_t quantity = 0;
+};
+
+template <typename Run>
+void report(const char* label, std::size_t items, const char* unit, Run&& run) {
+    cashsloth::bench::resetAllocationStats();
+    run();
+    const std::size_t allocations = cashsloth::bench::allocationStats().allocations;
+    const double milliseconds = cashsloth::bench::bestMilliseconds(5, run);
+    std::printf("  %-34s %7.1f ns/%s %11zu allocs\n", label, milliseconds * 1e6 / static_cast<double>(items), unit,
+                allocations);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t carts = argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : 100'000;
+    const std::vector<std::string> texts = typedAmounts(carts * 4);
+    std::vector<Money> amounts;
+    std::vector<double> amountsDouble;
+    for (const std::string& text : texts) {
+        amounts.push_back(*Money::parse(text));
+        amountsDouble.push_back(*parseAmount(text));
+    }
+
+    std::printf("%zu typed amounts\n", texts.size());
+    report("parseAmount (std::stod)", texts.size(), "amount", [&] {
+        double sum = 0.0;
+        for (const std::string& text : texts) {
+            sum += parseAmount(text).value_or(0.0);
+        }
+        cashsloth::bench::keep(static_cast<std::size_t>(sum));
+    });
+    report("Money::parse", texts.size(), "amount", [&] {
+        std::int64_t sum = 0;
+        for (const std::string& text : texts) {
+            sum += Money::parse(text).value_or(Money()).rappen();
+        }
+        cashsloth::bench::keep(static_cast<std::size_t>(sum));
+    });
+    report("formatCurrency (ostringstream)", amountsDouble.size(), "amount", [&] {
+        std::size_t characters = 0;
+        for (const double amount : amountsDouble) {
+            characters += formatCurrency(amount).size();
+        }
+        cashsloth::bench::keep(characters);
+    });
+    report("Money::format", amounts.size(), "amount", [&] {
+        std::size_t characters = 0;
+        char text[cashsloth::kMoneyTextCapacity];
+        for (const Money amount : amounts) {
+            characters += amount.format(text);
+        }
+        cashsloth::bench::keep(characters);
+    });
+
+    // Carts of 1 to 80 lines; prices come from the typed amounts above.
+    std::mt19937_64 random(7);
+    std::vector<std::vector<CartLine>> cartLines(carts);
+    std::size_t lineCount = 0;
+    for (std::vector<CartLine>& lines : cartLines) {
+        lines.resize(1 + random() % 80);
+        for (CartLine& line : lines) {
+            const std::size_t amount = random() % amounts.size();
+            line.price = amounts[amount];
+            line.priceDouble = amountsDouble[amount];
+            line.quantity = 1 + static_cast<std::int64_t>(random() % 6);
+        }
+        lineCount += lines.size();
+    }
+    std::size_t mismatches = 0;
+    for (const std::vector<CartLine>& lines : cartLines) {
+        Money total;
+        double totalDouble = 0.0;
+        for (const CartLine& line : lines) {
+            total += line.price * line.quantity;
+            totalDouble += line.priceDouble * static_cast<double>(line.quantity);
+        }
+        mismatches += total.rappen() != std::llround(totalDouble * 100.0) ? 1 : 0;
+    }
+
+    std::printf("%zu carts, %zu lines, %zu totals that differ to the Rappen\n", carts, lineCount, mismatches);
+    report("cart total in double", lineCount, "line", [&] {
+        double sum = 0.0;
+        for (const std::vector<CartLine>& lines : cartLines) {
+            double total = 0.0;
+            for (const CartLine& line : lines) {
+                total += line.priceDouble * static_cast<double>(line.quantity);
+            }
+            sum += total;
+        }
+        cashsloth::bench::keep(static_cast<std::size_t>(sum));
+    });
+    report("cart total in Money", lineCount, "line", [&] {
+        std::int64_t sum = 0;
+        for (const std::vector<CartLine>& lines : cartLines) {
+            Money total;
+            for (const CartLine& line : lines) {
+                total += line.price * line.quantity;
+            }
+            sum += total.rappen();
+        }
+        cashsloth::bench::keep(static_cast<std::size_t>(sum));
+    });
+    return mismatches == 0 ? 0 : 1;
+}
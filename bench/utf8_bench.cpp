@@ -0,0 +1,185 @@
+// UTF-8 validation and UTF-8/UTF-16 conversion throughput. The reference reads ASCII one
+// byte at a time and decodes every other sequence on its own, which is what the converters
+// do without their 16-byte ASCII runs. On Windows the Win32 path the till used before is
+// measured as well: MultiByteToWideChar once to size the result and once to convert.
+// Bulk text is measured in MB/s, catalogue names as the UI converts them, one at a time.
+//
+//     cash-sloth-utf8-bench [articles]
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench_support.h"
+#include "cash_sloth_json.h"
+#include "cash_sloth_utf8.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace {
+
+class NameCollector : public cashsloth::JsonHandler {
+public:
+    void onKey(std::string_view key) override { nameFollows_ = key == "name"; }
+    void onString(std::string_view value) override {
+        if (nameFollows_) {
+            names.emplace_back(value);
+        }
+        nameFollows_ = false;
+    }
+
+    std::vector<std::string> names;
+
+private:
+    bool nameFollows_ = false;
+};
+
+std::size_t referenceFindInvalid(std::string_view text) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    std::size_t offset = 0;
+    while (offset < text.size()) {
+        if (bytes[offset] < 0x80) {
+            ++offset;
+            continue;
+        }
+        const std::size_t length = cashsloth::utf8SequenceLength(text.data() + offset, text.size() - offset);
+        if (length == 0) {
+            return offset;
+        }
+        offset += length;
+    }
+    return offset;
+}
+
+// Valid input only, which is all the benchmark feeds it.
+std::size_t referenceToUtf16(std::string_view text, char16_t* out) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    std::size_t written = 0;
+    std::size_t offset = 0;
+    while (offset < text.size()) {
+        if (bytes[offset] < 0x80) {
+            out[written++] = bytes[offset++];
+            continue;
+        }
+        const std::size_t length = cashsloth::utf8SequenceLength(text.data() + offset, text.size() - offset);
+        char32_t codepoint = bytes[offset] & (0x7F >> length);
+        for (std::size_t i = 1; i < length; ++i) {
+            codepoint = (codepoint << 6) | (bytes[offset + i] & 0x3F);
+        }
+        if (codepoint >= 0x10000) {
+            out[written++] = static_cast<char16_t>(0xD800 + ((codepoint - 0x10000) >> 10));
+            out[written++] = static_cast<char16_t>(0xDC00 + (codepoint & 0x3FF));
+        } else {
+            out[written++] = static_cast<char16_t>(codepoint);
+        }
+        offset += length;
+    }
+    return written;
+}
+
+std::string repeated(std::string_view piece, std::size_t bytes) {
+    std::string text;
+    text.reserve(bytes + piece.size());
+    while (text.size() < bytes) {
+        text += piece;
+    }
+    return text;
+}
+
+void reportBulk(const char* label, std::size_t bytes, double milliseconds) {
+    std::printf("    %-30s %8.0f MB/s\n", label, static_cast<double>(bytes) / 1e3 / milliseconds);
+}
+
+void benchBulk(const char* name, const std::string& text) {
+    std::printf("  %s, %.1f MB\n", name, static_cast<double>(text.size()) / 1e6);
+    std::u16string wide(text.size(), u'\0');
+    std::string narrow(text.size() * 3, '\0');
+
+    reportBulk("reference validation", text.size(), cashsloth::bench::bestMilliseconds(5, [&] {
+        cashsloth::bench::keep(referenceFindInvalid(text));
+    }));
+    reportBulk("findInvalidUtf8", text.size(), cashsloth::bench::bestMilliseconds(5, [&] {
+        cashsloth::bench::keep(cashsloth::findInvalidUtf8(text));
+    }));
+    reportBulk("reference UTF-8 to UTF-16", text.size(), cashsloth::bench::bestMilliseconds(5, [&] {
+        cashsloth::bench::keep(referenceToUtf16(text, wide.data()));
+    }));
+    std::size_t units = 0;
+    reportBulk("utf8ToUtf16", text.size(), cashsloth::bench::bestMilliseconds(5, [&] {
+        units = cashsloth::utf8ToUtf16(text, wide.data());
+    }));
+#if defined(_WIN32)
+    reportBulk("MultiByteToWideChar, two calls", text.size(), cashsloth::bench::bestMilliseconds(5, [&] {
+        const int size = static_cast<int>(text.size());
+        const int length = MultiByteToWideChar(CP_UTF8, 0, text.data(), size, nullptr, 0);
+        MultiByteToWideChar(CP_UTF8, 0, text.data(), size, reinterpret_cast<wchar_t*>(wide.data()), length);
+        cashsloth::bench::keep(static_cast<std::size_t>(length));
+    }));
+#endif
+    const std::u16string_view converted(wide.data(), units);
+    std::u16string reference(text.size(), u'\0');
+    reference.resize(referenceToUtf16(text, reference.data()));
+    if (converted != reference) {
+        std::fprintf(stderr, "utf8ToUtf16 and the reference disagree\n");
+        std::exit(1);
+    }
+    reportBulk("utf16ToUtf8 (per UTF-8 byte)", text.size(), cashsloth::bench::bestMilliseconds(5, [&] {
+        cashsloth::bench::keep(cashsloth::utf16ToUtf8(converted, narrow.data()));
+    }));
+#if defined(_WIN32)
+    reportBulk("WideCharToMultiByte, two calls", text.size(), cashsloth::bench::bestMilliseconds(5, [&] {
+        const auto* source = reinterpret_cast<const wchar_t*>(converted.data());
+        const int size = static_cast<int>(converted.size());
+        const int length = WideCharToMultiByte(CP_UTF8, 0, source, size, nullptr, 0, nullptr, nullptr);
+        WideCharToMultiByte(CP_UTF8, 0, source, size, narrow.data(), length, nullptr, nullptr);
+        cashsloth::bench::keep(static_cast<std::size_t>(length));
+    }));
+#endif
+}
+
+void reportNames(const char* label, std::size_t names, double milliseconds) {
+    std::printf("    %-30s %8.1f ns/name\n", label, milliseconds * 1e6 / static_cast<double>(names));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t articles = argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : 100'000;
+    const std::string catalogue = cashsloth::bench::syntheticCatalogue(articles);
+    NameCollector collector;
+    cashsloth::JsonParser(catalogue).parse(collector);
+
+    std::printf("Bulk text\n");
+    benchBulk("catalogue JSON, mostly ASCII", catalogue);
+    benchBulk("German and French text", repeated("Grüntee mit Crème fraîche, Käse und Brötchen à la carte. ", 16'000'000));
+    benchBulk("Greek, Cyrillic and CJK", repeated("Καφές Кофе 咖啡 コーヒー 커피 ", 16'000'000));
+
+    // As the UI converts them: each name into a string of its own.
+    std::printf("  %zu catalogue names, one string each\n", collector.names.size());
+    reportNames("utf8ToUtf16 into a new string", collector.names.size(), cashsloth::bench::bestMilliseconds(5, [&] {
+        for (const std::string& name : collector.names) {
+            std::u16string wide(name.size(), u'\0');
+            wide.resize(cashsloth::utf8ToUtf16(name, wide.data()));
+            cashsloth::bench::keep(wide.size());
+        }
+    }));
+#if defined(_WIN32)
+    reportNames("MultiByteToWideChar, two calls", collector.names.size(), cashsloth::bench::bestMilliseconds(5, [&] {
+        for (const std::string& name : collector.names) {
+            const int size = static_cast<int>(name.size());
+            const int length = MultiByteToWideChar(CP_UTF8, 0, name.data(), size, nullptr, 0);
+            std::wstring wide(static_cast<std::size_t>(length), L'\0');
+            MultiByteToWideChar(CP_UTF8, 0, name.data(), size, wide.data(), length);
+            cashsloth::bench::keep(wide.size());
+        }
+    }));
+#endif
+    return 0;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+namespace cashsloth {
+
+// Files the till reads its stylesheet and catalogue from, in order of preference. Later
+// entries are older names kept for existing installations.
+std::vector<std::filesystem::path> styleCandidates(const std::filesystem::path& baseDir);
+std::vector<std::filesystem::path> catalogueCandidates(const std::filesystem::path& baseDir);
+
+// The candidates that exist as regular files, in the order given. All of them are looked up
+// at once on the shared thread pool, so a slow network share or a spun-down disk is waited
+// for once rather than once per candidate.
+std::vector<std::filesystem::path> existingFiles(const std::vector<std::filesystem::path>& candidates);
+
+} // namespace cashsloth
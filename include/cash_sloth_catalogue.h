@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cash_sloth_catalogue_store.h"
+#include "cash_sloth_display_strings.h"
+
+namespace cashsloth {
+
+class CatalogueSearch;
+class CatalogueSnapshot;
+struct CatalogueDiff;
+
+class Catalogue {
+public:
+    Catalogue();
+    ~Catalogue();
+    Catalogue(Catalogue&&) noexcept;
+    Catalogue& operator=(Catalogue&&) noexcept;
+
+    enum class SnapshotCache { Use, Bypass };
+
+    // Uses the compiled snapshot next to `path` when it was built from the same bytes;
+    // otherwise parses the JSON and writes a fresh snapshot for the next start. With
+    // SnapshotCache::Bypass the JSON is always parsed and nothing is written next to it, for
+    // tools that only look at a file.
+    bool loadFromFile(const std::filesystem::path& path, SnapshotCache cache = SnapshotCache::Use);
+    bool saveToFile(const std::filesystem::path& path) const;
+    void loadDefault();
+    // Takes over a copy of `other`'s articles and handles and indexes them, which is cheaper
+    // than reading its file again.
+    void copyFrom(const Catalogue& other);
+
+    // Applies a change set computed from this catalogue's categories, moving the unchanged
+    // articles instead of copying them. Only the barcodes whose owner the changes affect are
+    // re-indexed; all others keep their slot in the snapshot's table. The diff must have
+    // been computed from this catalogue's categories; one that does not fit them throws
+    // std::runtime_error and leaves the catalogue as it was.
+    void apply(const CatalogueDiff& diff);
+
+    // For a catalogue just loaded from a newer version of `previous`'s file, before it is
+    // shared: articles that `diff`, computed from `previous` to this catalogue, carries over
+    // keep the handle they had in `previous`. Handles of removed articles go stale.
+    void inheritHandles(const Catalogue& previous, const CatalogueDiff& diff);
+
+    bool empty() const { return store_.categoryCount() == 0; }
+    // Articles are referred to by their number in the store, or by a handle where the
+    // reference has to outlast a change to the catalogue.
+    const CatalogueStore& store() const { return store_; }
+
+    // Does not allocate unless `raw` contains whitespace.
+    std::optional<std::size_t> findByBarcode(std::string_view raw) const;
+
+    // Type-ahead lookup by article or category name, ignoring case and umlaut spelling.
+    // Returns at most `limit` articles, best match first.
+    std::vector<std::size_t> search(std::string_view query, std::size_t limit) const;
+
+    // The UTF-16 text the till draws, converted whenever the catalogue is loaded or changed.
+    // The views stay valid until the catalogue is changed or destroyed.
+    std::u16string_view displayName(std::size_t article) const { return display_.name(store_.nameId(article)); }
+    std::u16string_view displayCategoryName(std::size_t category) const {
+        return display_.name(store_.categoryNameId(category));
+    }
+    std::u16string_view displayPrice(std::size_t article) const { return display_.priceLabel(store_.priceCents(article)); }
+
+    const std::filesystem::path& loadedFile() const { return loadedFile_; }
+
+private:
+    static std::vector<Category> buildDefaultCatalogue();
+    static std::filesystem::path snapshotPathFor(const std::filesystem::path& path);
+    void rebuildArticleIndex();
+    void overrideBarcodes(const CatalogueDiff& diff, const std::vector<std::size_t>& offsets);
+
+    CatalogueStore store_;
+    // Barcode lookups go through the snapshot's hash table. snapshotHandles_ holds the handle
+    // of the article behind each of the snapshot's article indices, so applying a diff does
+    // not have to touch it, and an article that was removed no longer resolves. Barcodes
+    // whose owner a diff changed are looked up in barcodeOverrides_ first, where a default
+    // handle means the code is no longer in use.
+    struct BarcodeHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view barcode) const { return std::hash<std::string_view>{}(barcode); }
+    };
+    std::unique_ptr<CatalogueSnapshot> snapshot_;
+    std::unique_ptr<CatalogueSearch> search_;
+    CatalogueDisplayStrings display_;
+    std::vector<ArticleHandle> snapshotHandles_;
+    std::unordered_map<std::string, ArticleHandle, BarcodeHash, std::equal_to<>> barcodeOverrides_;
+    std::filesystem::path loadedFile_;
+};
+
+} // namespace cashsloth
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "cash_sloth_catalogue_store.h"
+
+namespace cashsloth {
+
+inline constexpr std::size_t kNoCategory = std::numeric_limits<std::size_t>::max();
+
+// One article that differs between two versions of a catalogue. `from` positions index the
+// old version's categories and articles, `to` positions the new version's.
+struct ArticleChange {
+    enum class Kind { Added, Removed, Updated };
+
+    Kind kind = Kind::Updated;
+    // What changed about an updated article; several can apply at once.
+    bool repriced = false;
+    bool renamed = false;
+    bool recoded = false;
+    bool moved = false;
+    Article before;
+    Article after;
+    std::size_t fromCategory = 0;
+    std::size_t fromIndex = 0;
+    std::size_t toCategory = 0;
+    std::size_t toIndex = 0;
+};
+
+// The article a barcode resolves to once the changes are applied, for every barcode whose
+// owner the changes affect. `present` is false when no article carries the code any more.
+struct BarcodeOwner {
+    std::string barcode;
+    bool present = false;
+    std::size_t category = 0;
+    std::size_t index = 0;
+};
+
+// Change set that turns one catalogue version into another. Articles are matched by
+// barcode first and by name second, so a new price or name shows up as an update of the
+// same article rather than as a removal plus an addition. Categories are matched by name.
+struct CatalogueDiff {
+    // The new version's category names, each with the index of the old category it
+    // continues or kNoCategory for a new one.
+    std::vector<std::string> categories;
+    std::vector<std::size_t> categorySources;
+    std::size_t previousCategoryCount = 0;
+    bool categoriesChanged = false;
+    // Added and updated articles in the new version's order, then removed ones in the old.
+    std::vector<ArticleChange> changes;
+    std::vector<BarcodeOwner> barcodes;
+
+    bool empty() const { return !categoriesChanged && changes.empty(); }
+};
+
+CatalogueDiff diffCatalogues(const CatalogueStore& before, const CatalogueStore& after);
+
+// For every article of the version `diff` leads to, in order, the number it has in `before`,
+// or kNoArticle for one that was added. `diff` must have been computed from `before`.
+std::vector<std::size_t> articleSources(const CatalogueDiff& diff, const CatalogueStore& before);
+
+// Writes one line per changed category and article followed by a summary, for reviewing a
+// catalogue update before it is rolled out. `before` is the version the diff starts from.
+void writeCatalogueDiff(std::ostream& out, const CatalogueDiff& diff, const CatalogueStore& before);
+
+} // namespace cashsloth
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cash_sloth_catalogue_store.h"
+
+namespace cashsloth {
+
+// Lower-cases UTF-8 text and folds umlauts and accents for searching: "Grüntee" and
+// "GRUENTEE" both become "gruentee", "Café" becomes "cafe". Letters outside Latin-1 are
+// kept as they are.
+std::string foldSearchText(std::string_view text);
+
+// Type-ahead search over article and category names. Names are folded with
+// foldSearchText and indexed by the trigrams they contain and by the first one to three
+// characters of the name and of each word, with all postings in one array. Articles are
+// numbered by name length, so every posting list is already in rank order and a lookup
+// stops as soon as it has enough matches. A query of three or more characters finds the
+// articles whose name contains it; a shorter one finds the names with a word that starts
+// with it. Articles in a category whose name matches follow the articles matched by name.
+class CatalogueSearch {
+public:
+    CatalogueSearch() = default;
+    explicit CatalogueSearch(const CatalogueStore& store);
+
+    // Numbers of the best matching articles, best first: names that start with the query,
+    // then names with a word that does, then names that contain it; ties go to the shorter
+    // name. At most `limit`.
+    std::vector<std::size_t> find(std::string_view query, std::size_t limit) const;
+
+private:
+    std::span<const std::uint32_t> postings(std::uint32_t gram) const;
+    std::string_view name(std::uint32_t id) const;
+
+    // Folded article names back to back in id order, shortest first; the article with id i
+    // spans nameOffsets_[i] to nameOffsets_[i + 1] and has number positions_[i] in the store.
+    std::string names_;
+    std::vector<std::uint32_t> nameOffsets_;
+    std::vector<std::uint32_t> positions_;
+    std::vector<std::string> categoryNames_;
+    // Number of the first article of each category, plus the total at the end.
+    std::vector<std::uint32_t> categoryOffsets_;
+    // The postings of gram g are postings_[gramOffsets_[g]] up to postings_[gramOffsets_[g + 1]].
+    std::vector<std::uint32_t> gramOffsets_;
+    std::vector<std::uint32_t> postings_;
+};
+
+} // namespace cashsloth
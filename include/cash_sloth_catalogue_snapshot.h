@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "cash_sloth_catalogue.h"
+#include "cash_sloth_mapped_file.h"
+
+namespace cashsloth {
+
+// Fast 64-bit hash used to place barcodes in the snapshot's hash table. Not cryptographic.
+std::uint64_t hashBytes(std::string_view bytes);
+
+// How a normalised barcode is indexed. GTINs (EAN-8, UPC-A, EAN-13 and GTIN-14) with a valid
+// check digit become integer keys, all-digit codes of up to five digits (PLUs) index an
+// array directly, and everything else is hashed as text. Codes that are equal as text
+// always get the same key, so leading zeros still tell codes apart.
+struct BarcodeKey {
+    enum class Kind { Text, Gtin, Plu };
+
+    Kind kind = Kind::Text;
+    // The GTIN's value tagged with its length, or the PLU's slot in the direct array.
+    std::uint64_t value = 0;
+
+    static BarcodeKey of(std::string_view barcode);
+};
+
+// Compiled form of a catalogue that is used where it lies: a header, the columns of the
+// CatalogueStore it was built from, an open-addressing barcode table and the string pool,
+// all at 8-byte aligned offsets. store() hands out a store that reads the mapped columns
+// directly, so loading copies no article. Barcodes are split the way BarcodeKey says: GTINs
+// go into a linear-probing table of integer keys with a parallel array of article indices,
+// PLUs into a direct array, and the rest into a table over the string pool. The header
+// records the size and a hash of the bytes of the JSON it was built from; a snapshot whose
+// key does not match the current source is ignored and rebuilt. Integers are stored in
+// native byte order, which the header's byte-order mark checks.
+class CatalogueSnapshot {
+public:
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint64_t sourceHash;
+        std::uint64_t sourceSize;
+        std::uint32_t categoryCount;
+        std::uint32_t articleCount;
+        std::uint32_t stringCount;
+        std::uint32_t tableSlots;
+        std::uint32_t gtinSlots;
+        std::uint32_t pluSlots;
+        std::uint64_t stringStartsOffset;
+        std::uint64_t pricesOffset;
+        std::uint64_t namesOffset;
+        std::uint64_t barcodesOffset;
+        std::uint64_t categoryNamesOffset;
+        std::uint64_t categoryStartsOffset;
+        std::uint64_t tableOffset;
+        std::uint64_t gtinKeysOffset;
+        std::uint64_t gtinArticlesOffset;
+        std::uint64_t pluOffset;
+        std::uint64_t stringsOffset;
+        std::uint64_t stringsSize;
+    };
+
+    static constexpr std::uint32_t kVersion = 6;
+
+    CatalogueSnapshot() = default;
+
+    // Lays out `store` in an in-memory image; barcodes must already be normalised.
+    // `sourceHash` is hashBytes() of the source JSON.
+    static CatalogueSnapshot build(const CatalogueStore& store, std::uint64_t sourceHash, std::uint64_t sourceSize);
+    // Maps `path` and checks the header and section bounds. Returns nothing when the file is
+    // missing, truncated or from another format version.
+    static std::optional<CatalogueSnapshot> open(const std::filesystem::path& path);
+
+    // Writes the image next to `path` first and then renames it into place, so readers
+    // never observe a half-written snapshot.
+    bool writeTo(const std::filesystem::path& path) const;
+
+    bool empty() const { return header_ == nullptr; }
+    bool matches(std::uint64_t sourceHash, std::uint64_t sourceSize) const;
+
+    std::size_t categoryCount() const { return header_ ? header_->categoryCount : 0; }
+    std::size_t articleCount() const { return header_ ? header_->articleCount : 0; }
+
+    // Index of the article registered for the normalised barcode. Later articles win over
+    // earlier ones with the same code. Does not allocate.
+    std::optional<std::size_t> findBarcode(std::string_view barcode) const;
+
+    // A store over the snapshot's columns, which must outlive it. Checks every id and range
+    // in one pass over the columns first and throws std::runtime_error when one is out of
+    // bounds.
+    CatalogueStore store() const;
+
+private:
+    bool attach(std::string_view bytes);
+    // Ids and ranges out of bounds read as "", so a damaged table finds nothing.
+    std::string_view string(std::uint32_t id) const;
+
+    MappedFile file_;
+    std::vector<std::uint64_t> image_;
+    std::string_view bytes_;
+    const Header* header_ = nullptr;
+    CatalogueColumns columns_;
+    const std::uint32_t* table_ = nullptr;
+    const std::uint64_t* gtinKeys_ = nullptr;
+    const std::uint32_t* gtinArticles_ = nullptr;
+    const std::uint32_t* plu_ = nullptr;
+};
+
+} // namespace cashsloth
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cash_sloth_money.h"
+
+namespace cashsloth {
+
+struct Article {
+    std::string name;
+    Money price;
+    std::string barcode;
+};
+
+struct Category {
+    std::string name;
+    std::vector<Article> articles;
+};
+
+// Catalogue readers reject prices from this amount up, a trillion francs, so that prices and
+// cart totals in cents stay far away from the limits of std::int64_t.
+inline constexpr Money kMaxPrice = Money::fromRappen(100'000'000'000'000);
+
+inline constexpr std::size_t kNoArticle = std::numeric_limits<std::size_t>::max();
+
+// Names an article independently of its number, which changes whenever articles are added,
+// removed or moved. The slot stays with the article until it leaves the store; then the
+// slot's generation goes up, so a handle that is still around no longer resolves, and the
+// slot can be handed to another article. A default handle resolves to nothing.
+struct ArticleHandle {
+    std::uint32_t slot = std::numeric_limits<std::uint32_t>::max();
+    std::uint32_t generation = 0;
+
+    friend bool operator==(const ArticleHandle&, const ArticleHandle&) = default;
+};
+
+// The arrays a CatalogueStore is made of, as views. A compiled snapshot stores them the same
+// way, so a store can read a mapped snapshot where it lies.
+struct CatalogueColumns {
+    std::string_view pool;
+    std::span<const std::uint32_t> stringStarts;
+    std::span<const std::int64_t> prices;
+    std::span<const std::uint32_t> names;
+    std::span<const std::uint32_t> barcodes;
+    std::span<const std::uint32_t> categoryNames;
+    std::span<const std::uint32_t> categoryStarts;
+};
+
+// One array of a CatalogueStore, either its own or borrowed from a snapshot. Reads are the
+// same either way; the first change to a borrowed array copies it. A copied column always
+// owns its elements, so a copied store no longer depends on the snapshot.
+template <typename T>
+class StoreColumn {
+public:
+    StoreColumn() = default;
+    StoreColumn(std::initializer_list<T> values) : owned_(values) { adopt(); }
+    explicit StoreColumn(std::span<const T> borrowed)
+        : data_(borrowed.data()), size_(borrowed.size()), borrowed_(true) {}
+    StoreColumn(const StoreColumn& other) : owned_(other.begin(), other.end()) { adopt(); }
+    StoreColumn(StoreColumn&& other) noexcept
+        : owned_(std::move(other.owned_)), data_(other.data_), size_(other.size_), borrowed_(other.borrowed_) {
+        other.adopt();
+    }
+    StoreColumn& operator=(const StoreColumn& other) {
+        if (this != &other) {
+            owned_.assign(other.begin(), other.end());
+            adopt();
+        }
+        return *this;
+    }
+    StoreColumn& operator=(StoreColumn&& other) noexcept {
+        if (this != &other) {
+            owned_ = std::move(other.owned_);
+            data_ = other.data_;
+            size_ = other.size_;
+            borrowed_ = other.borrowed_;
+            other.adopt();
+        }
+        return *this;
+    }
+    StoreColumn& operator=(std::vector<T> values) {
+        owned_ = std::move(values);
+        adopt();
+        return *this;
+    }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T* data() const { return data_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    const T& operator[](std::size_t index) const { return data_[index]; }
+    const T& back() const { return data_[size_ - 1]; }
+    std::span<const T> view() const { return std::span<const T>(data_, size_); }
+
+    void set(std::size_t index, const T& value) {
+        own();
+        owned_[index] = value;
+    }
+    void pushBack(const T& value) {
+        own();
+        owned_.push_back(value);
+        adopt();
+    }
+    void append(const T* values, std::size_t count) {
+        own();
+        owned_.insert(owned_.end(), values, values + count);
+        adopt();
+    }
+    void reserve(std::size_t count) {
+        own();
+        owned_.reserve(count);
+        adopt();
+    }
+    void shrinkToFit() {
+        if (!borrowed_) {
+            owned_.shrink_to_fit();
+            adopt();
+        }
+    }
+
+private:
+    void own() {
+        if (borrowed_) {
+            owned_.assign(begin(), end());
+            adopt();
+        }
+    }
+    void adopt() {
+        data_ = owned_.data();
+        size_ = owned_.size();
+        borrowed_ = false;
+    }
+
+    std::vector<T> owned_;
+    const T* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool borrowed_ = false;
+};
+
+// Columnar storage behind Catalogue. Articles are numbered in catalogue order, all articles
+// of all categories counted from 0, and stored as parallel arrays of price in cents, name
+// and barcode. Names and barcodes are ids into a single pool of interned strings. A category
+// is the range of article numbers from its first article to the next category's. An article
+// takes 16 bytes plus its share of the pool and 12 bytes for its handle, and a scan over
+// prices or names reads one array from front to back.
+class CatalogueStore {
+public:
+    CatalogueStore();
+    explicit CatalogueStore(const std::vector<Category>& categories);
+    // Reads `columns` where they lie until they are changed; only the handles are built.
+    // The columns must be consistent, which CatalogueSnapshot::store() checks, and stay
+    // valid as long as the store reads them.
+    explicit CatalogueStore(const CatalogueColumns& columns);
+
+    std::size_t categoryCount() const { return categoryNames_.size(); }
+    std::size_t articleCount() const { return prices_.size(); }
+    std::string_view categoryName(std::size_t category) const { return string(categoryNames_[category]); }
+    // The articles of `category` are numbered from firstArticle(category) up to
+    // firstArticle(category + 1); firstArticle(categoryCount()) is articleCount().
+    std::size_t firstArticle(std::size_t category) const { return categoryStarts_[category]; }
+    std::size_t categorySize(std::size_t category) const { return categoryStarts_[category + 1] - categoryStarts_[category]; }
+
+    std::string_view name(std::size_t article) const { return string(names_[article]); }
+    std::uint32_t nameId(std::size_t article) const { return names_[article]; }
+    std::uint32_t categoryNameId(std::size_t category) const { return categoryNames_[category]; }
+    std::string_view barcode(std::size_t article) const { return string(barcodes_[article]); }
+    std::int64_t priceCents(std::size_t article) const { return prices_[article]; }
+    Money price(std::size_t article) const { return Money::fromRappen(prices_[article]); }
+    Article article(std::size_t article) const;
+
+    ArticleHandle handle(std::size_t article) const {
+        const std::uint32_t slot = articleSlots_[article];
+        return ArticleHandle{slot, slots_[slot].generation};
+    }
+    // The article's current number, or nothing when it has left the store.
+    std::optional<std::size_t> resolve(ArticleHandle handle) const {
+        if (handle.slot >= slots_.size() || slots_[handle.slot].generation != handle.generation) {
+            return std::nullopt;
+        }
+        return slots_[handle.slot].article;
+    }
+
+    // All names and barcodes back to back; name(), barcode() and categoryName() are views
+    // into it.
+    std::string_view pool() const { return std::string_view(pool_.data(), pool_.size()); }
+    CatalogueColumns columns() const;
+
+    // Makes room for the given numbers of categories, articles and bytes of distinct strings.
+    void reserve(std::size_t categories, std::size_t articles, std::size_t poolBytes);
+    // Appends a category, or an article to the last category.
+    void addCategory(std::string_view name);
+    void addArticle(std::string_view name, std::int64_t priceCents, std::string_view barcode);
+    // For loading strings that are known to be distinct: appendString() pools a string
+    // without looking for an equal one and returns its id, which the overloads below take.
+    std::uint32_t appendString(std::string_view text);
+    std::string_view string(std::uint32_t id) const {
+        return std::string_view(pool_.data() + stringStarts_[id], stringStarts_[id + 1] - stringStarts_[id]);
+    }
+    // Ids run from 0, which is "", up to stringCount() - 1.
+    std::size_t stringCount() const { return stringStarts_.size() - 1; }
+    void addCategory(std::uint32_t nameId);
+    void addArticle(std::uint32_t nameId, std::int64_t priceCents, std::uint32_t barcodeId);
+    void setArticle(std::size_t article, const Article& value);
+    // Adds an article behind the last category, outside of any, where it waits for
+    // rearrange() to give it a place. Returns its number.
+    std::size_t addLooseArticle(const Article& value);
+    // Lays the articles out anew: category c is named names[c] and holds sizes[c] articles,
+    // and the article numbered p afterwards is the one numbered sources[p] before. Articles
+    // that are not listed are dropped; their strings stay in the pool until the next load.
+    void rearrange(const std::vector<std::string>& names, const std::vector<std::size_t>& sizes,
+                   const std::vector<std::size_t>& sources);
+    // For a store loaded from a newer version of `previous`: the article numbered p here
+    // takes over the handle of the one numbered sources[p] in `previous`, or gets a new one
+    // where that is kNoArticle. Handles of articles of `previous` that are not listed go
+    // stale.
+    void inheritHandles(const CatalogueStore& previous, const std::vector<std::size_t>& sources);
+
+    // Trims the arrays and drops the table that interns strings, which is rebuilt when the
+    // next string is added. For after loading.
+    void shrinkToFit();
+
+private:
+    struct Slot {
+        std::uint32_t article = 0;
+        std::uint32_t generation = 0;
+    };
+
+    std::uint32_t intern(std::string_view text);
+    std::uint32_t pushString(std::string_view text);
+    void growInternTable();
+    // Gives `article` a free slot, or a new one when none is free.
+    std::uint32_t takeSlot(std::size_t article);
+    void releaseSlot(std::uint32_t slot);
+
+    // String id i spans pool_ from stringStarts_[i] to stringStarts_[i + 1]; id 0 is "".
+    StoreColumn<char> pool_;
+    StoreColumn<std::uint32_t> stringStarts_;
+    // Open addressing over string ids, at most three quarters full.
+    std::vector<std::uint32_t> internTable_;
+    StoreColumn<std::int64_t> prices_;
+    StoreColumn<std::uint32_t> names_;
+    StoreColumn<std::uint32_t> barcodes_;
+    StoreColumn<std::uint32_t> categoryNames_;
+    StoreColumn<std::uint32_t> categoryStarts_;
+    // Handles: the slot of every article by number, and the article and generation of
+    // every slot. Released slots are reused last in, first out.
+    std::vector<std::uint32_t> articleSlots_;
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> freeSlots_;
+};
+
+} // namespace cashsloth
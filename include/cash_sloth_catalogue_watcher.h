@@ -0,0 +1,76 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#if !defined(_WIN32) && !defined(__linux__)
+#include <condition_variable>
+#endif
+
+#include "cash_sloth_catalogue_diff.h"
+
+namespace cashsloth {
+
+class Catalogue;
+
+// A catalogue the watcher loaded, ready to be shared: its articles already carry the handles
+// they had in the catalogue the owner uses, and `diff` leads from that one to it.
+struct CatalogueReload {
+    std::shared_ptr<Catalogue> catalogue;
+    CatalogueDiff diff;
+};
+
+// Reloads a catalogue file on a background thread whenever it changes on disk. The directory
+// is watched with ReadDirectoryChangesW on Windows and inotify on Linux; elsewhere the file's
+// timestamp is polled once a second. The events of one save are coalesced and the file is
+// loaded once they have settled. A file that does not load, for example because it is still
+// being written, is left alone until the next change.
+//
+// Every reload produces a new Catalogue. The watcher compares it with the one the owner uses
+// and lets it inherit that one's handles on its own thread, so the owner only swaps pointers;
+// a file that was saved without changes is dropped there. takeReloaded() hands out the
+// newest catalogue, diffed against the one taken before it. Anyone still holding an older
+// one keeps it alive until it lets go.
+class CatalogueWatcher {
+public:
+    // Watches the file `current` was loaded from. `onReload` runs on the watcher thread
+    // whenever a new catalogue is ready. It should only notify the owning thread, which then
+    // calls takeReloaded().
+    CatalogueWatcher(std::shared_ptr<const Catalogue> current, std::function<void()> onReload);
+    ~CatalogueWatcher();
+
+    CatalogueWatcher(const CatalogueWatcher&) = delete;
+    CatalogueWatcher& operator=(const CatalogueWatcher&) = delete;
+
+    // The newest catalogue loaded since the last call, or std::nullopt when there is none.
+    // From then on the watcher diffs against the catalogue it returned.
+    std::optional<CatalogueReload> takeReloaded();
+
+private:
+    void run();
+    void reload();
+
+    std::filesystem::path path_;
+    std::function<void()> onReload_;
+    std::mutex mutex_;
+    // The catalogue the owner uses, which reloads are diffed against, and the newest reload
+    // it has not taken yet.
+    std::shared_ptr<const Catalogue> current_;
+    std::optional<CatalogueReload> reloaded_;
+    bool stopping_ = false;
+    // Wakes the watcher thread for shutdown.
+#if defined(_WIN32)
+    void* stopEvent_ = nullptr;
+#elif defined(__linux__)
+    int stopPipe_[2] = {-1, -1};
+#else
+    std::condition_variable stopped_;
+#endif
+    std::thread thread_;
+};
+
+} // namespace cashsloth
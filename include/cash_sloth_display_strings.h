@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cash_sloth_catalogue_store.h"
+
+namespace cashsloth {
+
+// Room for the longest label writePriceLabel() can produce.
+inline constexpr std::size_t kPriceLabelCapacity = 32;
+
+// Writes `cents` as the till shows prices, for example "3.50 CHF" or "-0.05 CHF", to `out`
+// and returns the number of units written.
+std::size_t writePriceLabel(std::int64_t cents, char16_t* out);
+
+// The UTF-16 text the till draws for a catalogue: article and category names and one
+// "3.50 CHF" label per distinct price. Everything is converted once, when the catalogue is
+// loaded, into a single pool, so painting a tile or listing the cart neither converts nor
+// allocates. Names are kept by the store's string id, so a name shared by several articles
+// is converted once; barcodes are never shown and not kept. Every string is followed by a
+// NUL, so data() can be passed to calls that expect a C string.
+class CatalogueDisplayStrings {
+public:
+    CatalogueDisplayStrings() = default;
+    explicit CatalogueDisplayStrings(const CatalogueStore& store);
+
+    // The name with string id `id` in the store the strings were built from; empty for ids
+    // that are not an article or category name.
+    std::u16string_view name(std::uint32_t id) const {
+        if (static_cast<std::size_t>(id) + 1 >= nameStarts_.size() || nameStarts_[id] == nameStarts_[id + 1]) {
+            return u"";
+        }
+        return std::u16string_view(pool_.data() + nameStarts_[id], nameStarts_[id + 1] - nameStarts_[id] - 1);
+    }
+    // The label of a price that one of the articles had when the strings were built; empty
+    // for any other.
+    std::u16string_view priceLabel(std::int64_t cents) const;
+
+    // Units in the pool, NULs included.
+    std::size_t poolSize() const { return pool_.size(); }
+
+private:
+    struct PriceLabel {
+        std::int64_t cents;
+        std::uint32_t start;
+        std::uint32_t length;
+    };
+
+    std::u16string pool_;
+    // Name id i spans pool_ from nameStarts_[i] to nameStarts_[i + 1], its NUL included; the
+    // span is empty for ids that are not shown.
+    std::vector<std::uint32_t> nameStarts_;
+    // Sorted by price.
+    std::vector<PriceLabel> priceLabels_;
+};
+
+} // namespace cashsloth
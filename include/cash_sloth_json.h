@@ -1,24 +1,64 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace cashsloth {
 
+// A JSON number together with its decimal form. Numbers whose significant digits fit into
+// an int64, which is every number with up to 18 of them and those with 19 up to
+// 9223372036854775807, keep the exact value mantissa() * 10^exponent() they were written
+// with, so a price such as 6.5 or 3.50 converts to integer cents without passing through
+// binary floating point. Longer numbers are only available as the nearest double.
+class JsonNumber {
+public:
+    JsonNumber() = default;
+    // Takes the shortest decimal that reads back as `value`, which is what JsonWriter prints.
+    explicit JsonNumber(double value);
+    // mantissa * 10^exponent, e.g. fromDecimal(350, -2) for 3.50.
+    static JsonNumber fromDecimal(std::int64_t mantissa, int exponent);
+    // Parses one complete JSON number such as "-12.50e1"; std::nullopt for anything else.
+    static std::optional<JsonNumber> parse(std::string_view text);
+
+    double toDouble() const { return value_; }
+    bool isExact() const { return exact_; }
+    std::int64_t mantissa() const { return mantissa_; }
+    int exponent() const { return exponent_; }
+
+    // The exact value counted in units of 10^-decimals (2 for cents). std::nullopt when it is
+    // not a whole number of such units, does not fit into int64 or is not exact, so nothing
+    // is ever rounded on the way.
+    std::optional<std::int64_t> toScaled(int decimals) const;
+    std::optional<std::int64_t> toInteger() const { return toScaled(0); }
+    std::optional<std::int64_t> toCents() const { return toScaled(2); }
+
+private:
+    friend class JsonParser;
+
+    double value_ = 0.0;
+    std::int64_t mantissa_ = 0;
+    std::int32_t exponent_ = 0;
+    bool exact_ = true;
+};
+
 class JsonValue {
 public:
     using Object = std::map<std::string, JsonValue>;
     using Array = std::vector<JsonValue>;
-    using Storage = std::variant<std::nullptr_t, bool, double, std::string, Array, Object>;
+    using Storage = std::variant<std::nullptr_t, bool, JsonNumber, std::string, Array, Object>;
 
     JsonValue() : storage_(nullptr) {}
     JsonValue(std::nullptr_t) : storage_(nullptr) {}
     JsonValue(bool value) : storage_(value) {}
-    JsonValue(double value) : storage_(value) {}
+    JsonValue(double value) : storage_(JsonNumber(value)) {}
+    JsonValue(JsonNumber value) : storage_(value) {}
     JsonValue(std::string value) : storage_(std::move(value)) {}
     JsonValue(const char* value) : storage_(std::string(value)) {}
     JsonValue(Array value) : storage_(std::move(value)) {}
@@ -26,13 +66,16 @@ public:
 
     bool isNull() const { return std::holds_alternative<std::nullptr_t>(storage_); }
     bool isBool() const { return std::holds_alternative<bool>(storage_); }
-    bool isNumber() const { return std::holds_alternative<double>(storage_); }
+    bool isNumber() const { return std::holds_alternative<JsonNumber>(storage_); }
     bool isString() const { return std::holds_alternative<std::string>(storage_); }
     bool isArray() const { return std::holds_alternative<Array>(storage_); }
     bool isObject() const { return std::holds_alternative<Object>(storage_); }
 
     bool asBool(bool fallback = false) const { return isBool() ? std::get<bool>(storage_) : fallback; }
-    double asNumber(double fallback = 0.0) const { return isNumber() ? std::get<double>(storage_) : fallback; }
+    double asNumber(double fallback = 0.0) const {
+        return isNumber() ? std::get<JsonNumber>(storage_).toDouble() : fallback;
+    }
+    const JsonNumber& asDecimal() const { return std::get<JsonNumber>(storage_); }
     const std::string& asString() const { return std::get<std::string>(storage_); }
     const Array& asArray() const { return std::get<Array>(storage_); }
     const Object& asObject() const { return std::get<Object>(storage_); }
@@ -44,33 +87,207 @@ private:
     Storage storage_;
 };
 
+// Receives events from JsonParser::parse(JsonHandler&) in document order. String and key
+// views point either into the parsed text or into a parser-owned scratch buffer, so they are
+// only valid until the callback returns.
+class JsonHandler {
+public:
+    virtual ~JsonHandler() = default;
+
+    virtual void onNull() {}
+    virtual void onBool(bool) {}
+    virtual void onNumber(double) {}
+    virtual void onString(std::string_view) {}
+    virtual void onKey(std::string_view) {}
+    virtual void onStartObject() {}
+    virtual void onEndObject() {}
+    virtual void onStartArray() {}
+    virtual void onEndArray() {}
+};
+
+enum class JsonErrorCode {
+    UnexpectedEnd,
+    UnexpectedCharacter,
+    UnexpectedToken,
+    TrailingCharacters,
+    ExpectedKey,
+    InvalidLiteral,
+    InvalidNumber,
+    NumberOutOfRange,
+    UnterminatedString,
+    ControlCharacter,
+    InvalidEscape,
+    InvalidUtf8
+};
+
+// Why and where parsing stopped. `offset` is the byte offset into the parsed text and
+// `message` is a static string, the same one the throwing API reports.
+struct JsonError {
+    JsonErrorCode code = JsonErrorCode::UnexpectedEnd;
+    std::size_t offset = 0;
+    const char* message = "";
+};
+
+// Holds either a parse result or the error that prevented it, in the manner of
+// std::expected. value() and error() throw std::bad_variant_access when called on the wrong
+// alternative.
+template <typename T>
+class JsonResult {
+public:
+    JsonResult(T&& value) : storage_(std::in_place_index<0>, std::move(value)) {}
+    JsonResult(const T& value) : storage_(std::in_place_index<0>, value) {}
+    JsonResult(JsonError error) : storage_(std::in_place_index<1>, error) {}
+
+    bool hasValue() const { return storage_.index() == 0; }
+    explicit operator bool() const { return hasValue(); }
+
+    T& value() { return std::get<0>(storage_); }
+    const T& value() const { return std::get<0>(storage_); }
+    T& operator*() { return value(); }
+    const T& operator*() const { return value(); }
+    T* operator->() { return &value(); }
+    const T* operator->() const { return &value(); }
+
+    const JsonError& error() const { return std::get<1>(storage_); }
+
+private:
+    std::variant<T, JsonError> storage_;
+};
+
 class JsonParser {
 public:
     explicit JsonParser(std::string_view text) : text_(text) {}
 
+    // Report malformed input as a JsonError instead of throwing, so probing a broken file
+    // costs no more than an early return. Exceptions thrown by a handler still propagate.
+    JsonResult<JsonValue> tryParse();
+    std::optional<JsonError> tryParse(JsonHandler& handler);
+
+    // Same as tryParse(), but throw std::runtime_error carrying the error message.
     JsonValue parse();
+    void parse(JsonHandler& handler);
 
 private:
+    friend class JsonCursor;
+    friend class JsonNumber;
+
+    // The parse and scan functions return false after recording the error with fail().
     void skipBom();
-    JsonValue parseValue();
-    JsonValue parseObject();
-    JsonValue parseArray();
-    JsonValue parseNumber();
-    JsonValue parseTrue();
-    JsonValue parseFalse();
-    JsonValue parseNull();
-    std::string parseString();
+    bool parseEnd();
+    bool parseValue(JsonValue& value);
+    bool parseObject(JsonValue& value);
+    bool parseArray(JsonValue& value);
+
+    bool parseValue(JsonHandler& handler);
+    bool parseObject(JsonHandler& handler);
+    bool parseArray(JsonHandler& handler);
+    bool scanNumber(JsonNumber& value);
+    bool scanLiteral(std::string_view literal, const char* message);
+    bool scanString(std::string_view& value);
+    bool scanStringText();
 
     char peek() const { return text_[cursor_]; }
     void advance() { ++cursor_; }
     bool consume(char expected);
-    void expect(char expected);
+    bool expect(char expected);
     void skipWhitespace();
-    [[noreturn]] void error(const char* message) const;
+    bool fail(JsonErrorCode code, const char* message);
+    [[noreturn]] void throwError() const;
 
     std::string_view text_;
     std::size_t cursor_ = 0;
+    std::string scratch_;
+    JsonError error_;
+};
+
+// Thrown by JsonCursor for malformed text and for values of the wrong type; `offset` is the
+// byte offset into the text where reading stopped.
+class JsonCursorError : public std::runtime_error {
+public:
+    JsonCursorError(const char* message, std::size_t offset) : std::runtime_error(message), offset_(offset) {}
+
+    std::size_t offset() const { return offset_; }
+
+private:
+    std::size_t offset_;
+};
+
+// Forward-only reader that decodes values only when asked. Containers are walked with
+// beginObject()/nextKey() and beginArray()/nextElement(); anything the caller is not
+// interested in is passed over with skipValue(). With Skipping::Fast that matches quotes and
+// brackets without decoding, so unknown subtrees cost a byte scan rather than a parse, and
+// skipped content is not validated. With Skipping::Validated it runs the parser over them,
+// and together with finish() the cursor then rejects everything JsonParser rejects, in the
+// same single pass that reads the values. A container that was entered has to be walked to
+// its end before the enclosing one continues. Copying a cursor bookmarks its position. The
+// text must outlive the cursor.
+class JsonCursor {
+public:
+    enum class Skipping { Fast, Validated };
+
+    explicit JsonCursor(std::string_view text, Skipping skipping = Skipping::Fast);
+
+    bool isNull() const { return peek() == 'n'; }
+    bool isBool() const { return peek() == 't' || peek() == 'f'; }
+    bool isNumber() const { return peek() == '-' || (peek() >= '0' && peek() <= '9'); }
+    bool isString() const { return peek() == '"'; }
+    bool isArray() const { return peek() == '['; }
+    bool isObject() const { return peek() == '{'; }
+
+    // The read functions consume the current value and throw when it has another type.
+    bool readBool();
+    double readNumber();
+    JsonNumber readDecimal();
+    // Returns a view into the text, or into `scratch` when the string had escapes.
+    std::string_view readString(std::string& scratch);
+    void skipValue();
+
+    void beginObject();
+    // Moves to the next member value and returns its key, which stays valid until the
+    // next call; returns false after consuming the closing brace.
+    bool nextKey(std::string_view& key);
+    // Skips members until `key` and moves to its value; returns false after consuming the
+    // closing brace when there is no such member. Duplicates resolve to the first one.
+    bool findKey(std::string_view key);
+    void beginArray();
+    // Moves to the next element; returns false after consuming the closing bracket.
+    bool nextElement();
+    // Skips the rest of the innermost entered container, including its closing bracket. A
+    // validating cursor has to be between two items, not at a member value.
+    void leaveContainer();
+    // Throws unless only whitespace follows; for after the top-level value was read.
+    void finish();
+
+    // Offset into the text: the start of the current value, or just past the last value
+    // or closing bracket that was consumed.
+    std::size_t offset() const { return offset_; }
+
+private:
+    char peek() const { return offset_ < text_.size() ? text_[offset_] : '\0'; }
+    bool nextItem(char close);
+    void skipString();
+    void skipSpace();
+    [[noreturn]] void error(const char* message) const;
+    [[noreturn]] void error(const JsonError& error) const;
+
+    std::string_view text_;
+    std::size_t offset_ = 0;
+    bool entered_ = false;
+    bool validated_ = false;
+    // Closing brackets of the containers entered so far; only kept when validating, where
+    // leaveContainer() needs to know which kind of container it walks.
+    std::string closers_;
+    std::string keyScratch_;
 };
 
+// Offset of the first '"', '\\' or control byte in [data, data + size), or `size` when there
+// is none. Uses the same vector kernels as the parser.
+std::size_t findJsonStringSpecial(const char* data, std::size_t size);
+
+// Fills `positions` with the offsets of '{', '}', '[', ']', ':' and ',' outside of strings,
+// in ascending order, using the same vector kernels as the parser. Returns false when the
+// text ends inside a string. Offsets are 32-bit, so `text` must be smaller than 4 GiB.
+bool buildJsonStructuralIndex(std::string_view text, std::vector<std::uint32_t>& positions);
+
 } // namespace cashsloth
 
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cash_sloth_json.h"
+
+namespace cashsloth {
+
+class JsonDocument;
+class JsonArrayView;
+class JsonObjectView;
+
+// Read-only handle to a value inside a JsonDocument. Cheap to copy; valid as long as the
+// owning document is alive.
+class JsonNode {
+public:
+    bool isNull() const;
+    bool isBool() const;
+    bool isNumber() const;
+    bool isString() const;
+    bool isArray() const;
+    bool isObject() const;
+
+    bool asBool(bool fallback = false) const;
+    double asNumber(double fallback = 0.0) const;
+    std::string_view asString() const;
+    JsonArrayView asArray() const;
+    JsonObjectView asObject() const;
+
+private:
+    friend class JsonDocument;
+    friend class JsonArrayView;
+    friend class JsonObjectView;
+
+    JsonNode(const JsonDocument* document, std::size_t index) : document_(document), index_(index) {}
+
+    std::size_t next() const;
+
+    const JsonDocument* document_;
+    std::size_t index_;
+};
+
+// Parse result stored as a flat tape: every value and key is one fixed-size entry laid out
+// in document order, containers record where their subtree ends, and all string bytes live
+// in a pool behind the entries. Both share a single allocation sized from the input up front,
+// so building a document allocates once and destroying it is one release.
+//
+// parseInPlace() skips the copy for strings without escapes: their entries point straight
+// into `text`, which must then outlive the document. Only strings that had to be unescaped
+// are written to a small arena owned by the document.
+class JsonDocument {
+public:
+    static JsonDocument parse(std::string_view text);
+    static JsonDocument parseInPlace(std::string_view text);
+    // Report malformed input as a JsonError instead of throwing; see JsonParser::tryParse().
+    static JsonResult<JsonDocument> tryParse(std::string_view text);
+    static JsonResult<JsonDocument> tryParseInPlace(std::string_view text);
+
+    JsonDocument(JsonDocument&&) noexcept = default;
+    JsonDocument& operator=(JsonDocument&&) noexcept = default;
+
+    JsonNode root() const { return JsonNode(this, 0); }
+
+private:
+    friend class JsonNode;
+    friend class JsonArrayView;
+    friend class JsonObjectView;
+    friend class JsonTapeBuilder;
+
+    enum class Type : std::uint32_t { Null, False, True, Number, String, Array, Object };
+
+    // `size` is the string length or the number of elements/members. `payload` holds the
+    // number bits, the address of the string bytes, or for containers the index past the
+    // subtree.
+    struct Entry {
+        Type type;
+        std::uint32_t size;
+        std::uint64_t payload;
+    };
+
+    JsonDocument() = default;
+
+    static JsonResult<JsonDocument> build(std::string_view text, bool inPlace);
+
+    const Entry& entry(std::size_t index) const { return entries_[index]; }
+    std::string_view string(std::size_t index) const {
+        const Entry& e = entries_[index];
+        return std::string_view(reinterpret_cast<const char*>(static_cast<std::uintptr_t>(e.payload)), e.size);
+    }
+
+    std::unique_ptr<unsigned char[]> storage_;
+    std::vector<std::unique_ptr<char[]>> arena_;
+    const Entry* entries_ = nullptr;
+};
+
+class JsonArrayView {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = JsonNode;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = JsonNode;
+
+        const_iterator() = default;
+        JsonNode operator*() const { return JsonNode(document_, index_); }
+        const_iterator& operator++() {
+            index_ = JsonNode(document_, index_).next();
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+
+    private:
+        friend class JsonArrayView;
+        const_iterator(const JsonDocument* document, std::size_t index) : document_(document), index_(index) {}
+
+        const JsonDocument* document_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+    const_iterator begin() const { return const_iterator(document_, index_ + 1); }
+    const_iterator end() const { return const_iterator(document_, document_->entry(index_).payload); }
+    std::size_t size() const { return document_->entry(index_).size; }
+    bool empty() const { return size() == 0; }
+
+    // Walks the tape, so this is linear in the position of the element.
+    JsonNode operator[](std::size_t position) const {
+        auto it = begin();
+        std::advance(it, static_cast<std::ptrdiff_t>(position));
+        return *it;
+    }
+
+private:
+    friend class JsonNode;
+    JsonArrayView(const JsonDocument* document, std::size_t index) : document_(document), index_(index) {}
+
+    const JsonDocument* document_;
+    std::size_t index_;
+};
+
+class JsonObjectView {
+public:
+    using value_type = std::pair<std::string_view, JsonNode>;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = JsonObjectView::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+
+        struct pointer {
+            value_type member;
+            const value_type* operator->() const { return &member; }
+        };
+
+        const_iterator() = default;
+        value_type operator*() const {
+            return value_type(document_->string(index_), JsonNode(document_, index_ + 1));
+        }
+        pointer operator->() const { return pointer{**this}; }
+        const_iterator& operator++() {
+            index_ = JsonNode(document_, index_ + 1).next();
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+
+    private:
+        friend class JsonObjectView;
+        const_iterator(const JsonDocument* document, std::size_t index) : document_(document), index_(index) {}
+
+        const JsonDocument* document_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+    const_iterator begin() const { return const_iterator(document_, index_ + 1); }
+    const_iterator end() const { return const_iterator(document_, document_->entry(index_).payload); }
+    std::size_t size() const { return document_->entry(index_).size; }
+    bool empty() const { return size() == 0; }
+
+    // Linear scan over the members; returns the first match like the std::map based
+    // JsonValue::Object did for duplicate keys.
+    const_iterator find(std::string_view key) const {
+        const auto last = end();
+        for (auto it = begin(); it != last; ++it) {
+            if (document_->string(it.index_) == key) {
+                return it;
+            }
+        }
+        return last;
+    }
+
+private:
+    friend class JsonNode;
+    JsonObjectView(const JsonDocument* document, std::size_t index) : document_(document), index_(index) {}
+
+    const JsonDocument* document_;
+    std::size_t index_;
+};
+
+inline bool JsonNode::isNull() const { return document_->entry(index_).type == JsonDocument::Type::Null; }
+inline bool JsonNode::isBool() const {
+    const auto type = document_->entry(index_).type;
+    return type == JsonDocument::Type::True || type == JsonDocument::Type::False;
+}
+inline bool JsonNode::isNumber() const { return document_->entry(index_).type == JsonDocument::Type::Number; }
+inline bool JsonNode::isString() const { return document_->entry(index_).type == JsonDocument::Type::String; }
+inline bool JsonNode::isArray() const { return document_->entry(index_).type == JsonDocument::Type::Array; }
+inline bool JsonNode::isObject() const { return document_->entry(index_).type == JsonDocument::Type::Object; }
+
+inline bool JsonNode::asBool(bool fallback) const {
+    return isBool() ? document_->entry(index_).type == JsonDocument::Type::True : fallback;
+}
+
+inline double JsonNode::asNumber(double fallback) const {
+    return isNumber() ? std::bit_cast<double>(document_->entry(index_).payload) : fallback;
+}
+
+inline std::string_view JsonNode::asString() const {
+    return isString() ? document_->string(index_) : std::string_view();
+}
+
+inline JsonArrayView JsonNode::asArray() const { return JsonArrayView(document_, index_); }
+inline JsonObjectView JsonNode::asObject() const { return JsonObjectView(document_, index_); }
+
+inline std::size_t JsonNode::next() const {
+    const auto& e = document_->entry(index_);
+    if (e.type == JsonDocument::Type::Array || e.type == JsonDocument::Type::Object) {
+        return static_cast<std::size_t>(e.payload);
+    }
+    return index_ + 1;
+}
+
+} // namespace cashsloth
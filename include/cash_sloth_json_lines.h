@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "cash_sloth_json.h"
+
+namespace cashsloth {
+
+// Reads newline-delimited JSON (one value per line) from a stream in fixed-size chunks, one
+// record at a time. Only the current chunk and the record being assembled are buffered, so
+// memory is bounded by the chunk size and the longest record rather than the input size;
+// this lets logs of any length be replayed from a file or a pipe. Blank lines are skipped
+// and "\r\n" line ends are accepted.
+class JsonLinesReader {
+public:
+    static constexpr std::size_t kDefaultChunkSize = 64 * 1024;
+    static constexpr std::size_t kDefaultMaxRecordSize = 16 * 1024 * 1024;
+
+    // Reads from `input`, which must outlive the reader, e.g. std::cin for a pipe.
+    explicit JsonLinesReader(std::istream& input,
+                             std::size_t chunkSize = kDefaultChunkSize,
+                             std::size_t maxRecordSize = kDefaultMaxRecordSize);
+    // Opens `path` in binary mode; check isOpen() before reading.
+    explicit JsonLinesReader(const std::filesystem::path& path,
+                             std::size_t chunkSize = kDefaultChunkSize,
+                             std::size_t maxRecordSize = kDefaultMaxRecordSize);
+    ~JsonLinesReader();
+
+    JsonLinesReader(const JsonLinesReader&) = delete;
+    JsonLinesReader& operator=(const JsonLinesReader&) = delete;
+
+    bool isOpen() const { return input_ != nullptr; }
+
+    // Parses the next record into `record`, replacing its previous contents. Returns false
+    // at the end of the input. Throws std::runtime_error for a malformed record, naming its
+    // line, or for a line longer than the record limit; reading can continue afterwards
+    // with the following line.
+    bool next(JsonValue& record);
+    // Same as above but reports the record to `handler` without building a value.
+    bool next(JsonHandler& handler);
+
+    // 1-based line of the record returned last.
+    std::size_t lineNumber() const { return lineNumber_; }
+
+private:
+    bool nextLine(std::string_view& line);
+    bool fill();
+    [[noreturn]] void recordError(const char* message) const;
+
+    std::unique_ptr<std::istream> ownedInput_;
+    std::istream* input_ = nullptr;
+    std::size_t chunkSize_;
+    std::size_t maxRecordSize_;
+    std::vector<char> buffer_;
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+    std::size_t scanned_ = 0;
+    std::size_t lineNumber_ = 0;
+    std::size_t nextLineNumber_ = 1;
+    bool skippingLongLine_ = false;
+    bool eof_ = false;
+};
+
+} // namespace cashsloth
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cash_sloth_json.h"
+
+namespace cashsloth {
+
+class ThreadPool;
+
+// First stage of the parallel parser: the positions of all brackets, colons and commas
+// outside of strings. With it, the elements of an array or the members of an object can be
+// cut out of the text without parsing them, so they can be handed to separate threads.
+class JsonStructuralIndex {
+public:
+    // Throws std::runtime_error when the text ends inside a string or is 4 GiB or larger.
+    explicit JsonStructuralIndex(std::string_view text);
+
+    std::string_view text() const { return text_; }
+    const std::vector<std::uint32_t>& positions() const { return positions_; }
+
+    // Element spans of the array whose '[' is at `open`, without surrounding whitespace.
+    // Throws std::runtime_error when the brackets around it do not balance.
+    std::vector<std::string_view> arrayElements(std::size_t open) const;
+    // Key and value spans of the object whose '{' is at `open`, in document order.
+    std::vector<std::pair<std::string_view, std::string_view>> objectMembers(std::size_t open) const;
+
+    // Offset just past the container that opens at `open`.
+    std::size_t containerEnd(std::size_t open) const;
+
+private:
+    // Index into positions_ of the matching close and the depth-1 separators in between.
+    std::size_t findSeparators(std::size_t open, std::vector<std::size_t>& separators) const;
+
+    std::string_view text_;
+    std::vector<std::uint32_t> positions_;
+};
+
+// Parses like JsonParser::parse() and returns an identical value, but splits large arrays
+// into runs of elements that are parsed on `pool`. Arrays with too few elements to share
+// are descended into instead, so a document with a handful of huge categories still spreads
+// their article arrays. Small documents and invalid input take the serial path, which
+// also produces the usual error messages.
+JsonValue parseJsonParallel(std::string_view text, ThreadPool& pool);
+
+} // namespace cashsloth
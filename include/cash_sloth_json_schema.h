@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "cash_sloth_json.h"
+
+namespace cashsloth {
+
+// Declarative binding of JSON objects to C++ structs. A schema lists, once per struct, the
+// JSON key of every field with its aliases, the reader that decodes and checks the value,
+// and whether the object is unusable without it; defaults are the struct's own member
+// initialisers. JsonSchema::read then walks a JsonCursor and stores each member value as it
+// goes: keys are resolved through a perfect hash built at compile time, so no key is copied
+// into a std::string and no map is built. For example:
+//
+//     constexpr auto kArticleSchema = makeJsonSchema(
+//         jsonMember<&Article::name, readJsonString>("name").required(),
+//         jsonMember<&Article::price, readPrice>("price", "preis", "cost").required());
+//
+// Readers have the signature bool(JsonCursor&, std::string& scratch, T& value). They return
+// false and leave `value` alone when the JSON value has the wrong type or is out of range;
+// a reader either consumes the whole value or none of it.
+
+inline constexpr std::size_t kMaxJsonKeys = 4;
+
+template <typename Struct>
+struct JsonField {
+    using Reader = bool (*)(JsonCursor& cursor, std::string& scratch, Struct& target);
+
+    Reader read = nullptr;
+    // The accepted keys in order of precedence.
+    std::array<std::string_view, kMaxJsonKeys> keys{};
+    std::size_t keyCount = 0;
+    bool mandatory = false;
+
+    // Marks the field as one the object is rejected without.
+    constexpr JsonField required() const {
+        JsonField field = *this;
+        field.mandatory = true;
+        return field;
+    }
+};
+
+// A field whose reader works on the whole struct, for JSON objects that group values stored
+// in different members.
+template <typename Struct, typename... Keys>
+constexpr JsonField<Struct> jsonField(typename JsonField<Struct>::Reader read, Keys... keys) {
+    static_assert(sizeof...(Keys) >= 1 && sizeof...(Keys) <= kMaxJsonKeys, "A JSON field needs 1 to 4 keys");
+    return JsonField<Struct>{read, {std::string_view(keys)...}, sizeof...(Keys), false};
+}
+
+template <typename MemberPointer>
+struct JsonMemberPointer;
+
+template <typename Struct, typename Member>
+struct JsonMemberPointer<Member Struct::*> {
+    using StructType = Struct;
+    using MemberType = Member;
+};
+
+// Decodes into a copy so that a rejected value leaves the member as it was; the copy starts
+// from the member so nested objects keep the defaults of the keys they do not mention.
+template <auto Member, auto Read>
+bool readJsonMember(JsonCursor& cursor, std::string& scratch, typename JsonMemberPointer<decltype(Member)>::StructType& target) {
+    typename JsonMemberPointer<decltype(Member)>::MemberType value = target.*Member;
+    if (!Read(cursor, scratch, value)) {
+        return false;
+    }
+    target.*Member = std::move(value);
+    return true;
+}
+
+template <auto Member, auto Read, typename... Keys>
+constexpr auto jsonMember(Keys... keys) {
+    using Struct = typename JsonMemberPointer<decltype(Member)>::StructType;
+    return jsonField<Struct>(&readJsonMember<Member, Read>, keys...);
+}
+
+template <typename Struct, std::size_t FieldCount>
+class JsonSchema {
+public:
+    using Target = Struct;
+
+    // Fails to compile when two fields share a key.
+    consteval explicit JsonSchema(const std::array<JsonField<Struct>, FieldCount>& fields) : fields_(fields) {
+        for (std::uint32_t seed = 0; seed < kMaxSeed; ++seed) {
+            std::array<Slot, kTableSize> table{};
+            bool collision = false;
+            for (std::size_t field = 0; field < FieldCount && !collision; ++field) {
+                for (std::size_t rank = 0; rank < fields_[field].keyCount && !collision; ++rank) {
+                    Slot& slot = table[slotOf(fields_[field].keys[rank], seed)];
+                    collision = slot.field != kNoField;
+                    slot = Slot{fields_[field].keys[rank], static_cast<std::uint8_t>(field), static_cast<std::uint8_t>(rank)};
+                }
+            }
+            if (!collision) {
+                table_ = table;
+                seed_ = seed;
+                return;
+            }
+        }
+        throw "JSON schema keys are not unique";
+    }
+
+    // Reads the object at the cursor into `target`. The first occurrence of a key wins, and of
+    // several aliases of a field the one with the highest precedence that is present decides.
+    // Unknown members are skipped. Returns false when the value is not an object or a
+    // required field is missing or invalid; the value is consumed either way.
+    bool read(JsonCursor& cursor, std::string& scratch, Struct& target) const {
+        if (!cursor.isObject()) {
+            cursor.skipValue();
+            return false;
+        }
+        std::array<std::uint8_t, FieldCount> ranks;
+        ranks.fill(kNoRank);
+        std::array<bool, FieldCount> valid{};
+        std::string_view key;
+        cursor.beginObject();
+        while (cursor.nextKey(key)) {
+            const Slot* slot = find(key);
+            if (!slot || slot->rank >= ranks[slot->field]) {
+                cursor.skipValue();
+                continue;
+            }
+            ranks[slot->field] = slot->rank;
+            const std::size_t start = cursor.offset();
+            valid[slot->field] = fields_[slot->field].read(cursor, scratch, target);
+            if (cursor.offset() == start) {
+                cursor.skipValue();
+            }
+        }
+        for (std::size_t field = 0; field < FieldCount; ++field) {
+            if (fields_[field].mandatory && !valid[field]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static_assert(FieldCount > 0 && FieldCount < 0xFF, "A JSON schema has 1 to 254 fields");
+
+    // A table of four slots per field keeps the search for a seed short.
+    static constexpr std::size_t kTableSize = std::bit_ceil(FieldCount * 4);
+    static constexpr int kTableShift = 32 - std::countr_zero(kTableSize);
+    static constexpr std::uint32_t kMaxSeed = 1u << 16;
+    static constexpr std::uint8_t kNoField = 0xFF;
+    static constexpr std::uint8_t kNoRank = 0xFF;
+
+    struct Slot {
+        std::string_view key;
+        std::uint8_t field = kNoField;
+        std::uint8_t rank = 0;
+    };
+
+    // FNV-1a, spread over the table by a multiplicative step.
+    static constexpr std::size_t slotOf(std::string_view key, std::uint32_t seed) {
+        std::uint32_t hash = 2166136261u ^ seed;
+        for (const char ch : key) {
+            hash ^= static_cast<unsigned char>(ch);
+            hash *= 16777619u;
+        }
+        return static_cast<std::size_t>((hash * 0x9E3779B1u) >> kTableShift);
+    }
+
+    const Slot* find(std::string_view key) const {
+        const Slot& slot = table_[slotOf(key, seed_)];
+        return slot.field != kNoField && slot.key == key ? &slot : nullptr;
+    }
+
+    std::array<JsonField<Struct>, FieldCount> fields_;
+    std::array<Slot, kTableSize> table_{};
+    std::uint32_t seed_ = 0;
+};
+
+template <typename Struct, typename... Fields>
+consteval JsonSchema<Struct, 1 + sizeof...(Fields)> makeJsonSchema(JsonField<Struct> first, Fields... rest) {
+    return JsonSchema<Struct, 1 + sizeof...(Fields)>(
+        std::array<JsonField<Struct>, 1 + sizeof...(Fields)>{first, JsonField<Struct>(rest)...});
+}
+
+// Reader for a nested object bound by another schema.
+template <const auto& Schema>
+bool readJsonObject(JsonCursor& cursor, std::string& scratch, typename std::remove_cvref_t<decltype(Schema)>::Target& target) {
+    return Schema.read(cursor, scratch, target);
+}
+
+inline bool readJsonString(JsonCursor& cursor, std::string& scratch, std::string& value) {
+    if (!cursor.isString()) {
+        return false;
+    }
+    value.assign(cursor.readString(scratch));
+    return true;
+}
+
+// Numbers outside [Min, Max] are clamped into it.
+template <double Min = -std::numeric_limits<double>::infinity(), double Max = std::numeric_limits<double>::infinity()>
+bool readJsonNumber(JsonCursor& cursor, std::string&, double& value) {
+    if (!cursor.isNumber()) {
+        return false;
+    }
+    value = std::clamp(cursor.readNumber(), Min, Max);
+    return true;
+}
+
+// Rounds to the nearest integer, then clamps into [Min, Max].
+template <int Min = std::numeric_limits<int>::min(), int Max = std::numeric_limits<int>::max()>
+bool readJsonInt(JsonCursor& cursor, std::string&, int& value) {
+    if (!cursor.isNumber()) {
+        return false;
+    }
+    const double rounded = std::round(cursor.readNumber());
+    value = static_cast<int>(std::clamp(rounded, static_cast<double>(Min), static_cast<double>(Max)));
+    return true;
+}
+
+} // namespace cashsloth
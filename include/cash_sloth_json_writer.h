@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cash_sloth_json.h"
+
+namespace cashsloth {
+
+// Streaming JSON serialiser. Output is appended to a caller-owned buffer, or staged in an
+// internal buffer and flushed to a stream in large blocks. Numbers are written with
+// std::to_chars (shortest round-trip form), exact decimals with the digits they were read
+// with, and strings are escaped run by run, so once the
+// buffers have grown to their working size no call allocates.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& buffer, int indent = 0);
+    explicit JsonWriter(std::ostream& stream, int indent = 0);
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(std::string_view name);
+
+    void value(std::string_view text);
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(double number);
+    void value(std::int64_t number);
+    void value(int number) { value(static_cast<std::int64_t>(number)); }
+    void value(bool flag);
+    void value(const JsonNumber& number);
+    void nullValue();
+    void write(const JsonValue& value);
+
+    // Forgets any open containers so the writer can start a new document. The caller's
+    // buffer is left untouched; clear it separately when reusing it.
+    void reset();
+    void flush();
+
+private:
+    void beforeValue();
+    void newline();
+    void appendEscaped(std::string_view text);
+    void maybeFlush();
+
+    std::string* out_;
+    std::ostream* stream_ = nullptr;
+    std::string staging_;
+    std::vector<bool> hasElements_;
+    int indent_ = 0;
+    bool afterKey_ = false;
+};
+
+} // namespace cashsloth
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+namespace cashsloth {
+
+// Read-only view of a whole file. The contents are mapped into memory (mmap on POSIX, a file
+// mapping on Windows) so the parser reads straight from the page cache without a copy. When
+// mapping is not possible the file is read into one buffer with a single bulk read instead.
+// The view stays valid for the lifetime of the object.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return open_; }
+    bool isMapped() const { return mapping_ != nullptr; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+private:
+    void release();
+    bool readAll(const std::filesystem::path& path);
+
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    void* mapping_ = nullptr;
+    std::unique_ptr<char[]> buffer_;
+    bool open_ = false;
+};
+
+} // namespace cashsloth
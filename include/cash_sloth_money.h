@@ -0,0 +1,59 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace cashsloth {
+
+// Room for the longest amount Money::format() can produce, "-92233720368547758.08".
+inline constexpr std::size_t kMoneyTextCapacity = 24;
+
+// An amount of Swiss francs counted in whole Rappen. Sums, differences and multiples are
+// exact and throw std::overflow_error instead of wrapping, so a total is the same however
+// many items were added and in which order. Parsing and formatting work on the caller's
+// characters and buffers and never allocate.
+class Money {
+public:
+    constexpr Money() = default;
+    static constexpr Money fromRappen(std::int64_t rappen) { return Money(rappen); }
+    // mantissa * 10^exponent francs, as JsonNumber keeps them, to the nearest Rappen with
+    // halves rounded away from zero; std::nullopt when that does not fit.
+    static std::optional<Money> fromDecimal(std::int64_t mantissa, int exponent);
+    // Reads amounts as a cashier types them: "3.50", "3,5", "-12", "1'250.00 CHF". Spaces
+    // anywhere are ignored; digits past the Rappen round to the nearest one. std::nullopt for
+    // anything else, including exponents, "nan" and amounts that do not fit.
+    static std::optional<Money> parse(std::string_view text);
+
+    constexpr std::int64_t rappen() const { return rappen_; }
+
+    // Cash is paid in multiples of 5 Rappen: 1 and 2 round down, 3 and 4 up, and likewise
+    // from the five, for negative amounts mirrored. Amounts are whole Rappen, so there is no
+    // midpoint to break: a typed 0.025 is 0.03 after parse() and is paid as 0.05.
+    Money roundedToFiveRappen() const;
+
+    // Writes the amount with two decimals, for example "3.50" or "-0.05", without a
+    // terminating NUL, and returns the number of characters written.
+    std::size_t format(char* out) const;
+    std::size_t format(char16_t* out) const;
+
+    Money& operator+=(Money other);
+    Money& operator-=(Money other);
+    Money operator-() const;
+    friend Money operator+(Money left, Money right) { return left += right; }
+    friend Money operator-(Money left, Money right) { return left -= right; }
+    friend Money operator*(Money amount, std::int64_t quantity);
+    friend Money operator*(std::int64_t quantity, Money amount) { return amount * quantity; }
+
+    friend constexpr bool operator==(const Money&, const Money&) = default;
+    friend constexpr std::strong_ordering operator<=>(const Money&, const Money&) = default;
+
+private:
+    constexpr explicit Money(std::int64_t rappen) : rappen_(rappen) {}
+
+    std::int64_t rappen_ = 0;
+};
+
+} // namespace cashsloth
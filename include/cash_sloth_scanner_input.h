@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cash_sloth_catalogue_store.h"
+#include "cash_sloth_spsc_ring.h"
+
+namespace cashsloth {
+
+class Catalogue;
+
+// One UTF-16 unit of a WM_CHAR, with the time it was typed.
+struct Keystroke {
+    char16_t unit = 0;
+    std::uint64_t timeMicros = 0;
+};
+
+struct ScanSettings {
+    // Longest pause between two keystrokes of one scan. Scanners send a character every few
+    // milliseconds; people need well over 50 ms, and Windows stamps messages in ticks of
+    // about 16 ms.
+    std::uint64_t maxGapMicros = 35000;
+    // Shorter bursts are taken as typing, so that a quickly typed word is not looked up.
+    std::size_t minLength = 4;
+};
+
+// What the detector made of the keystrokes: complete scanned codes, and the text typed by hand,
+// in typing order.
+struct ScannerOutput {
+    std::vector<std::string> codes;
+    std::u16string typed;
+
+    bool empty() const { return codes.empty() && typed.empty(); }
+    void clear() {
+        codes.clear();
+        typed.clear();
+    }
+};
+
+// Tells a scanner in keyboard-wedge mode from a person at the keyboard by timing alone.
+// Keystrokes that follow each other within maxGapMicros form a run. A run of at least minLength
+// printable ASCII characters is a scan; it ends with Enter or Tab, which scanners send as a
+// suffix, or with the next pause. Anything else is typed text. A keystroke is therefore held
+// back until the next one arrives or the pause after it is long enough to decide, which delays
+// typing by maxGapMicros. The detector keeps no clock of its own, so a recorded stream of
+// keystrokes replays to the same result on any machine.
+class BurstDetector {
+public:
+    explicit BurstDetector(ScanSettings settings = {}) : settings_(settings) {}
+
+    // Keystrokes must come in time order.
+    void feed(const Keystroke& key, ScannerOutput& output);
+    // Decides the run that is held back once no keystroke can join it any more.
+    void flush(std::uint64_t nowMicros, ScannerOutput& output);
+    // When flush() will next have something to decide, or nothing while no keystroke is held.
+    std::optional<std::uint64_t> deadline() const;
+
+private:
+    void settle(ScannerOutput& output);
+
+    ScanSettings settings_;
+    std::u16string held_;
+    std::uint64_t lastMicros_ = 0;
+};
+
+// Everything the scanner input recognised since the UI last took it.
+struct ScanBatch {
+    std::vector<ArticleHandle> articles;
+    std::vector<std::string> unknownCodes;
+    std::u16string typed;
+
+    bool empty() const { return articles.empty() && unknownCodes.empty() && typed.empty(); }
+};
+
+// Barcode input for the till. The input thread pushes keystrokes into a lock-free ring and
+// never waits. A worker thread runs them through a BurstDetector and looks the scanned codes
+// up in the current catalogue. Articles, unknown codes and typed text collect in one batch
+// until the UI takes it, so a run of scans costs the UI a single update however fast they
+// come.
+class ScannerInput {
+public:
+    // Microseconds on the clock that Keystroke::timeMicros is taken from.
+    using Clock = std::function<std::uint64_t()>;
+
+    // `onBatch` runs on the worker thread when an empty batch gets its first entry. It should
+    // only notify the owning thread, which then calls takeBatch().
+    ScannerInput(Clock clock, std::function<void()> onBatch, ScanSettings settings = {});
+    ~ScannerInput();
+
+    ScannerInput(const ScannerInput&) = delete;
+    ScannerInput& operator=(const ScannerInput&) = delete;
+
+    // From a single input thread. False when the ring is full, in which case the caller
+    // should handle the keystroke itself.
+    bool push(const Keystroke& key);
+    // Codes are looked up in `catalogue` from now on; without one every code is unknown.
+    void setCatalogue(std::shared_ptr<const Catalogue> catalogue);
+    ScanBatch takeBatch();
+
+private:
+    void run();
+    void deliver(const ScannerOutput& output);
+
+    Clock clock_;
+    std::function<void()> onBatch_;
+    BurstDetector detector_;
+    SpscRing<Keystroke, 1024> ring_;
+    // Counts pushes, so the worker can sleep on it with atomic wait() without missing one.
+    std::atomic<std::uint32_t> pushed_{0};
+    std::atomic<bool> stopping_{false};
+
+    std::mutex mutex_;
+    std::shared_ptr<const Catalogue> catalogue_;
+    ScanBatch batch_;
+    std::thread thread_;
+};
+
+} // namespace cashsloth
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace cashsloth {
+
+// Fixed-size queue between exactly one producer thread and one consumer thread, without locks:
+// each side writes only its own index and reads the other's. The indices are padded apart so
+// the two threads do not share a cache line. tryPush() fails rather than waits when the ring
+// is full.
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    // Producer side.
+    bool tryPush(const T& value) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots_[head & (Capacity - 1)] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side.
+    bool tryPop(T& value) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots_[tail & (Capacity - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr std::size_t kCacheLine = 64;
+
+    std::atomic<std::size_t> head_{0};
+    char headPadding_[kCacheLine - sizeof(std::atomic<std::size_t>)]{};
+    std::atomic<std::size_t> tail_{0};
+    char tailPadding_[kCacheLine - sizeof(std::atomic<std::size_t>)]{};
+    std::array<T, Capacity> slots_{};
+};
+
+} // namespace cashsloth
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+
+namespace cashsloth {
+
+// Timeline of one start of the till: which steps ran on which thread, and when the first
+// frame and the loaded catalogue reached the screen. Nothing is recorded until enable() is
+// called; after that an event costs a lock and a push_back. writeTo() writes the Trace
+// Event Format that chrome://tracing and Perfetto open. Times count from the static
+// initialisation of the program.
+class StartupTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Records the time from construction to destruction as one step. `name` must outlive the
+    // trace, which a string literal does.
+    class Span {
+    public:
+        explicit Span(const char* name);
+        ~Span();
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* name_;
+        Clock::time_point start_;
+    };
+
+    // The calling thread is shown as the main thread.
+    static void enable();
+    static bool enabled();
+    // Records a point in time, such as the first frame on screen.
+    static void mark(const char* name);
+    // Stops recording, so that later reloads do not add to a trace that is already out.
+    static bool writeTo(const std::filesystem::path& path);
+};
+
+} // namespace cashsloth
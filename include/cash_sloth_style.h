@@ -1,7 +1,6 @@
 #pragma once
 
 #include <filesystem>
-#include <optional>
 #include <string>
 #include <vector>
 
@@ -17,7 +16,7 @@
 #undef min
 #endif
 
-#include "cash_sloth_json.h"
+#include "cash_sloth_money.h"
 
 namespace cashsloth {
 
@@ -89,17 +88,12 @@ struct StyleSheet {
     } hero;
 
     std::wstring fontFamily = L"Segoe UI";
-    std::vector<double> quickAmounts{0.5, 1.0, 2.0, 5.0, 10.0, 20.0};
+    std::vector<Money> quickAmounts{Money::fromRappen(50), Money::fromRappen(100), Money::fromRappen(200),
+                                    Money::fromRappen(500), Money::fromRappen(1000), Money::fromRappen(2000)};
     double glassStrength = 0.2;
     double accentGlow = 0.3;
 
     static StyleSheet load(const std::filesystem::path& baseDir);
-
-private:
-    static std::optional<COLORREF> parseColorValue(const JsonValue& value);
-    static std::optional<COLORREF> parseHexColor(const std::string& text);
-    static int parseFontWeightToken(const std::string& token);
-    static FontSpec parseFontSpec(const JsonValue& node, FontSpec fallback);
 };
 
 COLORREF mixColor(COLORREF start, COLORREF target, double factor);
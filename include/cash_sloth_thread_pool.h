@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cashsloth {
+
+// Fixed set of worker threads fed from one queue. Work is handed out with parallelFor(),
+// where the calling thread takes items as well; it therefore never waits on a queue that
+// is blocked behind its own caller and can be used from inside pool tasks.
+class ThreadPool {
+public:
+    // 0 picks one worker per hardware thread, minus the caller.
+    explicit ThreadPool(std::size_t workers = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads that run parallelFor() bodies, including the caller.
+    std::size_t concurrency() const { return workers_.size() + 1; }
+
+    void post(std::function<void()> task);
+
+    // Calls body(i) for every i in [0, count) and returns once all calls finished. The
+    // first exception thrown by a body is rethrown here after the remaining items ran.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+    // Process-wide pool, created on first use.
+    static ThreadPool& shared();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
+
+} // namespace cashsloth
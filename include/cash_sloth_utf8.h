@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace cashsloth {
+
+// UTF-8 validation and UTF-8/UTF-16 transcoding without the Win32 API, so the parser and the
+// tests can use it on any platform. Runs of ASCII are checked and widened or narrowed 16
+// bytes at a time; only the multi-byte sequences in between are decoded one by one, and
+// each is validated while it is converted, so a string is read once.
+
+// Offset of the first byte that does not start a well-formed UTF-8 sequence (overlong
+// forms, surrogates and values above U+10FFFF are ill-formed), or text.size() if there is
+// none.
+std::size_t findInvalidUtf8(std::string_view text);
+
+inline bool isValidUtf8(std::string_view text) {
+    return findInvalidUtf8(text) == text.size();
+}
+
+// Length of the well-formed sequence at the start of [data, data + size), which must not be
+// empty, or 0 when it is ill-formed. Lets scanners that already stop at non-ASCII bytes
+// validate in place.
+std::size_t utf8SequenceLength(const char* data, std::size_t size);
+
+// Writes the UTF-16 form of `text` to `out`, which needs room for text.size() units, and
+// returns the number of units written. Each maximal ill-formed subsequence becomes one
+// U+FFFD, matching MultiByteToWideChar(CP_UTF8, 0, ...).
+std::size_t utf8ToUtf16(std::string_view text, char16_t* out);
+
+// Writes the UTF-8 form of `text` to `out`, which needs room for 3 * text.size() bytes, and
+// returns the number of bytes written. Unpaired surrogates become U+FFFD, matching
+// WideCharToMultiByte(CP_UTF8, 0, ...).
+std::size_t utf16ToUtf8(std::u16string_view text, char* out);
+
+// Appends the UTF-8 encoding of `codepoint`; surrogates and values above U+10FFFF are
+// written as U+FFFD.
+void appendUtf8(std::string& out, char32_t codepoint);
+
+} // namespace cashsloth
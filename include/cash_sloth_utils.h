@@ -2,13 +2,15 @@
 
 #include <algorithm>
 #include <cctype>
-#include <iomanip>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 
+#include "cash_sloth_money.h"
+#include "cash_sloth_utf8.h"
+
 #ifndef NOMINMAX
 #define NOMINMAX
 #endif
@@ -38,30 +40,36 @@ inline std::string toLower(std::string text) {
     return text;
 }
 
-inline std::wstring toWide(const std::string& value) {
-    if (value.empty()) {
-        return std::wstring();
-    }
-    const int required = MultiByteToWideChar(CP_UTF8, 0, value.c_str(), static_cast<int>(value.size()), nullptr, 0);
-    std::wstring result(static_cast<std::size_t>(required), L'\0');
-    MultiByteToWideChar(CP_UTF8, 0, value.c_str(), static_cast<int>(value.size()), result.data(), required);
+// Wide strings are UTF-16 on Windows, so both helpers size the result from the input and
+// convert in a single pass instead of asking the Win32 API for the length first.
+inline std::wstring toWide(std::string_view value) {
+    static_assert(sizeof(wchar_t) == sizeof(char16_t), "toWide expects UTF-16 wide strings");
+    std::wstring result(value.size(), L'\0');
+    result.resize(utf8ToUtf16(value, reinterpret_cast<char16_t*>(result.data())));
     return result;
 }
 
+// Views UTF-16 text, such as the catalogue's display strings, as wide characters without
+// copying it.
+inline std::wstring_view asWide(std::u16string_view value) {
+    static_assert(sizeof(wchar_t) == sizeof(char16_t), "asWide expects UTF-16 wide strings");
+    return std::wstring_view(reinterpret_cast<const wchar_t*>(value.data()), value.size());
+}
+
 inline std::string toNarrow(const std::wstring& value) {
-    if (value.empty()) {
-        return std::string();
-    }
-    const int required = WideCharToMultiByte(CP_UTF8, 0, value.c_str(), static_cast<int>(value.size()), nullptr, 0, nullptr, nullptr);
-    std::string result(static_cast<std::size_t>(required), '\0');
-    WideCharToMultiByte(CP_UTF8, 0, value.c_str(), static_cast<int>(value.size()), result.data(), required, nullptr, nullptr);
+    std::string result(value.size() * 3, '\0');
+    result.resize(utf16ToUtf8(
+        std::u16string_view(reinterpret_cast<const char16_t*>(value.data()), value.size()), result.data()));
     return result;
 }
 
-inline std::string formatCurrency(double amount) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(2) << amount << " CHF";
-    return oss.str();
+inline std::wstring formatCurrency(Money amount) {
+    char16_t text[kMoneyTextCapacity + 4];
+    std::size_t length = amount.format(text);
+    for (const char16_t unit : std::u16string_view(u" CHF")) {
+        text[length++] = unit;
+    }
+    return std::wstring(asWide(std::u16string_view(text, length)));
 }
 
 inline std::wstring formatWindowsErrorMessage(DWORD error) {
@@ -83,25 +91,20 @@ inline std::wstring formatWindowsErrorMessage(DWORD error) {
     return message;
 }
 
-inline std::optional<double> parseAmount(const std::string& text) {
-    std::string cleaned = trim(text);
-    cleaned.erase(
-        std::remove_if(cleaned.begin(), cleaned.end(), [](unsigned char ch) { return std::isspace(ch); }),
-        cleaned.end());
-    std::replace(cleaned.begin(), cleaned.end(), ',', '.');
-    if (cleaned.empty()) {
+// Entry fields hold at most a few dozen characters; anything longer or outside ASCII is not
+// an amount, so the text is narrowed into a fixed buffer for Money::parse.
+inline std::optional<Money> parseAmount(std::wstring_view text) {
+    char narrow[64];
+    if (text.size() > std::size(narrow)) {
         return std::nullopt;
     }
-    try {
-        size_t consumed = 0;
-        const double value = std::stod(cleaned, &consumed);
-        if (consumed == cleaned.size()) {
-            return value;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] > 0x7F) {
+            return std::nullopt;
         }
-    } catch (const std::exception&) {
-        return std::nullopt;
+        narrow[i] = static_cast<char>(text[i]);
     }
-    return std::nullopt;
+    return Money::parse(std::string_view(narrow, text.size()));
 }
 
 } // namespace cashsloth
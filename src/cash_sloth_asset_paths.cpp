@@ -0,0 +1,45 @@
+#include "cash_sloth_asset_paths.h"
+
+#include <system_error>
+
+#include "cash_sloth_thread_pool.h"
+
+namespace cashsloth {
+
+std::vector<std::filesystem::path> styleCandidates(const std::filesystem::path& baseDir) {
+    return {
+        baseDir / "assets" / "style.json",
+        baseDir / "style.json",
+        baseDir / "cash_sloth_styles_v25.11.json"
+    };
+}
+
+std::vector<std::filesystem::path> catalogueCandidates(const std::filesystem::path& baseDir) {
+    return {
+        baseDir / "assets" / "cash_sloth_catalog.json",
+        baseDir / "assets" / "catalog.json",
+        baseDir / "cash_sloth_catalog.json",
+        baseDir / "cash_sloth_catalog_v25.11.json",
+        baseDir / "cash_sloth_catalog_v25.10.json",
+        baseDir / "konfiguration.json",
+        baseDir / "Configs" / "konfiguration.json",
+        baseDir / "configs" / "konfiguration.json"
+    };
+}
+
+std::vector<std::filesystem::path> existingFiles(const std::vector<std::filesystem::path>& candidates) {
+    std::vector<char> exists(candidates.size(), 0);
+    ThreadPool::shared().parallelFor(candidates.size(), [&](std::size_t index) {
+        std::error_code error;
+        exists[index] = std::filesystem::is_regular_file(candidates[index], error) ? 1 : 0;
+    });
+    std::vector<std::filesystem::path> found;
+    for (std::size_t index = 0; index < candidates.size(); ++index) {
+        if (exists[index]) {
+            found.push_back(candidates[index]);
+        }
+    }
+    return found;
+}
+
+} // namespace cashsloth
@@ -0,0 +1,580 @@
+#include "cash_sloth_catalogue.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "cash_sloth_catalogue_diff.h"
+#include "cash_sloth_catalogue_search.h"
+#include "cash_sloth_catalogue_snapshot.h"
+#include "cash_sloth_json.h"
+#include "cash_sloth_json_parallel.h"
+#include "cash_sloth_json_schema.h"
+#include "cash_sloth_json_writer.h"
+#include "cash_sloth_mapped_file.h"
+#include "cash_sloth_startup_trace.h"
+#include "cash_sloth_thread_pool.h"
+
+namespace {
+
+using cashsloth::Article;
+using cashsloth::Category;
+
+// Category arrays in exports at least this large are read on the shared thread pool.
+constexpr std::size_t kParallelReadBytes = 4 * 1024 * 1024;
+
+std::string normalizeBarcode(std::string_view raw) {
+    std::string result;
+    result.reserve(raw.size());
+    for (char ch : raw) {
+        if (!std::isspace(static_cast<unsigned char>(ch))) {
+            result.push_back(ch);
+        }
+    }
+    return result;
+}
+
+// Prices are numbers or text such as "3,50" and are rounded to whole Rappen from their decimal
+// digits, not from a double. Negative ones, "nan", "inf" and amounts from kMaxPrice up are
+// rejected, so that every price fits the store's cents.
+bool readPrice(cashsloth::JsonCursor& cursor, std::string& scratch, cashsloth::Money& price) {
+    std::optional<cashsloth::Money> parsed;
+    if (cursor.isNumber()) {
+        const cashsloth::JsonNumber number = cursor.readDecimal();
+        if (number.isExact()) {
+            parsed = cashsloth::Money::fromDecimal(number.mantissa(), number.exponent());
+        }
+    } else if (cursor.isString()) {
+        parsed = cashsloth::Money::parse(cursor.readString(scratch));
+    }
+    if (!parsed.has_value() || parsed.value() < cashsloth::Money() || parsed.value() >= cashsloth::kMaxPrice) {
+        return false;
+    }
+    price = parsed.value();
+    return true;
+}
+
+bool readBarcode(cashsloth::JsonCursor& cursor, std::string& scratch, std::string& barcode) {
+    if (!cursor.isString()) {
+        return false;
+    }
+    barcode = normalizeBarcode(cursor.readString(scratch));
+    return true;
+}
+
+// "price" takes precedence over "preis" and "cost" regardless of the order they appear in.
+constexpr auto kArticleSchema = cashsloth::makeJsonSchema(
+    cashsloth::jsonMember<&Article::name, cashsloth::readJsonString>("name").required(),
+    cashsloth::jsonMember<&Article::price, readPrice>("price", "preis", "cost").required(),
+    cashsloth::jsonMember<&Article::barcode, readBarcode>("barcode"));
+
+// Elements that are not valid articles are dropped; an array without any is rejected.
+bool readArticles(cashsloth::JsonCursor& cursor, std::string& scratch, std::vector<Article>& articles) {
+    if (!cursor.isArray()) {
+        return false;
+    }
+    cursor.beginArray();
+    while (cursor.nextElement()) {
+        Article article;
+        if (kArticleSchema.read(cursor, scratch, article)) {
+            articles.push_back(std::move(article));
+        }
+    }
+    return !articles.empty();
+}
+
+constexpr auto kCategorySchema = cashsloth::makeJsonSchema(
+    cashsloth::jsonMember<&Category::name, cashsloth::readJsonString>("name").required(),
+    cashsloth::jsonMember<&Category::articles, readArticles>("articles").required());
+
+// Reads categories through a JsonCursor so that only the fields the catalogue uses are
+// decoded; vendor metadata and other unknown members are skipped without being parsed.
+// Accepts the same layouts as before: a top-level array of categories, an object with a
+// "categories" array, or an object keyed by category name whose values are article arrays.
+// Duplicate keys resolve to their first occurrence and keyed categories come out in key
+// order, matching what the std::map based DOM produced.
+class CatalogueReader {
+public:
+    explicit CatalogueReader(std::string_view text) : text_(text), cursor_(text) {}
+
+    std::vector<Category> read() {
+        if (cursor_.isArray()) {
+            return readCategoryList();
+        }
+        if (!cursor_.isObject()) {
+            return {};
+        }
+        // Keyed categories are collected on the way in case no "categories" array turns up.
+        std::set<std::string> seen;
+        std::map<std::string, Category> keyed;
+        std::string_view key;
+        cursor_.beginObject();
+        while (cursor_.nextKey(key)) {
+            if (!seen.emplace(key).second || !cursor_.isArray()) {
+                cursor_.skipValue();
+                continue;
+            }
+            if (key == "categories") {
+                return readCategoryList();
+            }
+            Category category;
+            category.name.assign(key);
+            if (readArticles(cursor_, scratch_, category.articles)) {
+                std::string name = category.name;
+                keyed.emplace(std::move(name), std::move(category));
+            }
+        }
+        std::vector<Category> result;
+        result.reserve(keyed.size());
+        for (auto& entry : keyed) {
+            result.push_back(std::move(entry.second));
+        }
+        return result;
+    }
+
+private:
+    std::vector<Category> readCategoryList() {
+        if (text_.size() >= kParallelReadBytes && cashsloth::ThreadPool::shared().concurrency() > 1) {
+            if (auto categories = readCategoryListParallel()) {
+                return std::move(*categories);
+            }
+        }
+        std::vector<Category> result;
+        cursor_.beginArray();
+        while (cursor_.nextElement()) {
+            if (auto category = readCategory()) {
+                result.push_back(std::move(*category));
+            }
+        }
+        return result;
+    }
+
+    // Cuts the category array into its elements with a structural index and reads them on the
+    // shared pool, each with its own reader, joining the results in document order. Gives up
+    // with std::nullopt on anything the serial reader might handle differently, such as an
+    // element that does not end where the index says it does, so that path reports it.
+    std::optional<std::vector<Category>> readCategoryListParallel() {
+        try {
+            const cashsloth::JsonStructuralIndex index(text_);
+            const std::vector<std::string_view> elements = index.arrayElements(cursor_.offset());
+            std::vector<std::optional<Category>> slots(elements.size());
+            cashsloth::ThreadPool& pool = cashsloth::ThreadPool::shared();
+            const std::size_t runs = std::min(elements.size(), pool.concurrency() * 4);
+            pool.parallelFor(runs, [&](std::size_t run) {
+                for (std::size_t i = elements.size() * run / runs; i < elements.size() * (run + 1) / runs; ++i) {
+                    CatalogueReader reader(elements[i]);
+                    slots[i] = reader.readCategory();
+                    if (reader.cursor_.offset() != elements[i].size()) {
+                        throw std::runtime_error("Unexpected token while parsing JSON");
+                    }
+                }
+            });
+            std::vector<Category> result;
+            for (std::optional<Category>& slot : slots) {
+                if (slot) {
+                    result.push_back(std::move(*slot));
+                }
+            }
+            return result;
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+
+    std::optional<Category> readCategory() {
+        Category category;
+        if (!kCategorySchema.read(cursor_, scratch_, category)) {
+            return std::nullopt;
+        }
+        return category;
+    }
+
+    std::string_view text_;
+    cashsloth::JsonCursor cursor_;
+    std::string scratch_;
+};
+
+}  // namespace
+
+namespace cashsloth {
+
+Catalogue::Catalogue() = default;
+Catalogue::~Catalogue() = default;
+Catalogue::Catalogue(Catalogue&&) noexcept = default;
+Catalogue& Catalogue::operator=(Catalogue&&) noexcept = default;
+
+// The snapshot is keyed to a hash of the JSON's bytes rather than to its modification time,
+// which copies, checkouts and coarse file systems keep across an edit that leaves the size
+// alone; a snapshot with old prices must never be used. Hashing reads the file once, which
+// costs far less than parsing it.
+bool Catalogue::loadFromFile(const std::filesystem::path& path, SnapshotCache cache) {
+    const MappedFile file(path);
+    if (!file.isOpen()) {
+        return false;
+    }
+    const std::string_view source = file.view();
+    const bool cached = cache == SnapshotCache::Use;
+    const std::filesystem::path snapshotPath = snapshotPathFor(path);
+    std::uint64_t sourceHash = 0;
+    if (cached) {
+        const StartupTrace::Span span("hash catalogue");
+        sourceHash = hashBytes(source);
+    }
+
+    if (auto snapshot = cached ? CatalogueSnapshot::open(snapshotPath) : std::nullopt;
+        snapshot && snapshot->matches(sourceHash, source.size())) {
+        try {
+            const StartupTrace::Span span("catalogue from snapshot");
+            CatalogueStore store = snapshot->store();
+            if (store.categoryCount() != 0) {
+                store_ = std::move(store);
+                snapshot_ = std::make_unique<CatalogueSnapshot>(std::move(*snapshot));
+                rebuildArticleIndex();
+                loadedFile_ = path;
+                return true;
+            }
+        } catch (const std::exception& exc) {
+            std::cerr << "Warnung: Katalog-Snapshot \"" << snapshotPath << "\" ist beschaedigt und wird neu erstellt: "
+                      << exc.what() << '\n';
+        }
+    }
+
+    try {
+        const StartupTrace::Span span("catalogue from JSON");
+        CatalogueReader reader(source);
+        std::vector<Category> newCategories = reader.read();
+        if (newCategories.empty()) {
+            return false;
+        }
+        CatalogueStore store(newCategories);
+        newCategories = {};
+        CatalogueSnapshot snapshot = CatalogueSnapshot::build(store, sourceHash, source.size());
+        if (cached) {
+            const StartupTrace::Span writeSpan("write catalogue snapshot");
+            // A read-only installation simply parses the JSON again next time.
+            snapshot.writeTo(snapshotPath);
+        }
+        store_ = std::move(store);
+        snapshot_ = std::make_unique<CatalogueSnapshot>(std::move(snapshot));
+        rebuildArticleIndex();
+        loadedFile_ = path;
+        return true;
+    } catch (const std::exception& exc) {
+        std::cerr << "Warnung: Katalog konnte nicht aus \"" << path << "\" gelesen werden: "
+                  << exc.what() << '\n';
+        return false;
+    }
+}
+
+// Writes the catalogue in the normalised "categories" layout that loadFromFile reads back.
+bool Catalogue::saveToFile(const std::filesystem::path& path) const {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    if (!output.is_open()) {
+        return false;
+    }
+    {
+        JsonWriter writer(output, 2);
+        writer.beginObject();
+        writer.key("version");
+        writer.value(1);
+        writer.key("categories");
+        writer.beginArray();
+        for (std::size_t category = 0; category < store_.categoryCount(); ++category) {
+            writer.beginObject();
+            writer.key("name");
+            writer.value(store_.categoryName(category));
+            writer.key("articles");
+            writer.beginArray();
+            for (std::size_t article = store_.firstArticle(category); article < store_.firstArticle(category + 1); ++article) {
+                writer.beginObject();
+                writer.key("name");
+                writer.value(store_.name(article));
+                writer.key("price");
+                writer.value(JsonNumber::fromDecimal(store_.priceCents(article), -2));
+                writer.key("barcode");
+                if (store_.barcode(article).empty()) {
+                    writer.nullValue();
+                } else {
+                    writer.value(store_.barcode(article));
+                }
+                writer.endObject();
+            }
+            writer.endArray();
+            writer.endObject();
+        }
+        writer.endArray();
+        writer.endObject();
+    }
+    output.put('\n');
+    return static_cast<bool>(output);
+}
+
+void Catalogue::loadDefault() {
+    store_ = CatalogueStore(buildDefaultCatalogue());
+    snapshot_ = std::make_unique<CatalogueSnapshot>(CatalogueSnapshot::build(store_, 0, 0));
+    rebuildArticleIndex();
+    loadedFile_.clear();
+}
+
+void Catalogue::copyFrom(const Catalogue& other) {
+    store_ = other.store_;
+    snapshot_ = std::make_unique<CatalogueSnapshot>(CatalogueSnapshot::build(store_, 0, 0));
+    rebuildArticleIndex();
+    loadedFile_ = other.loadedFile_;
+}
+
+// Scanners send the bare code, which is looked up where it lies; only input with whitespace
+// in it is copied.
+std::optional<std::size_t> Catalogue::findByBarcode(std::string_view raw) const {
+    std::string stripped;
+    std::string_view normalized = raw;
+    if (std::any_of(raw.begin(), raw.end(), [](unsigned char ch) { return std::isspace(ch); })) {
+        stripped = normalizeBarcode(raw);
+        normalized = stripped;
+    }
+    if (normalized.empty() || !snapshot_) {
+        return std::nullopt;
+    }
+    if (const auto override = barcodeOverrides_.find(normalized); override != barcodeOverrides_.end()) {
+        return store_.resolve(override->second);
+    }
+    const auto index = snapshot_->findBarcode(normalized);
+    if (!index) {
+        return std::nullopt;
+    }
+    return store_.resolve(snapshotHandles_[*index]);
+}
+
+std::vector<std::size_t> Catalogue::search(std::string_view query, std::size_t limit) const {
+    return search_ ? search_->find(query, limit) : std::vector<std::size_t>{};
+}
+
+void Catalogue::apply(const CatalogueDiff& diff) {
+    const auto mismatch = [] {
+        throw std::runtime_error("Catalogue diff does not match the catalogue");
+    };
+    const std::size_t categoryCount = store_.categoryCount();
+    if (diff.previousCategoryCount != categoryCount || diff.categorySources.size() != diff.categories.size()) {
+        mismatch();
+    }
+
+    // Everything is checked before the first article is touched.
+    const std::size_t articleCount = store_.articleCount();
+    std::vector<char> leaving(articleCount, 0);
+    std::vector<const ArticleChange*> updates(articleCount, nullptr);
+    std::vector<std::vector<const ArticleChange*>> arrivals(diff.categories.size());
+    for (const ArticleChange& change : diff.changes) {
+        if (change.kind != ArticleChange::Kind::Added) {
+            if (change.fromCategory >= categoryCount || change.fromIndex >= store_.categorySize(change.fromCategory)) {
+                mismatch();
+            }
+            const std::size_t position = store_.firstArticle(change.fromCategory) + change.fromIndex;
+            if (store_.name(position) != change.before.name || store_.barcode(position) != change.before.barcode ||
+                leaving[position] || updates[position]) {
+                mismatch();
+            }
+            if (change.kind == ArticleChange::Kind::Removed || change.moved) {
+                leaving[position] = 1;
+            } else {
+                updates[position] = &change;
+            }
+        }
+        if (change.kind != ArticleChange::Kind::Removed) {
+            if (change.toCategory >= diff.categories.size()) {
+                mismatch();
+            }
+            if (change.kind == ArticleChange::Kind::Added || change.moved) {
+                arrivals[change.toCategory].push_back(&change);
+            }
+        }
+    }
+    std::vector<char> continued(categoryCount, 0);
+    std::vector<std::size_t> sizes(diff.categories.size(), 0);
+    for (std::size_t category = 0; category < diff.categories.size(); ++category) {
+        const std::size_t source = diff.categorySources[category];
+        if (source != kNoCategory) {
+            if (source >= categoryCount || continued[source]) {
+                mismatch();
+            }
+            continued[source] = 1;
+            for (std::size_t position = store_.firstArticle(source); position < store_.firstArticle(source + 1); ++position) {
+                if (leaving[position]) {
+                    continue;
+                }
+                if (updates[position] && updates[position]->toCategory != category) {
+                    mismatch();
+                }
+                ++sizes[category];
+            }
+        }
+        sizes[category] += arrivals[category].size();
+        std::size_t next = 0;
+        for (const ArticleChange* arrival : arrivals[category]) {
+            if (arrival->toIndex < next || arrival->toIndex >= sizes[category]) {
+                mismatch();
+            }
+            next = arrival->toIndex + 1;
+        }
+    }
+    for (std::size_t category = 0; category < categoryCount; ++category) {
+        if (!continued[category] &&
+            !std::all_of(leaving.begin() + static_cast<std::ptrdiff_t>(store_.firstArticle(category)),
+                         leaving.begin() + static_cast<std::ptrdiff_t>(store_.firstArticle(category + 1)),
+                         [](char leaves) { return leaves != 0; })) {
+            mismatch();
+        }
+    }
+    std::vector<std::size_t> newOffsets(diff.categories.size() + 1, 0);
+    for (std::size_t category = 0; category < diff.categories.size(); ++category) {
+        newOffsets[category + 1] = newOffsets[category] + sizes[category];
+    }
+    for (const BarcodeOwner& owner : diff.barcodes) {
+        if (owner.present && (owner.category >= diff.categories.size() || owner.index >= sizes[owner.category])) {
+            mismatch();
+        }
+    }
+
+    // Prices, names and barcodes that change in place leave every article where it is, so
+    // article numbers stay valid.
+    const bool inPlace = !diff.categoriesChanged && std::none_of(diff.changes.begin(), diff.changes.end(), [](const ArticleChange& change) {
+        return change.kind != ArticleChange::Kind::Updated || change.moved;
+    });
+    if (inPlace) {
+        for (const ArticleChange& change : diff.changes) {
+            store_.setArticle(store_.firstArticle(change.fromCategory) + change.fromIndex, change.after);
+        }
+        overrideBarcodes(diff, newOffsets);
+        if (std::any_of(diff.changes.begin(), diff.changes.end(), [](const ArticleChange& change) { return change.renamed; })) {
+            search_ = std::make_unique<CatalogueSearch>(store_);
+        }
+        if (std::any_of(diff.changes.begin(), diff.changes.end(), [](const ArticleChange& change) { return change.renamed || change.repriced; })) {
+            display_ = CatalogueDisplayStrings(store_);
+        }
+        return;
+    }
+
+    // Articles that stay keep their order; added and moved ones are slotted in at their new
+    // positions. Moved articles keep their strings and handles, and only added ones are
+    // interned.
+    std::vector<std::size_t> sources;
+    sources.reserve(newOffsets.back());
+    for (std::size_t category = 0; category < diff.categories.size(); ++category) {
+        const std::size_t source = diff.categorySources[category];
+        std::size_t survivor = source == kNoCategory ? 0 : store_.firstArticle(source);
+        auto arrival = arrivals[category].begin();
+        while (sources.size() < newOffsets[category + 1]) {
+            std::size_t article = 0;
+            if (arrival != arrivals[category].end() && (*arrival)->toIndex == sources.size() - newOffsets[category]) {
+                const ArticleChange& change = **arrival;
+                ++arrival;
+                if (change.kind == ArticleChange::Kind::Added) {
+                    sources.push_back(store_.addLooseArticle(change.after));
+                    continue;
+                }
+                article = store_.firstArticle(change.fromCategory) + change.fromIndex;
+                store_.setArticle(article, change.after);
+            } else {
+                while (leaving[survivor]) {
+                    ++survivor;
+                }
+                article = survivor++;
+                if (updates[article]) {
+                    store_.setArticle(article, updates[article]->after);
+                }
+            }
+            sources.push_back(article);
+        }
+    }
+    store_.rearrange(diff.categories, sizes, sources);
+    overrideBarcodes(diff, newOffsets);
+    search_ = std::make_unique<CatalogueSearch>(store_);
+    display_ = CatalogueDisplayStrings(store_);
+}
+
+void Catalogue::overrideBarcodes(const CatalogueDiff& diff, const std::vector<std::size_t>& offsets) {
+    for (const BarcodeOwner& owner : diff.barcodes) {
+        barcodeOverrides_[owner.barcode] = owner.present ? store_.handle(offsets[owner.category] + owner.index) : ArticleHandle{};
+    }
+}
+
+// The snapshot's indices and the overrides are turned into article numbers with the
+// handles this catalogue was loaded with, and back into handles with the inherited ones.
+void Catalogue::inheritHandles(const Catalogue& previous, const CatalogueDiff& diff) {
+    const auto articleOf = [this](ArticleHandle handle) { return store_.resolve(handle).value_or(kNoArticle); };
+    const auto handleOf = [this](std::size_t article) {
+        return article == kNoArticle ? ArticleHandle{} : store_.handle(article);
+    };
+    std::vector<std::size_t> snapshotArticles(snapshotHandles_.size());
+    std::transform(snapshotHandles_.begin(), snapshotHandles_.end(), snapshotArticles.begin(), articleOf);
+    std::vector<std::pair<const std::string*, std::size_t>> overrides;
+    overrides.reserve(barcodeOverrides_.size());
+    for (const auto& [barcode, owner] : barcodeOverrides_) {
+        overrides.emplace_back(&barcode, articleOf(owner));
+    }
+
+    store_.inheritHandles(previous.store_, articleSources(diff, previous.store_));
+
+    std::transform(snapshotArticles.begin(), snapshotArticles.end(), snapshotHandles_.begin(), handleOf);
+    for (const auto& [barcode, article] : overrides) {
+        barcodeOverrides_.find(*barcode)->second = handleOf(article);
+    }
+}
+
+std::vector<Category> Catalogue::buildDefaultCatalogue() {
+    return {
+        {"Alkoholische Getraenke",
+         {
+             {"Bier", Money::fromRappen(400), "761000000001"},
+             {"Wein", Money::fromRappen(1900), "761000000002"},
+             {"Schnaps", Money::fromRappen(500), "761000000003"},
+         }},
+        {"Softgetraenke",
+         {
+             {"3dl Getraenk", Money::fromRappen(200), "761000000101"},
+             {"1.5l Getraenk", Money::fromRappen(700), "761000000102"},
+         }},
+        {"Snacks",
+         {
+             {"Russenzopf & Kaffee", Money::fromRappen(300), "761000000201"},
+             {"Sandwich Salami", Money::fromRappen(650), "761000000202"},
+         }},
+        {"Kaffee & Tee",
+         {
+             {"Espresso", Money::fromRappen(250), "761000000301"},
+             {"Cappuccino", Money::fromRappen(350), "761000000302"},
+             {"Gruentee", Money::fromRappen(350), ""},
+             {"Schwarztee", Money::fromRappen(400), ""},
+             {"Lungo", Money::fromRappen(250), ""},
+         }},
+    };
+}
+
+std::filesystem::path Catalogue::snapshotPathFor(const std::filesystem::path& path) {
+    std::filesystem::path snapshotPath = path;
+    snapshotPath += ".bin";
+    return snapshotPath;
+}
+
+void Catalogue::rebuildArticleIndex() {
+    store_.shrinkToFit();
+    snapshotHandles_.resize(store_.articleCount());
+    for (std::size_t article = 0; article < snapshotHandles_.size(); ++article) {
+        snapshotHandles_[article] = store_.handle(article);
+    }
+    barcodeOverrides_.clear();
+    {
+        const StartupTrace::Span span("build search index");
+        search_ = std::make_unique<CatalogueSearch>(store_);
+    }
+    const StartupTrace::Span span("build display strings");
+    display_ = CatalogueDisplayStrings(store_);
+}
+
+} // namespace cashsloth
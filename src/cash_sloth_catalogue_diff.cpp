@@ -0,0 +1,451 @@
+#include "cash_sloth_catalogue_diff.h"
+
+#include <algorithm>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+using cashsloth::CatalogueStore;
+
+constexpr std::size_t kNone = std::numeric_limits<std::size_t>::max();
+
+struct Position {
+    std::size_t category;
+    std::size_t index;
+};
+
+// Category and index within it of every article, by article number.
+std::vector<Position> flatten(const CatalogueStore& store) {
+    std::vector<Position> positions;
+    positions.reserve(store.articleCount());
+    for (std::size_t category = 0; category < store.categoryCount(); ++category) {
+        for (std::size_t index = 0; index < store.categorySize(category); ++index) {
+            positions.push_back({category, index});
+        }
+    }
+    return positions;
+}
+
+// Old articles sharing a barcode or name, in catalogue order. `first` skips the leading
+// ones that are already matched.
+struct Candidates {
+    std::vector<std::size_t> positions;
+    std::size_t first = 0;
+};
+
+// Takes the first unmatched candidate, preferring one whose category continues in
+// `category` so that articles with common names stay where they are.
+std::size_t takeCandidate(Candidates& candidates, const std::vector<char>& matched, const std::vector<Position>& oldPositions,
+                          const std::vector<std::size_t>& newCategoryOf, std::size_t category) {
+    while (candidates.first < candidates.positions.size() && matched[candidates.positions[candidates.first]]) {
+        ++candidates.first;
+    }
+    std::size_t fallback = kNone;
+    for (std::size_t i = candidates.first; i < candidates.positions.size(); ++i) {
+        const std::size_t position = candidates.positions[i];
+        if (matched[position]) {
+            continue;
+        }
+        if (newCategoryOf[oldPositions[position].category] == category) {
+            return position;
+        }
+        if (fallback == kNone) {
+            fallback = position;
+        }
+    }
+    return fallback;
+}
+
+// Marks the longest strictly increasing subsequence of old positions in `values`. The
+// entries outside it are the fewest that have to move to turn the old order into the new.
+std::vector<char> longestIncreasingRun(const std::vector<std::size_t>& values) {
+    std::vector<std::size_t> tails;
+    std::vector<std::size_t> previous(values.size(), kNone);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const auto tail = std::lower_bound(tails.begin(), tails.end(), values[i], [&](std::size_t entry, std::size_t value) {
+            return values[entry] < value;
+        });
+        if (tail != tails.begin()) {
+            previous[i] = *(tail - 1);
+        }
+        if (tail == tails.end()) {
+            tails.push_back(i);
+        } else {
+            *tail = i;
+        }
+    }
+    std::vector<char> kept(values.size(), 0);
+    for (std::size_t i = tails.empty() ? kNone : tails.back(); i != kNone; i = previous[i]) {
+        kept[i] = 1;
+    }
+    return kept;
+}
+
+std::string formatPrice(cashsloth::Money price) {
+    char text[cashsloth::kMoneyTextCapacity];
+    return std::string(text, price.format(text));
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+CatalogueDiff diffCatalogues(const CatalogueStore& before, const CatalogueStore& after) {
+    CatalogueDiff diff;
+    diff.previousCategoryCount = before.categoryCount();
+
+    // The n-th category of a name continues the n-th one of the old version.
+    std::unordered_map<std::string_view, Candidates> oldCategories;
+    for (std::size_t category = 0; category < before.categoryCount(); ++category) {
+        oldCategories[before.categoryName(category)].positions.push_back(category);
+    }
+    std::vector<std::size_t> newCategoryOf(before.categoryCount(), kNoCategory);
+    diff.categories.reserve(after.categoryCount());
+    diff.categorySources.reserve(after.categoryCount());
+    for (std::size_t category = 0; category < after.categoryCount(); ++category) {
+        std::size_t source = kNoCategory;
+        if (const auto found = oldCategories.find(after.categoryName(category)); found != oldCategories.end()) {
+            Candidates& candidates = found->second;
+            if (candidates.first < candidates.positions.size()) {
+                source = candidates.positions[candidates.first++];
+                newCategoryOf[source] = category;
+            }
+        }
+        diff.categories.emplace_back(after.categoryName(category));
+        diff.categorySources.push_back(source);
+        diff.categoriesChanged = diff.categoriesChanged || source != category;
+    }
+    diff.categoriesChanged = diff.categoriesChanged || before.categoryCount() != after.categoryCount();
+
+    const std::vector<Position> oldPositions = flatten(before);
+    const std::vector<Position> newPositions = flatten(after);
+    std::vector<std::size_t> matchOf(newPositions.size(), kNone);
+    std::vector<char> matched(oldPositions.size(), 0);
+
+    // An update usually leaves most of every category where it was, so the runs of the same
+    // articles at the start and end of each continued category are paired by position; only
+    // the rest go through the hash maps below.
+    const auto sameArticle = [&](std::size_t oldArticle, std::size_t newArticle) {
+        const std::string_view barcode = before.barcode(oldArticle);
+        return barcode == after.barcode(newArticle) && (!barcode.empty() || before.name(oldArticle) == after.name(newArticle));
+    };
+    for (std::size_t category = 0; category < after.categoryCount(); ++category) {
+        const std::size_t source = diff.categorySources[category];
+        if (source == kNoCategory) {
+            continue;
+        }
+        const std::size_t oldFirst = before.firstArticle(source);
+        const std::size_t oldEnd = before.firstArticle(source + 1);
+        const std::size_t newFirst = after.firstArticle(category);
+        const std::size_t newEnd = after.firstArticle(category + 1);
+        const std::size_t common = std::min(oldEnd - oldFirst, newEnd - newFirst);
+        const auto pair = [&](std::size_t oldArticle, std::size_t newArticle) {
+            matchOf[newArticle] = oldArticle;
+            matched[oldArticle] = 1;
+        };
+        std::size_t head = 0;
+        for (; head < common && sameArticle(oldFirst + head, newFirst + head); ++head) {
+            pair(oldFirst + head, newFirst + head);
+        }
+        for (std::size_t tail = 1; tail <= common - head && sameArticle(oldEnd - tail, newEnd - tail); ++tail) {
+            pair(oldEnd - tail, newEnd - tail);
+        }
+    }
+
+    // Barcodes identify an article even when its name, price and category change.
+    std::unordered_map<std::string_view, Candidates> byBarcode;
+    for (std::size_t position = 0; position < oldPositions.size(); ++position) {
+        if (!matched[position] && !before.barcode(position).empty()) {
+            byBarcode[before.barcode(position)].positions.push_back(position);
+        }
+    }
+    for (std::size_t position = 0; position < newPositions.size(); ++position) {
+        if (matchOf[position] != kNone || after.barcode(position).empty()) {
+            continue;
+        }
+        if (const auto found = byBarcode.find(after.barcode(position)); found != byBarcode.end()) {
+            const std::size_t old = takeCandidate(found->second, matched, oldPositions, newCategoryOf, newPositions[position].category);
+            if (old != kNone) {
+                matchOf[position] = old;
+                matched[old] = 1;
+            }
+        }
+    }
+
+    // Names pair up what is left: articles without a barcode and ones whose barcode changed.
+    std::unordered_map<std::string_view, Candidates> byName;
+    for (std::size_t position = 0; position < oldPositions.size(); ++position) {
+        if (!matched[position]) {
+            byName[before.name(position)].positions.push_back(position);
+        }
+    }
+    for (std::size_t position = 0; position < newPositions.size(); ++position) {
+        if (matchOf[position] != kNone) {
+            continue;
+        }
+        if (const auto found = byName.find(after.name(position)); found != byName.end()) {
+            const std::size_t old = takeCandidate(found->second, matched, oldPositions, newCategoryOf, newPositions[position].category);
+            if (old != kNone) {
+                matchOf[position] = old;
+                matched[old] = 1;
+            }
+        }
+    }
+
+    // An article has moved when it comes from another category, or when it is not part of
+    // the longest run of its category that kept its old order.
+    std::vector<char> moved(newPositions.size(), 0);
+    std::vector<std::size_t> stayed;
+    std::vector<std::size_t> oldIndices;
+    for (std::size_t start = 0; start < newPositions.size();) {
+        const std::size_t category = newPositions[start].category;
+        std::size_t end = start;
+        stayed.clear();
+        oldIndices.clear();
+        for (; end < newPositions.size() && newPositions[end].category == category; ++end) {
+            if (matchOf[end] == kNone) {
+                continue;
+            }
+            const Position old = oldPositions[matchOf[end]];
+            if (newCategoryOf[old.category] != category) {
+                moved[end] = 1;
+            } else {
+                stayed.push_back(end);
+                oldIndices.push_back(old.index);
+            }
+        }
+        const std::vector<char> kept = longestIncreasingRun(oldIndices);
+        for (std::size_t i = 0; i < stayed.size(); ++i) {
+            moved[stayed[i]] = kept[i] ? 0 : 1;
+        }
+        start = end;
+    }
+
+    for (std::size_t position = 0; position < newPositions.size(); ++position) {
+        const Position to = newPositions[position];
+        ArticleChange change;
+        change.after = after.article(position);
+        change.toCategory = to.category;
+        change.toIndex = to.index;
+        if (matchOf[position] == kNone) {
+            change.kind = ArticleChange::Kind::Added;
+            diff.changes.push_back(std::move(change));
+            continue;
+        }
+        const std::size_t previous = matchOf[position];
+        const Position from = oldPositions[previous];
+        change.repriced = before.priceCents(previous) != after.priceCents(position);
+        change.renamed = before.name(previous) != change.after.name;
+        change.recoded = before.barcode(previous) != change.after.barcode;
+        change.moved = moved[position] != 0;
+        if (change.repriced || change.renamed || change.recoded || change.moved) {
+            change.before = before.article(previous);
+            change.fromCategory = from.category;
+            change.fromIndex = from.index;
+            diff.changes.push_back(std::move(change));
+        }
+    }
+    for (std::size_t position = 0; position < oldPositions.size(); ++position) {
+        if (matched[position]) {
+            continue;
+        }
+        ArticleChange change;
+        change.kind = ArticleChange::Kind::Removed;
+        change.before = before.article(position);
+        change.fromCategory = oldPositions[position].category;
+        change.fromIndex = oldPositions[position].index;
+        diff.changes.push_back(std::move(change));
+    }
+
+    // A barcode can resolve to another article when one carrying it is added, removed,
+    // recoded or moved past a duplicate. Of duplicates the later article wins, as in the
+    // snapshot's table. Repricing or renaming in place leaves the owner as it was.
+    std::unordered_map<std::string_view, std::size_t> owners;
+    for (const ArticleChange& change : diff.changes) {
+        const bool added = change.kind == ArticleChange::Kind::Added;
+        const bool removed = change.kind == ArticleChange::Kind::Removed;
+        if (!added && !change.recoded && !change.moved && !removed) {
+            continue;
+        }
+        if (!added && !change.before.barcode.empty()) {
+            owners.emplace(change.before.barcode, kNone);
+        }
+        if (!removed && !change.after.barcode.empty()) {
+            owners.emplace(change.after.barcode, kNone);
+        }
+    }
+    // Reordering categories changes which of two duplicates comes later without moving any
+    // article, so the barcodes of categories that left their old order count as well.
+    std::vector<std::size_t> continued;
+    std::vector<std::size_t> continuedSources;
+    for (std::size_t category = 0; category < after.categoryCount(); ++category) {
+        if (diff.categorySources[category] != kNoCategory) {
+            continued.push_back(category);
+            continuedSources.push_back(diff.categorySources[category]);
+        }
+    }
+    const std::vector<char> inOrder = longestIncreasingRun(continuedSources);
+    for (std::size_t i = 0; i < continued.size(); ++i) {
+        if (inOrder[i]) {
+            continue;
+        }
+        for (std::size_t article = after.firstArticle(continued[i]); article < after.firstArticle(continued[i] + 1); ++article) {
+            if (!after.barcode(article).empty()) {
+                owners.emplace(after.barcode(article), kNone);
+            }
+        }
+    }
+    if (!owners.empty()) {
+        for (std::size_t position = 0; position < newPositions.size(); ++position) {
+            if (after.barcode(position).empty()) {
+                continue;
+            }
+            if (const auto owner = owners.find(after.barcode(position)); owner != owners.end()) {
+                owner->second = position;
+            }
+        }
+        diff.barcodes.reserve(owners.size());
+        for (const auto& [barcode, position] : owners) {
+            BarcodeOwner owner;
+            owner.barcode.assign(barcode);
+            if (position != kNone) {
+                owner.present = true;
+                owner.category = newPositions[position].category;
+                owner.index = newPositions[position].index;
+            }
+            diff.barcodes.push_back(std::move(owner));
+        }
+    }
+    return diff;
+}
+
+// Articles of a continued category that neither left nor moved keep their order, and
+// added and moved ones are slotted in at their new index.
+std::vector<std::size_t> articleSources(const CatalogueDiff& diff, const CatalogueStore& before) {
+    std::vector<char> leaving(before.articleCount(), 0);
+    std::vector<std::vector<const ArticleChange*>> arrivals(diff.categories.size());
+    for (const ArticleChange& change : diff.changes) {
+        if (change.kind == ArticleChange::Kind::Removed || change.moved) {
+            leaving[before.firstArticle(change.fromCategory) + change.fromIndex] = 1;
+        }
+        if (change.kind == ArticleChange::Kind::Added || change.moved) {
+            arrivals[change.toCategory].push_back(&change);
+        }
+    }
+    std::vector<std::size_t> sources;
+    for (std::size_t category = 0; category < diff.categories.size(); ++category) {
+        const std::size_t source = diff.categorySources[category];
+        std::size_t survivor = source == kNoCategory ? 0 : before.firstArticle(source);
+        const std::size_t end = source == kNoCategory ? 0 : before.firstArticle(source + 1);
+        const std::size_t first = sources.size();
+        auto arrival = arrivals[category].begin();
+        for (;;) {
+            if (arrival != arrivals[category].end() && (*arrival)->toIndex == sources.size() - first) {
+                const ArticleChange& change = **arrival;
+                ++arrival;
+                sources.push_back(change.kind == ArticleChange::Kind::Added
+                                      ? kNoArticle
+                                      : before.firstArticle(change.fromCategory) + change.fromIndex);
+                continue;
+            }
+            while (survivor < end && leaving[survivor]) {
+                ++survivor;
+            }
+            if (survivor == end) {
+                break;
+            }
+            sources.push_back(survivor++);
+        }
+    }
+    return sources;
+}
+
+void writeCatalogueDiff(std::ostream& out, const CatalogueDiff& diff, const CatalogueStore& before) {
+    std::vector<char> kept(before.categoryCount(), 0);
+    bool reordered = false;
+    for (std::size_t category = 0; category < diff.categories.size(); ++category) {
+        const std::size_t source = diff.categorySources[category];
+        if (source == kNoCategory) {
+            out << "Kategorie neu: \"" << diff.categories[category] << "\"\n";
+        } else {
+            kept[source] = 1;
+            reordered = reordered || source != category;
+        }
+    }
+    for (std::size_t category = 0; category < before.categoryCount(); ++category) {
+        if (!kept[category]) {
+            out << "Kategorie entfernt: \"" << before.categoryName(category) << "\"\n";
+        }
+    }
+    if (reordered) {
+        out << "Kategorien umsortiert\n";
+    }
+
+    std::size_t added = 0;
+    std::size_t removed = 0;
+    std::size_t repriced = 0;
+    std::size_t renamed = 0;
+    std::size_t recoded = 0;
+    std::size_t moved = 0;
+    for (const ArticleChange& change : diff.changes) {
+        switch (change.kind) {
+        case ArticleChange::Kind::Added:
+            ++added;
+            out << "+ " << diff.categories[change.toCategory] << " / " << change.after.name << "  "
+                << formatPrice(change.after.price);
+            if (!change.after.barcode.empty()) {
+                out << "  [" << change.after.barcode << ']';
+            }
+            out << '\n';
+            break;
+        case ArticleChange::Kind::Removed:
+            ++removed;
+            out << "- " << before.categoryName(change.fromCategory) << " / " << change.before.name << "  "
+                << formatPrice(change.before.price);
+            if (!change.before.barcode.empty()) {
+                out << "  [" << change.before.barcode << ']';
+            }
+            out << '\n';
+            break;
+        case ArticleChange::Kind::Updated: {
+            out << "~ " << diff.categories[change.toCategory] << " / " << change.before.name << ':';
+            const char* separator = " ";
+            if (change.repriced) {
+                ++repriced;
+                out << separator << "Preis " << formatPrice(change.before.price) << " -> " << formatPrice(change.after.price);
+                separator = ", ";
+            }
+            if (change.renamed) {
+                ++renamed;
+                out << separator << "Name -> \"" << change.after.name << '"';
+                separator = ", ";
+            }
+            if (change.recoded) {
+                ++recoded;
+                out << separator << "Barcode [" << change.before.barcode << "] -> [" << change.after.barcode << ']';
+                separator = ", ";
+            }
+            if (change.moved) {
+                ++moved;
+                out << separator << "verschoben";
+                if (diff.categorySources[change.toCategory] != change.fromCategory) {
+                    out << " aus \"" << before.categoryName(change.fromCategory) << '"';
+                }
+            }
+            out << '\n';
+            break;
+        }
+        }
+    }
+
+    if (diff.empty()) {
+        out << "Keine Aenderungen\n";
+        return;
+    }
+    out << diff.changes.size() << " Artikel geaendert: " << added << " neu, " << removed << " entfernt, " << repriced
+        << " Preis, " << renamed << " Name, " << recoded << " Barcode, " << moved << " verschoben\n";
+}
+
+} // namespace cashsloth
@@ -0,0 +1,303 @@
+#include "cash_sloth_catalogue_search.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Grams are spelled in a 37-symbol alphabet: letters, digits, and one symbol for everything
+// else. Collapsing the rest keeps the gram table small enough to index directly; the
+// folded names are compared in full afterwards, so nothing matches by accident. Besides
+// the trigrams there are prefix grams of one to three characters, once for the start of
+// the name and once for the start of every word.
+constexpr std::uint32_t kSymbols = 37;
+constexpr std::uint32_t kTrigrams = kSymbols * kSymbols * kSymbols;
+constexpr std::uint32_t kPrefixGrams = kSymbols + kSymbols * kSymbols + kTrigrams;
+constexpr std::uint32_t kNameStartGrams = kTrigrams;
+constexpr std::uint32_t kWordStartGrams = kNameStartGrams + kPrefixGrams;
+constexpr std::uint32_t kGramCount = kWordStartGrams + kPrefixGrams;
+constexpr std::uint32_t kNoId = std::numeric_limits<std::uint32_t>::max();
+
+// Names that start with the query rank first, then names with a word that does, then names
+// that merely contain it.
+constexpr std::uint64_t kTierStart = 0;
+constexpr std::uint64_t kTierWord = 1;
+constexpr std::uint64_t kTierInside = 2;
+constexpr std::uint64_t kNoMatch = 3;
+
+// Folds of U+00C0 to U+00FF; null keeps the character as it is.
+constexpr const char* kLatin1Folds[64] = {
+    "a", "a", "a", "a", "ae", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+    "d", "n", "o", "o", "o", "o", "oe", nullptr, "o", "u", "u", "u", "ue", "y", "th", "ss",
+    "a", "a", "a", "a", "ae", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+    "d", "n", "o", "o", "o", "o", "oe", nullptr, "o", "u", "u", "u", "ue", "y", "th", "y",
+};
+
+std::uint32_t symbolOf(char ch) {
+    if (ch >= 'a' && ch <= 'z') {
+        return static_cast<std::uint32_t>(ch - 'a') + 1;
+    }
+    if (ch >= '0' && ch <= '9') {
+        return static_cast<std::uint32_t>(ch - '0') + 27;
+    }
+    return 0;
+}
+
+bool isWordChar(char ch) {
+    return symbolOf(ch) != 0 || static_cast<unsigned char>(ch) >= 0x80;
+}
+
+bool isWordStart(std::string_view text, std::size_t position) {
+    return isWordChar(text[position]) && (position == 0 || !isWordChar(text[position - 1]));
+}
+
+std::uint32_t trigramAt(std::string_view text, std::size_t position) {
+    return (symbolOf(text[position]) * kSymbols + symbolOf(text[position + 1])) * kSymbols + symbolOf(text[position + 2]);
+}
+
+// The first one to three characters at `position`, as an offset into a block of prefix grams.
+std::uint32_t prefixGram(std::string_view text, std::size_t position) {
+    const std::size_t length = std::min<std::size_t>(3, text.size() - position);
+    std::uint32_t code = 0;
+    std::uint32_t base = 0;
+    std::uint32_t span = 1;
+    for (std::size_t i = 0; i < length; ++i) {
+        base += span;
+        span *= kSymbols;
+        code = code * kSymbols + symbolOf(text[position + i]);
+    }
+    return base - 1 + code;
+}
+
+// Every trigram of `name`, and the prefixes of one to three characters of the name and of
+// each later word. The first word only needs its name-start grams: a name that starts with
+// the query ranks by that, never by a later word.
+template <typename Visit>
+void forEachGram(std::string_view name, Visit&& visit) {
+    for (std::size_t position = 0; position < name.size(); ++position) {
+        if (position + 2 < name.size()) {
+            visit(trigramAt(name, position));
+        }
+        if (position == 0 || isWordStart(name, position)) {
+            const std::uint32_t block = position == 0 ? kNameStartGrams : kWordStartGrams;
+            for (std::size_t end = position + 1; end <= std::min(name.size(), position + 3); ++end) {
+                visit(block + prefixGram(name.substr(0, end), position));
+            }
+        }
+    }
+}
+
+// kTierStart, kTierWord or kTierInside, or kNoMatch when `text` does not contain `query`.
+std::uint64_t matchTier(std::string_view text, std::string_view query) {
+    std::size_t at = text.find(query);
+    if (at == std::string_view::npos) {
+        return kNoMatch;
+    }
+    if (at == 0) {
+        return kTierStart;
+    }
+    for (; at != std::string_view::npos; at = text.find(query, at + 1)) {
+        if (isWordStart(text, at)) {
+            return kTierWord;
+        }
+    }
+    return kTierInside;
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+std::string foldSearchText(std::string_view text) {
+    std::string folded;
+    folded.reserve(text.size());
+    for (std::size_t i = 0; i < text.size();) {
+        const auto ch = static_cast<unsigned char>(text[i]);
+        const bool pair = i + 1 < text.size() && (static_cast<unsigned char>(text[i + 1]) & 0xC0) == 0x80;
+        if (ch < 0x80) {
+            folded.push_back(ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : static_cast<char>(ch));
+            ++i;
+        } else if (ch == 0xC3 && pair && kLatin1Folds[static_cast<unsigned char>(text[i + 1]) & 0x3F]) {
+            folded += kLatin1Folds[static_cast<unsigned char>(text[i + 1]) & 0x3F];
+            i += 2;
+        } else if ((ch == 0xCC || ch == 0xCD) && pair) {
+            // Combining marks (U+0300 to U+036F) are dropped, except that a diaeresis on
+            // a, o or u spells the umlaut out like the precomposed letter.
+            const unsigned mark = ((ch & 0x1Fu) << 6) | (static_cast<unsigned char>(text[i + 1]) & 0x3Fu);
+            if (mark == 0x308 && !folded.empty() && (folded.back() == 'a' || folded.back() == 'o' || folded.back() == 'u')) {
+                folded.push_back('e');
+            }
+            i += 2;
+        } else {
+            folded.push_back(static_cast<char>(ch));
+            ++i;
+        }
+    }
+    return folded;
+}
+
+CatalogueSearch::CatalogueSearch(const CatalogueStore& store) {
+    if (store.articleCount() >= kNoId) {
+        throw std::runtime_error("Catalogue too large for search index");
+    }
+    const auto articleCount = static_cast<std::uint32_t>(store.articleCount());
+    std::string folded;
+    std::vector<std::uint32_t> foldedOffsets{0};
+    foldedOffsets.reserve(articleCount + 1);
+    for (std::uint32_t article = 0; article < articleCount; ++article) {
+        folded += foldSearchText(store.name(article));
+        if (folded.size() >= kNoId) {
+            throw std::runtime_error("Catalogue too large for search index");
+        }
+        foldedOffsets.push_back(static_cast<std::uint32_t>(folded.size()));
+    }
+    categoryNames_.reserve(store.categoryCount());
+    categoryOffsets_.reserve(store.categoryCount() + 1);
+    for (std::size_t category = 0; category < store.categoryCount(); ++category) {
+        categoryNames_.push_back(foldSearchText(store.categoryName(category)));
+        categoryOffsets_.push_back(static_cast<std::uint32_t>(store.firstArticle(category)));
+    }
+    categoryOffsets_.push_back(articleCount);
+
+    // Ids go to the articles by name length and then catalogue order, which is how matches
+    // of the same tier rank. A counting sort keeps equal lengths in catalogue order.
+    std::vector<std::uint32_t> byLength;
+    for (std::uint32_t article = 0; article < articleCount; ++article) {
+        const std::uint32_t length = foldedOffsets[article + 1] - foldedOffsets[article];
+        if (length + 1 >= byLength.size()) {
+            byLength.resize(length + 2, 0);
+        }
+        ++byLength[length + 1];
+    }
+    for (std::size_t length = 1; length < byLength.size(); ++length) {
+        byLength[length] += byLength[length - 1];
+    }
+    positions_.resize(articleCount);
+    for (std::uint32_t article = 0; article < articleCount; ++article) {
+        positions_[byLength[foldedOffsets[article + 1] - foldedOffsets[article]]++] = article;
+    }
+    names_.reserve(folded.size());
+    nameOffsets_.reserve(articleCount + 1);
+    nameOffsets_.push_back(0);
+    for (const std::uint32_t article : positions_) {
+        names_.append(folded, foldedOffsets[article], foldedOffsets[article + 1] - foldedOffsets[article]);
+        nameOffsets_.push_back(static_cast<std::uint32_t>(names_.size()));
+    }
+
+    // The first pass counts the postings of every gram, the second writes them. Ids are
+    // visited in order, so every list comes out sorted; `lastSeen` drops a gram that occurs
+    // twice in the same name.
+    std::vector<std::uint32_t> lastSeen(kGramCount, kNoId);
+    gramOffsets_.assign(kGramCount + 1, 0);
+    for (std::uint32_t id = 0; id < articleCount; ++id) {
+        forEachGram(name(id), [&](std::uint32_t gram) {
+            if (lastSeen[gram] != id) {
+                lastSeen[gram] = id;
+                ++gramOffsets_[gram + 1];
+            }
+        });
+    }
+    for (std::uint32_t gram = 0; gram < kGramCount; ++gram) {
+        gramOffsets_[gram + 1] += gramOffsets_[gram];
+    }
+    postings_.resize(gramOffsets_.back());
+    std::vector<std::uint32_t> next(gramOffsets_.begin(), gramOffsets_.end() - 1);
+    std::fill(lastSeen.begin(), lastSeen.end(), kNoId);
+    for (std::uint32_t id = 0; id < articleCount; ++id) {
+        forEachGram(name(id), [&](std::uint32_t gram) {
+            if (lastSeen[gram] != id) {
+                lastSeen[gram] = id;
+                postings_[next[gram]++] = id;
+            }
+        });
+    }
+}
+
+std::vector<std::size_t> CatalogueSearch::find(std::string_view query, std::size_t limit) const {
+    std::string folded = foldSearchText(query);
+    const std::size_t first = folded.find_first_not_of(' ');
+    if (first == std::string::npos || limit == 0) {
+        return {};
+    }
+    folded = folded.substr(first, folded.find_last_not_of(' ') - first + 1);
+    const std::string_view needle = folded;
+
+    // Each tier is read from the list that holds all its candidates. The lists are in rank
+    // order, so a tier is done once it has filled the result.
+    std::vector<std::size_t> result;
+    const auto collect = [&](std::span<const std::uint32_t> candidates, std::span<const std::span<const std::uint32_t>> filters,
+                             std::uint64_t tier) {
+        for (const std::uint32_t id : candidates) {
+            if (result.size() == limit) {
+                return;
+            }
+            const bool inAll = std::all_of(filters.begin(), filters.end(), [&](const auto& list) {
+                return std::binary_search(list.begin(), list.end(), id);
+            });
+            if (inAll && matchTier(name(id), needle) == tier) {
+                result.push_back(positions_[id]);
+            }
+        }
+    };
+    collect(postings(kNameStartGrams + prefixGram(needle, 0)), {}, kTierStart);
+    if (isWordChar(needle.front())) {
+        collect(postings(kWordStartGrams + prefixGram(needle, 0)), {}, kTierWord);
+    }
+    if (needle.size() >= 3 && result.size() < limit) {
+        // Walk the shortest trigram list and keep the articles every other one contains too.
+        std::vector<std::span<const std::uint32_t>> lists;
+        for (std::size_t position = 0; position + 2 < needle.size(); ++position) {
+            lists.push_back(postings(trigramAt(needle, position)));
+        }
+        std::sort(lists.begin(), lists.end(), [](const auto& left, const auto& right) {
+            return std::pair(left.size(), left.data()) < std::pair(right.size(), right.data());
+        });
+        lists.erase(std::unique(lists.begin(), lists.end(), [](const auto& left, const auto& right) {
+                        return left.data() == right.data();
+                    }),
+                    lists.end());
+        collect(lists.front(), std::span(lists).subspan(1), kTierInside);
+    }
+    if (result.size() == limit) {
+        return result;
+    }
+
+    // Fill up with the articles of matching categories, best matching category first.
+    std::vector<std::uint64_t> categories;
+    for (std::size_t category = 0; category < categoryNames_.size(); ++category) {
+        const std::uint64_t tier = matchTier(categoryNames_[category], needle);
+        if (tier != kNoMatch && (needle.size() >= 3 || tier != kTierInside)) {
+            categories.push_back((tier << 32) | category);
+        }
+    }
+    std::sort(categories.begin(), categories.end());
+    std::vector<std::size_t> named = result;
+    std::sort(named.begin(), named.end());
+    for (const std::uint64_t entry : categories) {
+        const std::size_t category = static_cast<std::size_t>(entry & 0xFFFFFFFFu);
+        for (std::size_t article = categoryOffsets_[category]; article < categoryOffsets_[category + 1]; ++article) {
+            if (result.size() == limit) {
+                return result;
+            }
+            if (!std::binary_search(named.begin(), named.end(), article)) {
+                result.push_back(article);
+            }
+        }
+    }
+    return result;
+}
+
+std::span<const std::uint32_t> CatalogueSearch::postings(std::uint32_t gram) const {
+    if (gramOffsets_.empty()) {
+        return {};
+    }
+    return std::span<const std::uint32_t>(postings_.data() + gramOffsets_[gram], gramOffsets_[gram + 1] - gramOffsets_[gram]);
+}
+
+std::string_view CatalogueSearch::name(std::uint32_t id) const {
+    return std::string_view(names_).substr(nameOffsets_[id], nameOffsets_[id + 1] - nameOffsets_[id]);
+}
+
+} // namespace cashsloth
@@ -0,0 +1,435 @@
+#include "cash_sloth_catalogue_snapshot.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace {
+
+using cashsloth::CatalogueSnapshot;
+
+constexpr char kMagic[8] = {'C', 'S', 'C', 'A', 'T', 'B', 'I', 'N'};
+constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ull;
+
+std::uint64_t loadWord(const char* data) {
+    std::uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+std::uint64_t hashRound(std::uint64_t lane, std::uint64_t word) {
+    return std::rotl(lane + word * kPrime2, 31) * kPrime1;
+}
+
+std::uint64_t avalanche(std::uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::size_t alignUp(std::size_t value) {
+    return (value + 7) & ~static_cast<std::size_t>(7);
+}
+
+std::uint32_t checkedU32(std::size_t value) {
+    if (value > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Catalogue too large for snapshot");
+    }
+    return static_cast<std::uint32_t>(value);
+}
+
+// PLUs of one to five digits share one array; codes of each length start where the shorter
+// ones end, so "42" and "042" get different slots.
+constexpr std::size_t kMaxPluDigits = 5;
+constexpr std::uint64_t kPluOffsets[kMaxPluDigits + 1] = {0, 0, 10, 110, 1110, 11110};
+constexpr std::uint64_t kPluSlots = 111110;
+constexpr std::size_t kMaxGtinDigits = 14;
+
+bool isGtinLength(std::size_t digits) {
+    return digits == 8 || digits == 12 || digits == 13 || digits == 14;
+}
+
+// GS1 check digit: the other digits weigh 3 and 1 alternately, starting with 3 next to it.
+bool hasValidCheckDigit(std::string_view digits) {
+    unsigned sum = 0;
+    for (std::size_t i = 0; i + 1 < digits.size(); ++i) {
+        const unsigned digit = static_cast<unsigned>(digits[digits.size() - 2 - i] - '0');
+        sum += i % 2 == 0 ? digit * 3 : digit;
+    }
+    return (10 - sum % 10) % 10 == static_cast<unsigned>(digits.back() - '0');
+}
+
+// Spreads a GTIN key over `slots` with a multiply-shift instead of a modulo, so the table
+// does not have to be a power of two.
+std::size_t gtinSlot(std::uint64_t key, std::uint32_t slots) {
+    const std::uint64_t mixed = (key ^ (key >> 29)) * kPrime1;
+    return static_cast<std::size_t>(((mixed >> 32) * slots) >> 32);
+}
+
+bool sectionFits(std::uint64_t offset, std::uint64_t count, std::size_t recordSize, std::size_t total) {
+    if (offset % 8 != 0 || offset > total) {
+        return false;
+    }
+    return count <= (total - offset) / recordSize;
+}
+
+template <typename T>
+std::span<const T> column(std::string_view bytes, std::uint64_t offset, std::size_t count) {
+    return std::span<const T>(reinterpret_cast<const T*>(bytes.data() + offset), count);
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+// Four independent multiply-rotate lanes over 32-byte blocks keep the multipliers busy on
+// long input; a barcode takes the word-at-a-time tail.
+std::uint64_t hashBytes(std::string_view bytes) {
+    const char* data = bytes.data();
+    std::size_t size = bytes.size();
+    std::uint64_t hash;
+    if (size >= 32) {
+        std::uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+        while (size >= 32) {
+            for (int lane = 0; lane < 4; ++lane) {
+                lanes[lane] = hashRound(lanes[lane], loadWord(data + lane * 8));
+            }
+            data += 32;
+            size -= 32;
+        }
+        hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        for (std::uint64_t lane : lanes) {
+            hash = (hash ^ hashRound(0, lane)) * kPrime1 + kPrime3;
+        }
+    } else {
+        hash = kPrime3;
+    }
+    hash += bytes.size();
+    while (size >= 8) {
+        hash = std::rotl(hash ^ hashRound(0, loadWord(data)), 27) * kPrime1 + kPrime3;
+        data += 8;
+        size -= 8;
+    }
+    while (size > 0) {
+        hash = std::rotl(hash ^ (static_cast<unsigned char>(*data) * kPrime3), 11) * kPrime1;
+        ++data;
+        --size;
+    }
+    return avalanche(hash);
+}
+
+BarcodeKey BarcodeKey::of(std::string_view barcode) {
+    BarcodeKey key;
+    if (barcode.empty() || barcode.size() > kMaxGtinDigits) {
+        return key;
+    }
+    std::uint64_t value = 0;
+    for (const char ch : barcode) {
+        if (ch < '0' || ch > '9') {
+            return key;
+        }
+        value = value * 10 + static_cast<std::uint64_t>(ch - '0');
+    }
+    if (barcode.size() <= kMaxPluDigits) {
+        key.kind = Kind::Plu;
+        key.value = kPluOffsets[barcode.size()] + value;
+    } else if (isGtinLength(barcode.size()) && hasValidCheckDigit(barcode)) {
+        // Fourteen digits take 47 bits, which leaves the top byte for the length.
+        key.kind = Kind::Gtin;
+        key.value = (static_cast<std::uint64_t>(barcode.size()) << 56) | value;
+    }
+    return key;
+}
+
+// The store's columns are written as they are, so the snapshot's pool, ids and ranges are
+// the store's own and store() can hand them back without translating anything.
+CatalogueSnapshot CatalogueSnapshot::build(const CatalogueStore& store, std::uint64_t sourceHash,
+                                           std::uint64_t sourceSize) {
+    const CatalogueColumns columns = store.columns();
+    checkedU32(columns.pool.size());
+    checkedU32(columns.stringStarts.size());
+    std::vector<BarcodeKey> keys(store.articleCount());
+    std::size_t textCount = 0;
+    std::size_t gtinCount = 0;
+    std::size_t pluSlots = 0;
+    checkedU32(store.articleCount() + 1);
+
+    for (std::size_t index = 0; index < keys.size(); ++index) {
+        const std::string_view barcode = store.barcode(index);
+        keys[index] = BarcodeKey::of(barcode);
+        if (keys[index].kind == BarcodeKey::Kind::Gtin) {
+            ++gtinCount;
+        } else if (keys[index].kind == BarcodeKey::Kind::Plu) {
+            pluSlots = std::max(pluSlots, static_cast<std::size_t>(keys[index].value) + 1);
+        } else if (!barcode.empty()) {
+            ++textCount;
+        }
+    }
+
+    // At most half full, so probe sequences stay short.
+    const std::size_t tableSlots = textCount == 0 ? 0 : std::bit_ceil(textCount * 2);
+    std::vector<std::uint32_t> table(tableSlots, 0);
+    // Integer keys are cheap to compare, so the GTIN table may be three quarters full.
+    const std::uint32_t gtinSlots = gtinCount == 0 ? 0 : checkedU32(gtinCount + gtinCount / 3 + 1);
+    std::vector<std::uint64_t> gtinKeys(gtinSlots, 0);
+    std::vector<std::uint32_t> gtinArticles(gtinSlots, 0);
+    std::vector<std::uint32_t> plu(pluSlots, 0);
+    for (std::size_t index = 0; index < keys.size(); ++index) {
+        const std::string_view barcode = store.barcode(index);
+        if (barcode.empty()) {
+            continue;
+        }
+        const auto entry = static_cast<std::uint32_t>(index + 1);
+        if (keys[index].kind == BarcodeKey::Kind::Plu) {
+            plu[keys[index].value] = entry;
+            continue;
+        }
+        if (keys[index].kind == BarcodeKey::Kind::Gtin) {
+            std::size_t slot = gtinSlot(keys[index].value, gtinSlots);
+            while (gtinKeys[slot] != 0 && gtinKeys[slot] != keys[index].value) {
+                slot = slot + 1 == gtinSlots ? 0 : slot + 1;
+            }
+            gtinKeys[slot] = keys[index].value;
+            gtinArticles[slot] = entry;
+            continue;
+        }
+        std::size_t slot = hashBytes(barcode) & (tableSlots - 1);
+        while (table[slot] != 0 && store.barcode(table[slot] - 1) != barcode) {
+            slot = (slot + 1) & (tableSlots - 1);
+        }
+        table[slot] = entry;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrderMark;
+    header.sourceHash = sourceHash;
+    header.sourceSize = sourceSize;
+    header.categoryCount = checkedU32(store.categoryCount());
+    header.articleCount = checkedU32(store.articleCount());
+    header.stringCount = checkedU32(store.stringCount());
+    header.tableSlots = checkedU32(tableSlots);
+    header.gtinSlots = gtinSlots;
+    header.pluSlots = checkedU32(pluSlots);
+    header.stringStartsOffset = alignUp(sizeof(Header));
+    header.pricesOffset = alignUp(header.stringStartsOffset + columns.stringStarts.size_bytes());
+    header.namesOffset = alignUp(header.pricesOffset + columns.prices.size_bytes());
+    header.barcodesOffset = alignUp(header.namesOffset + columns.names.size_bytes());
+    header.categoryNamesOffset = alignUp(header.barcodesOffset + columns.barcodes.size_bytes());
+    header.categoryStartsOffset = alignUp(header.categoryNamesOffset + columns.categoryNames.size_bytes());
+    header.tableOffset = alignUp(header.categoryStartsOffset + columns.categoryStarts.size_bytes());
+    header.gtinKeysOffset = alignUp(header.tableOffset + table.size() * sizeof(std::uint32_t));
+    header.gtinArticlesOffset = alignUp(header.gtinKeysOffset + gtinKeys.size() * sizeof(std::uint64_t));
+    header.pluOffset = alignUp(header.gtinArticlesOffset + gtinArticles.size() * sizeof(std::uint32_t));
+    header.stringsOffset = alignUp(header.pluOffset + plu.size() * sizeof(std::uint32_t));
+    header.stringsSize = columns.pool.size();
+    const std::size_t totalSize = header.stringsOffset + columns.pool.size();
+
+    CatalogueSnapshot snapshot;
+    snapshot.image_.assign((totalSize + 7) / 8, 0);
+    char* image = reinterpret_cast<char*>(snapshot.image_.data());
+    const auto place = [image](std::uint64_t offset, const void* data, std::size_t bytes) {
+        if (bytes != 0) {
+            std::memcpy(image + offset, data, bytes);
+        }
+    };
+    place(0, &header, sizeof(header));
+    place(header.stringStartsOffset, columns.stringStarts.data(), columns.stringStarts.size_bytes());
+    place(header.pricesOffset, columns.prices.data(), columns.prices.size_bytes());
+    place(header.namesOffset, columns.names.data(), columns.names.size_bytes());
+    place(header.barcodesOffset, columns.barcodes.data(), columns.barcodes.size_bytes());
+    place(header.categoryNamesOffset, columns.categoryNames.data(), columns.categoryNames.size_bytes());
+    place(header.categoryStartsOffset, columns.categoryStarts.data(), columns.categoryStarts.size_bytes());
+    place(header.tableOffset, table.data(), table.size() * sizeof(std::uint32_t));
+    place(header.gtinKeysOffset, gtinKeys.data(), gtinKeys.size() * sizeof(std::uint64_t));
+    place(header.gtinArticlesOffset, gtinArticles.data(), gtinArticles.size() * sizeof(std::uint32_t));
+    place(header.pluOffset, plu.data(), plu.size() * sizeof(std::uint32_t));
+    place(header.stringsOffset, columns.pool.data(), columns.pool.size());
+    snapshot.attach(std::string_view(image, totalSize));
+    return snapshot;
+}
+
+std::optional<CatalogueSnapshot> CatalogueSnapshot::open(const std::filesystem::path& path) {
+    CatalogueSnapshot snapshot;
+    snapshot.file_ = MappedFile(path);
+    if (!snapshot.file_.isOpen() || !snapshot.attach(snapshot.file_.view())) {
+        return std::nullopt;
+    }
+    return snapshot;
+}
+
+bool CatalogueSnapshot::writeTo(const std::filesystem::path& path) const {
+    if (empty()) {
+        return false;
+    }
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+        if (!output.is_open()) {
+            return false;
+        }
+        output.write(bytes_.data(), static_cast<std::streamsize>(bytes_.size()));
+        if (!output) {
+            output.close();
+            std::error_code ignored;
+            std::filesystem::remove(temporary, ignored);
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        // Some runtimes refuse to rename over an existing file.
+        std::filesystem::remove(path, error);
+        std::filesystem::rename(temporary, path, error);
+    }
+    if (error) {
+        std::error_code ignored;
+        std::filesystem::remove(temporary, ignored);
+        return false;
+    }
+    return true;
+}
+
+bool CatalogueSnapshot::matches(std::uint64_t sourceHash, std::uint64_t sourceSize) const {
+    return header_ && header_->sourceHash == sourceHash && header_->sourceSize == sourceSize;
+}
+
+std::string_view CatalogueSnapshot::string(std::uint32_t id) const {
+    if (id >= header_->stringCount) {
+        return {};
+    }
+    const std::uint32_t start = columns_.stringStarts[id];
+    const std::uint32_t end = columns_.stringStarts[id + 1];
+    if (start > end || end > columns_.pool.size()) {
+        return {};
+    }
+    return columns_.pool.substr(start, end - start);
+}
+
+std::optional<std::size_t> CatalogueSnapshot::findBarcode(std::string_view barcode) const {
+    if (!header_ || barcode.empty()) {
+        return std::nullopt;
+    }
+    const auto resolve = [this](std::uint32_t entry) -> std::optional<std::size_t> {
+        if (entry == 0 || entry > header_->articleCount) {
+            return std::nullopt;
+        }
+        return entry - 1;
+    };
+    const BarcodeKey key = BarcodeKey::of(barcode);
+    if (key.kind == BarcodeKey::Kind::Plu) {
+        return key.value < header_->pluSlots ? resolve(plu_[key.value]) : std::nullopt;
+    }
+    if (key.kind == BarcodeKey::Kind::Gtin) {
+        const std::uint32_t slots = header_->gtinSlots;
+        std::size_t slot = slots == 0 ? 0 : gtinSlot(key.value, slots);
+        for (std::size_t probes = 0; probes < slots; ++probes) {
+            if (gtinKeys_[slot] == key.value) {
+                return resolve(gtinArticles_[slot]);
+            }
+            if (gtinKeys_[slot] == 0) {
+                break;
+            }
+            slot = slot + 1 == slots ? 0 : slot + 1;
+        }
+        return std::nullopt;
+    }
+    if (header_->tableSlots == 0) {
+        return std::nullopt;
+    }
+    const std::size_t mask = header_->tableSlots - 1;
+    std::size_t slot = hashBytes(barcode) & mask;
+    for (std::size_t probes = 0; probes < header_->tableSlots; ++probes) {
+        const std::uint32_t entry = table_[slot];
+        if (entry == 0 || entry > header_->articleCount) {
+            return std::nullopt;
+        }
+        if (string(columns_.barcodes[entry - 1]) == barcode) {
+            return entry - 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return std::nullopt;
+}
+
+// Every id has to name a string, the strings have to lie in the pool in order, and the
+// categories have to tile the articles in order, as the store numbers them.
+CatalogueStore CatalogueSnapshot::store() const {
+    if (!header_) {
+        return CatalogueStore();
+    }
+    const auto ascending = [](std::span<const std::uint32_t> starts, std::uint64_t last) {
+        return starts.front() == 0 && starts.back() == last && std::is_sorted(starts.begin(), starts.end());
+    };
+    const auto named = [this](std::span<const std::uint32_t> ids) {
+        return std::all_of(ids.begin(), ids.end(), [this](std::uint32_t id) { return id < header_->stringCount; });
+    };
+    if (columns_.stringStarts[1] != 0 || !ascending(columns_.stringStarts, columns_.pool.size()) ||
+        !named(columns_.names) || !named(columns_.barcodes) || !named(columns_.categoryNames)) {
+        throw std::runtime_error("Catalogue snapshot string out of range");
+    }
+    if (!ascending(columns_.categoryStarts, header_->articleCount)) {
+        throw std::runtime_error("Catalogue snapshot article range out of bounds");
+    }
+    return CatalogueStore(columns_);
+}
+
+bool CatalogueSnapshot::attach(std::string_view bytes) {
+    if (bytes.size() < sizeof(Header) || reinterpret_cast<std::uintptr_t>(bytes.data()) % 8 != 0) {
+        return false;
+    }
+    const auto* header = reinterpret_cast<const Header*>(bytes.data());
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion ||
+        header->byteOrder != kByteOrderMark) {
+        return false;
+    }
+    const std::size_t total = bytes.size();
+    const bool tableSizeValid = header->tableSlots == 0 || std::has_single_bit(header->tableSlots);
+    if (!tableSizeValid || header->stringCount == 0 ||
+        !sectionFits(header->stringStartsOffset, std::uint64_t{header->stringCount} + 1, sizeof(std::uint32_t), total) ||
+        !sectionFits(header->pricesOffset, header->articleCount, sizeof(std::int64_t), total) ||
+        !sectionFits(header->namesOffset, header->articleCount, sizeof(std::uint32_t), total) ||
+        !sectionFits(header->barcodesOffset, header->articleCount, sizeof(std::uint32_t), total) ||
+        !sectionFits(header->categoryNamesOffset, header->categoryCount, sizeof(std::uint32_t), total) ||
+        !sectionFits(header->categoryStartsOffset, std::uint64_t{header->categoryCount} + 1, sizeof(std::uint32_t), total) ||
+        !sectionFits(header->tableOffset, header->tableSlots, sizeof(std::uint32_t), total) ||
+        !sectionFits(header->gtinKeysOffset, header->gtinSlots, sizeof(std::uint64_t), total) ||
+        !sectionFits(header->gtinArticlesOffset, header->gtinSlots, sizeof(std::uint32_t), total) ||
+        header->pluSlots > kPluSlots || !sectionFits(header->pluOffset, header->pluSlots, sizeof(std::uint32_t), total) ||
+        header->stringsOffset > total || header->stringsSize > total - header->stringsOffset) {
+        return false;
+    }
+    bytes_ = bytes;
+    header_ = header;
+    columns_.pool = bytes.substr(header->stringsOffset, header->stringsSize);
+    columns_.stringStarts = column<std::uint32_t>(bytes, header->stringStartsOffset, std::size_t{header->stringCount} + 1);
+    columns_.prices = column<std::int64_t>(bytes, header->pricesOffset, header->articleCount);
+    columns_.names = column<std::uint32_t>(bytes, header->namesOffset, header->articleCount);
+    columns_.barcodes = column<std::uint32_t>(bytes, header->barcodesOffset, header->articleCount);
+    columns_.categoryNames = column<std::uint32_t>(bytes, header->categoryNamesOffset, header->categoryCount);
+    columns_.categoryStarts = column<std::uint32_t>(bytes, header->categoryStartsOffset, std::size_t{header->categoryCount} + 1);
+    table_ = reinterpret_cast<const std::uint32_t*>(bytes.data() + header->tableOffset);
+    gtinKeys_ = reinterpret_cast<const std::uint64_t*>(bytes.data() + header->gtinKeysOffset);
+    gtinArticles_ = reinterpret_cast<const std::uint32_t*>(bytes.data() + header->gtinArticlesOffset);
+    plu_ = reinterpret_cast<const std::uint32_t*>(bytes.data() + header->pluOffset);
+    return true;
+}
+
+} // namespace cashsloth
@@ -0,0 +1,287 @@
+#include "cash_sloth_catalogue_store.h"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+constexpr std::uint32_t kFreeSlot = std::numeric_limits<std::uint32_t>::max();
+
+std::uint32_t checkedU32(std::size_t value) {
+    if (value >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Catalogue too large");
+    }
+    return static_cast<std::uint32_t>(value);
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+CatalogueStore::CatalogueStore() : stringStarts_{0, 0}, categoryStarts_{0} {}
+
+CatalogueStore::CatalogueStore(const std::vector<Category>& categories) : CatalogueStore() {
+    std::size_t articles = 0;
+    for (const Category& category : categories) {
+        articles += category.articles.size();
+    }
+    reserve(categories.size(), articles, 0);
+    for (const Category& category : categories) {
+        addCategory(category.name);
+        for (const Article& article : category.articles) {
+            addArticle(article.name, article.price.rappen(), article.barcode);
+        }
+    }
+}
+
+CatalogueStore::CatalogueStore(const CatalogueColumns& columns)
+    : pool_(std::span<const char>(columns.pool.data(), columns.pool.size())),
+      stringStarts_(columns.stringStarts),
+      prices_(columns.prices),
+      names_(columns.names),
+      barcodes_(columns.barcodes),
+      categoryNames_(columns.categoryNames),
+      categoryStarts_(columns.categoryStarts) {
+    checkedU32(prices_.size());
+    articleSlots_.resize(prices_.size());
+    slots_.resize(prices_.size());
+    for (std::size_t article = 0; article < prices_.size(); ++article) {
+        articleSlots_[article] = static_cast<std::uint32_t>(article);
+        slots_[article].article = static_cast<std::uint32_t>(article);
+    }
+}
+
+CatalogueColumns CatalogueStore::columns() const {
+    return CatalogueColumns{pool(), stringStarts_.view(), prices_.view(), names_.view(),
+                            barcodes_.view(), categoryNames_.view(), categoryStarts_.view()};
+}
+
+void CatalogueStore::reserve(std::size_t categories, std::size_t articles, std::size_t poolBytes) {
+    prices_.reserve(articles);
+    names_.reserve(articles);
+    barcodes_.reserve(articles);
+    categoryNames_.reserve(categories);
+    categoryStarts_.reserve(categories + 1);
+    articleSlots_.reserve(articles);
+    slots_.reserve(articles);
+    pool_.reserve(poolBytes);
+    // Every article brings at most two new strings, its name and its barcode.
+    stringStarts_.reserve(stringStarts_.size() + categories + 2 * articles);
+}
+
+Article CatalogueStore::article(std::size_t article) const {
+    return Article{std::string(name(article)), price(article), std::string(barcode(article))};
+}
+
+void CatalogueStore::addCategory(std::string_view name) {
+    addCategory(intern(name));
+}
+
+void CatalogueStore::addArticle(std::string_view name, std::int64_t priceCents, std::string_view barcode) {
+    const std::uint32_t nameId = intern(name);
+    addArticle(nameId, priceCents, intern(barcode));
+}
+
+std::uint32_t CatalogueStore::appendString(std::string_view text) {
+    if (text.empty()) {
+        return 0;
+    }
+    // The table no longer covers every string; intern() rebuilds it when it is next needed.
+    internTable_ = {};
+    return pushString(text);
+}
+
+void CatalogueStore::addCategory(std::uint32_t nameId) {
+    categoryNames_.pushBack(nameId);
+    categoryStarts_.pushBack(categoryStarts_.back());
+}
+
+void CatalogueStore::addArticle(std::uint32_t nameId, std::int64_t priceCents, std::uint32_t barcodeId) {
+    if (categoryNames_.empty() || categoryStarts_.back() != prices_.size()) {
+        throw std::logic_error("CatalogueStore::addArticle needs a category to add to");
+    }
+    checkedU32(prices_.size() + 1);
+    articleSlots_.push_back(takeSlot(prices_.size()));
+    prices_.pushBack(priceCents);
+    names_.pushBack(nameId);
+    barcodes_.pushBack(barcodeId);
+    categoryStarts_.set(categoryStarts_.size() - 1, static_cast<std::uint32_t>(prices_.size()));
+}
+
+// Only strings that change are interned, so a new price does not rebuild the intern table.
+void CatalogueStore::setArticle(std::size_t article, const Article& value) {
+    prices_.set(article, value.price.rappen());
+    if (name(article) != value.name) {
+        names_.set(article, intern(value.name));
+    }
+    if (barcode(article) != value.barcode) {
+        barcodes_.set(article, intern(value.barcode));
+    }
+}
+
+std::size_t CatalogueStore::addLooseArticle(const Article& value) {
+    checkedU32(prices_.size() + 1);
+    articleSlots_.push_back(takeSlot(prices_.size()));
+    prices_.pushBack(value.price.rappen());
+    names_.pushBack(intern(value.name));
+    barcodes_.pushBack(intern(value.barcode));
+    return prices_.size() - 1;
+}
+
+void CatalogueStore::rearrange(const std::vector<std::string>& names, const std::vector<std::size_t>& sizes,
+                               const std::vector<std::size_t>& sources) {
+    std::vector<std::int64_t> prices(sources.size());
+    std::vector<std::uint32_t> articleNames(sources.size());
+    std::vector<std::uint32_t> barcodes(sources.size());
+    std::vector<std::uint32_t> articleSlots(sources.size());
+    std::vector<char> kept(prices_.size(), 0);
+    for (std::size_t position = 0; position < sources.size(); ++position) {
+        prices[position] = prices_[sources[position]];
+        articleNames[position] = names_[sources[position]];
+        barcodes[position] = barcodes_[sources[position]];
+        articleSlots[position] = articleSlots_[sources[position]];
+        kept[sources[position]] = 1;
+    }
+    // Category names that are already in use keep their id without going through intern().
+    // The others are interned only once all lookups are done, as interning can move the pool
+    // that `known` points into.
+    std::unordered_map<std::string_view, std::uint32_t> known;
+    for (const std::uint32_t id : categoryNames_) {
+        known.emplace(string(id), id);
+    }
+    std::vector<std::uint32_t> categoryNames;
+    std::vector<std::uint32_t> categoryStarts{0};
+    categoryNames.reserve(names.size());
+    categoryStarts.reserve(names.size() + 1);
+    for (std::size_t category = 0; category < names.size(); ++category) {
+        const auto found = known.find(names[category]);
+        categoryNames.push_back(found != known.end() ? found->second : kFreeSlot);
+        categoryStarts.push_back(checkedU32(categoryStarts.back() + sizes[category]));
+    }
+    known.clear();
+    for (std::size_t category = 0; category < names.size(); ++category) {
+        if (categoryNames[category] == kFreeSlot) {
+            categoryNames[category] = intern(names[category]);
+        }
+    }
+    if (categoryStarts.back() != sources.size()) {
+        throw std::logic_error("CatalogueStore::rearrange sizes do not add up");
+    }
+    for (std::size_t article = 0; article < kept.size(); ++article) {
+        if (!kept[article]) {
+            releaseSlot(articleSlots_[article]);
+        }
+    }
+    for (std::size_t position = 0; position < articleSlots.size(); ++position) {
+        slots_[articleSlots[position]].article = static_cast<std::uint32_t>(position);
+    }
+    prices_ = std::move(prices);
+    names_ = std::move(articleNames);
+    barcodes_ = std::move(barcodes);
+    articleSlots_ = std::move(articleSlots);
+    categoryNames_ = std::move(categoryNames);
+    categoryStarts_ = std::move(categoryStarts);
+}
+
+void CatalogueStore::inheritHandles(const CatalogueStore& previous, const std::vector<std::size_t>& sources) {
+    if (sources.size() != articleCount()) {
+        throw std::logic_error("CatalogueStore::inheritHandles needs a source for every article");
+    }
+    slots_ = previous.slots_;
+    freeSlots_ = previous.freeSlots_;
+    std::vector<char> kept(previous.articleCount(), 0);
+    for (std::size_t article = 0; article < sources.size(); ++article) {
+        if (sources[article] != kNoArticle) {
+            kept[sources[article]] = 1;
+        }
+    }
+    for (std::size_t article = 0; article < kept.size(); ++article) {
+        if (!kept[article]) {
+            releaseSlot(previous.articleSlots_[article]);
+        }
+    }
+    for (std::size_t article = 0; article < sources.size(); ++article) {
+        if (sources[article] == kNoArticle) {
+            articleSlots_[article] = takeSlot(article);
+        } else {
+            articleSlots_[article] = previous.articleSlots_[sources[article]];
+            slots_[articleSlots_[article]].article = static_cast<std::uint32_t>(article);
+        }
+    }
+}
+
+void CatalogueStore::shrinkToFit() {
+    internTable_ = {};
+    pool_.shrinkToFit();
+    stringStarts_.shrinkToFit();
+    prices_.shrinkToFit();
+    names_.shrinkToFit();
+    barcodes_.shrinkToFit();
+    categoryNames_.shrinkToFit();
+    categoryStarts_.shrinkToFit();
+    articleSlots_.shrink_to_fit();
+    slots_.shrink_to_fit();
+}
+
+std::uint32_t CatalogueStore::intern(std::string_view text) {
+    if (text.empty()) {
+        return 0;
+    }
+    if ((stringStarts_.size() + 1) * 4 > internTable_.size() * 3) {
+        growInternTable();
+    }
+    const std::size_t mask = internTable_.size() - 1;
+    std::size_t slot = std::hash<std::string_view>{}(text) & mask;
+    while (internTable_[slot] != kFreeSlot) {
+        if (string(internTable_[slot]) == text) {
+            return internTable_[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    internTable_[slot] = pushString(text);
+    return internTable_[slot];
+}
+
+std::uint32_t CatalogueStore::pushString(std::string_view text) {
+    const std::uint32_t id = checkedU32(stringStarts_.size() - 1);
+    checkedU32(pool_.size() + text.size());
+    pool_.append(text.data(), text.size());
+    stringStarts_.pushBack(static_cast<std::uint32_t>(pool_.size()));
+    return id;
+}
+
+// Doubles the table, or builds it from the strings already pooled after shrinkToFit.
+void CatalogueStore::growInternTable() {
+    const std::size_t strings = stringStarts_.size() - 1;
+    internTable_.assign(std::max<std::size_t>(64, std::bit_ceil((strings + 1) * 2)), kFreeSlot);
+    const std::size_t mask = internTable_.size() - 1;
+    for (std::uint32_t id = 1; id < strings; ++id) {
+        std::size_t slot = std::hash<std::string_view>{}(string(id)) & mask;
+        while (internTable_[slot] != kFreeSlot) {
+            slot = (slot + 1) & mask;
+        }
+        internTable_[slot] = id;
+    }
+}
+
+std::uint32_t CatalogueStore::takeSlot(std::size_t article) {
+    if (freeSlots_.empty()) {
+        slots_.push_back(Slot{static_cast<std::uint32_t>(article), 0});
+        return checkedU32(slots_.size() - 1);
+    }
+    const std::uint32_t slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    slots_[slot].article = static_cast<std::uint32_t>(article);
+    return slot;
+}
+
+void CatalogueStore::releaseSlot(std::uint32_t slot) {
+    ++slots_[slot].generation;
+    freeSlots_.push_back(slot);
+}
+
+} // namespace cashsloth
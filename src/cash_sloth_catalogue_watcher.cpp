@@ -0,0 +1,304 @@
+#include "cash_sloth_catalogue_watcher.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "cash_sloth_catalogue.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Editors save in several steps (truncate, write, rename); the file is loaded once no event
+// has arrived for this long.
+constexpr int kSettleMilliseconds = 250;
+
+#if defined(_WIN32) || defined(__linux__)
+std::filesystem::path watchedDirectory(const std::filesystem::path& path) {
+    const std::filesystem::path directory = path.parent_path();
+    return directory.empty() ? std::filesystem::path(".") : directory;
+}
+#endif
+
+}  // namespace
+
+namespace cashsloth {
+
+CatalogueWatcher::CatalogueWatcher(std::shared_ptr<const Catalogue> current, std::function<void()> onReload)
+    : path_(current->loadedFile()), onReload_(std::move(onReload)), current_(std::move(current)) {
+#if defined(_WIN32)
+    stopEvent_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!stopEvent_) {
+        std::cerr << "Warnung: Katalog wird nicht auf Aenderungen ueberwacht (Fehler " << GetLastError() << ")\n";
+        return;
+    }
+#elif defined(__linux__)
+    if (pipe2(stopPipe_, O_CLOEXEC) != 0) {
+        std::cerr << "Warnung: Katalog wird nicht auf Aenderungen ueberwacht: "
+                  << std::generic_category().message(errno) << '\n';
+        return;
+    }
+#endif
+    thread_ = std::thread([this] { run(); });
+}
+
+CatalogueWatcher::~CatalogueWatcher() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+#if defined(_WIN32)
+    if (stopEvent_) {
+        SetEvent(stopEvent_);
+    }
+#elif defined(__linux__)
+    if (stopPipe_[1] >= 0) {
+        const char byte = 0;
+        [[maybe_unused]] const ssize_t written = write(stopPipe_[1], &byte, 1);
+    }
+#else
+    stopped_.notify_all();
+#endif
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+#if defined(_WIN32)
+    if (stopEvent_) {
+        CloseHandle(stopEvent_);
+    }
+#elif defined(__linux__)
+    for (const int fd : stopPipe_) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+std::optional<CatalogueReload> CatalogueWatcher::takeReloaded() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    std::optional<CatalogueReload> reload = std::move(reloaded_);
+    reloaded_.reset();
+    if (reload) {
+        current_ = reload->catalogue;
+    }
+    return reload;
+}
+
+// The catalogue is built, diffed and given its handles completely before it is published,
+// so the owning thread only ever swaps pointers; the lock is held for the handover alone.
+// Should the owner take the previous reload in the meantime, the new one is diffed again
+// against that. A catalogue that does not differ from the current one is dropped, together
+// with a reload that is still waiting, since the file is back to what the owner shows.
+void CatalogueWatcher::reload() {
+    auto catalogue = std::make_shared<Catalogue>();
+    if (!catalogue->loadFromFile(path_)) {
+        return;
+    }
+    std::shared_ptr<const Catalogue> base;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        base = current_;
+    }
+    while (true) {
+        CatalogueDiff diff = diffCatalogues(base->store(), catalogue->store());
+        const bool changed = !diff.empty();
+        if (changed) {
+            catalogue->inheritHandles(*base, diff);
+        }
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return;
+            }
+            if (current_ != base) {
+                base = current_;
+                continue;
+            }
+            if (!changed) {
+                reloaded_.reset();
+                return;
+            }
+            reloaded_ = CatalogueReload{std::move(catalogue), std::move(diff)};
+        }
+        onReload_();
+        return;
+    }
+}
+
+#if defined(_WIN32)
+
+void CatalogueWatcher::run() {
+    const std::filesystem::path directory = watchedDirectory(path_);
+    HANDLE handle = CreateFileW(
+        directory.c_str(),
+        FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+        nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        std::cerr << "Warnung: Katalog wird nicht auf Aenderungen ueberwacht (Fehler " << GetLastError() << ")\n";
+        return;
+    }
+    HANDLE changed = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = changed;
+    alignas(FILE_NOTIFY_INFORMATION) char buffer[16 * 1024];
+    const std::wstring fileName = path_.filename().wstring();
+
+    bool reading = false;
+    bool pending = false;
+    while (changed) {
+        if (!reading) {
+            ResetEvent(changed);
+            reading = ReadDirectoryChangesW(
+                handle,
+                buffer,
+                sizeof(buffer),
+                FALSE,
+                FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE,
+                nullptr,
+                &overlapped,
+                nullptr) != 0;
+            if (!reading) {
+                break;
+            }
+        }
+        HANDLE handles[2] = {static_cast<HANDLE>(stopEvent_), changed};
+        const DWORD result = WaitForMultipleObjects(2, handles, FALSE, pending ? static_cast<DWORD>(kSettleMilliseconds) : INFINITE);
+        if (result == WAIT_TIMEOUT) {
+            pending = false;
+            reload();
+            continue;
+        }
+        if (result != WAIT_OBJECT_0 + 1) {
+            break;
+        }
+        reading = false;
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(handle, &overlapped, &bytes, FALSE)) {
+            break;
+        }
+        // No bytes means the buffer overflowed and the changes were lost, so assume ours is one.
+        pending = pending || bytes == 0;
+        for (DWORD offset = 0; offset < bytes && !pending;) {
+            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+            pending = CompareStringOrdinal(
+                          info->FileName,
+                          static_cast<int>(info->FileNameLength / sizeof(WCHAR)),
+                          fileName.c_str(),
+                          static_cast<int>(fileName.size()),
+                          TRUE) == CSTR_EQUAL;
+            if (info->NextEntryOffset == 0) {
+                break;
+            }
+            offset += info->NextEntryOffset;
+        }
+    }
+    if (reading) {
+        CancelIoEx(handle, &overlapped);
+        DWORD bytes = 0;
+        GetOverlappedResult(handle, &overlapped, &bytes, TRUE);
+    }
+    if (changed) {
+        CloseHandle(changed);
+    }
+    CloseHandle(handle);
+}
+
+#elif defined(__linux__)
+
+void CatalogueWatcher::run() {
+    const int watch = inotify_init1(IN_CLOEXEC);
+    if (watch < 0 ||
+        inotify_add_watch(watch, watchedDirectory(path_).c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE) < 0) {
+        std::cerr << "Warnung: Katalog wird nicht auf Aenderungen ueberwacht: "
+                  << std::generic_category().message(errno) << '\n';
+        if (watch >= 0) {
+            close(watch);
+        }
+        return;
+    }
+    pollfd fds[2] = {{stopPipe_[0], POLLIN, 0}, {watch, POLLIN, 0}};
+    alignas(inotify_event) char buffer[16 * 1024];
+    const std::string fileName = path_.filename().string();
+
+    bool pending = false;
+    while (true) {
+        const int ready = poll(fds, 2, pending ? kSettleMilliseconds : -1);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready < 0 || fds[0].revents != 0) {
+            break;
+        }
+        if (ready == 0) {
+            pending = false;
+            reload();
+            continue;
+        }
+        const ssize_t length = read(watch, buffer, sizeof(buffer));
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length <= 0) {
+            break;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            // An overflowed queue has lost its events, so assume ours was among them.
+            pending = pending || (event->mask & IN_Q_OVERFLOW) != 0 ||
+                      (event->len > 0 && fileName == event->name);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+    close(watch);
+}
+
+#else
+
+// Without a change notification API the file's size and timestamp are compared once a
+// second; a change is loaded once it has stayed the same for a full interval.
+void CatalogueWatcher::run() {
+    using FileState = std::pair<std::filesystem::file_time_type, std::uintmax_t>;
+    auto state = [this] {
+        std::error_code error;
+        return FileState(std::filesystem::last_write_time(path_, error), std::filesystem::file_size(path_, error));
+    };
+    FileState last = state();
+    bool pending = false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopped_.wait_for(lock, std::chrono::seconds(1), [this] { return stopping_; })) {
+        lock.unlock();
+        const FileState current = state();
+        if (current != last) {
+            last = current;
+            pending = true;
+        } else if (pending) {
+            pending = false;
+            reload();
+        }
+        lock.lock();
+    }
+}
+
+#endif
+
+} // namespace cashsloth
@@ -0,0 +1,84 @@
+#include "cash_sloth_display_strings.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "cash_sloth_money.h"
+#include "cash_sloth_utf8.h"
+
+namespace {
+
+std::uint32_t checkedOffset(std::size_t value) {
+    if (value >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Catalogue too large");
+    }
+    return static_cast<std::uint32_t>(value);
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+std::size_t writePriceLabel(std::int64_t cents, char16_t* out) {
+    std::size_t length = Money::fromRappen(cents).format(out);
+    for (const char16_t unit : std::u16string_view(u" CHF")) {
+        out[length++] = unit;
+    }
+    return length;
+}
+
+CatalogueDisplayStrings::CatalogueDisplayStrings(const CatalogueStore& store) {
+    std::vector<char> shown(store.stringCount(), 0);
+    for (std::size_t category = 0; category < store.categoryCount(); ++category) {
+        shown[store.categoryNameId(category)] = 1;
+    }
+    std::vector<std::int64_t> prices(store.articleCount());
+    for (std::size_t article = 0; article < store.articleCount(); ++article) {
+        shown[store.nameId(article)] = 1;
+        prices[article] = store.priceCents(article);
+    }
+    std::sort(prices.begin(), prices.end());
+    prices.erase(std::unique(prices.begin(), prices.end()), prices.end());
+
+    // A UTF-16 string has at most as many units as its UTF-8 form has bytes.
+    std::size_t capacity = prices.size() * (kPriceLabelCapacity + 1);
+    for (std::uint32_t id = 1; id < shown.size(); ++id) {
+        if (shown[id]) {
+            capacity += store.string(id).size() + 1;
+        }
+    }
+    pool_.resize(capacity);
+
+    std::size_t used = 0;
+    nameStarts_.resize(shown.size() + 1);
+    nameStarts_[0] = 0;
+    for (std::uint32_t id = 0; id < shown.size(); ++id) {
+        if (shown[id] && id != 0) {
+            used += utf8ToUtf16(store.string(id), pool_.data() + used);
+            pool_[used++] = u'\0';
+        }
+        nameStarts_[id + 1] = checkedOffset(used);
+    }
+    priceLabels_.reserve(prices.size());
+    for (const std::int64_t cents : prices) {
+        const std::size_t length = writePriceLabel(cents, pool_.data() + used);
+        priceLabels_.push_back(PriceLabel{cents, checkedOffset(used), static_cast<std::uint32_t>(length)});
+        used += length;
+        pool_[used++] = u'\0';
+    }
+    checkedOffset(used);
+    pool_.resize(used);
+    pool_.shrink_to_fit();
+}
+
+std::u16string_view CatalogueDisplayStrings::priceLabel(std::int64_t cents) const {
+    const auto found = std::lower_bound(priceLabels_.begin(), priceLabels_.end(), cents,
+                                        [](const PriceLabel& label, std::int64_t value) { return label.cents < value; });
+    if (found == priceLabels_.end() || found->cents != cents) {
+        return u"";
+    }
+    return std::u16string_view(pool_.data() + found->start, found->length);
+}
+
+} // namespace cashsloth
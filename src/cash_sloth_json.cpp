@@ -1,219 +1,1067 @@
 #include "cash_sloth_json.h"
 
-#include <cctype>
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <limits>
 #include <string>
 
+#include "cash_sloth_utf8.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CASHSLOTH_JSON_X86_64 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(CASHSLOTH_JSON_X86_64) && (defined(__GNUC__) || defined(__clang__))
+#define CASHSLOTH_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CASHSLOTH_TARGET_AVX2
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CASHSLOTH_COLD __attribute__((cold, noinline))
+#else
+#define CASHSLOTH_COLD
+#endif
+
 namespace {
 
-std::string encodeUtf8FromCodepoint(unsigned codepoint) {
-    std::string encoded;
-    auto appendByte = [&](unsigned char byte) {
-        encoded.push_back(static_cast<char>(byte));
-    };
-    if (codepoint <= 0x7F) {
-        appendByte(static_cast<unsigned char>(codepoint));
-    } else if (codepoint <= 0x7FF) {
-        appendByte(static_cast<unsigned char>(0xC0 | ((codepoint >> 6) & 0x1F)));
-        appendByte(static_cast<unsigned char>(0x80 | (codepoint & 0x3F)));
-    } else if (codepoint <= 0xFFFF) {
-        appendByte(static_cast<unsigned char>(0xE0 | ((codepoint >> 12) & 0x0F)));
-        appendByte(static_cast<unsigned char>(0x80 | ((codepoint >> 6) & 0x3F)));
-        appendByte(static_cast<unsigned char>(0x80 | (codepoint & 0x3F)));
-    } else if (codepoint <= 0x10FFFF) {
-        appendByte(static_cast<unsigned char>(0xF0 | ((codepoint >> 18) & 0x07)));
-        appendByte(static_cast<unsigned char>(0x80 | ((codepoint >> 12) & 0x3F)));
-        appendByte(static_cast<unsigned char>(0x80 | ((codepoint >> 6) & 0x3F)));
-        appendByte(static_cast<unsigned char>(0x80 | (codepoint & 0x3F)));
+// Scanning kernels return the offset of the first byte they stop at, or `size` when the
+// whole range was consumed. The string kernel stops at '"', '\\' and control bytes; the
+// whitespace kernel stops at anything other than space, tab, CR or LF. The container kernel
+// returns the offset just past the bracket that brings `state.depth` back to zero.
+struct ContainerScan {
+    std::size_t depth = 0;
+    bool inString = false;
+    bool escaped = false;
+};
+
+// Bit i of each mask describes byte i of a 64-byte block.
+struct BlockMasks {
+    std::uint64_t quotes = 0;
+    std::uint64_t backslashes = 0;
+    std::uint64_t structurals = 0;
+};
+
+struct ScanKernels {
+    std::size_t (*findStringSpecial)(const char* data, std::size_t size);
+    // Also stops at bytes from 0x80 up, so the parser can validate multi-byte sequences.
+    std::size_t (*findStringSpecialOrNonAscii)(const char* data, std::size_t size);
+    std::size_t (*skipSpaces)(const char* data, std::size_t size);
+    std::size_t (*skipContainer)(const char* data, std::size_t size, ContainerScan& state);
+    BlockMasks (*classifyBlock)(const char* data);
+};
+
+bool isStringSpecial(unsigned char ch) {
+    return ch == '"' || ch == '\\' || ch < 0x20;
+}
+
+bool isJsonSpace(unsigned char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+// '[' and '{' as well as ']' and '}' differ only in bit 5.
+bool isOpenBracket(unsigned char ch) {
+    return (ch | 0x20) == '{';
+}
+
+bool isCloseBracket(unsigned char ch) {
+    return (ch | 0x20) == '}';
+}
+
+// Running XOR of the bits: bit i is set when an odd number of bits at or below i are set.
+std::uint64_t prefixXor(std::uint64_t bits) {
+    for (int shift = 1; shift < 64; shift *= 2) {
+        bits ^= bits << shift;
+    }
+    return bits;
+}
+
+// Bits of the bytes that follow an odd run of backslashes, i.e. the escaped ones. `carry`
+// says whether the first byte is escaped by a run ending the previous block and is updated
+// for the next one. Backslash runs are told apart by subtracting them from the odd bit
+// positions, which flips exactly the bits up to the end of each run that starts on an even
+// position.
+std::uint64_t escapedBytes(std::uint64_t backslashes, bool& carry) {
+    constexpr std::uint64_t kOddBits = 0xAAAAAAAAAAAAAAAAull;
+    const std::uint64_t carried = carry ? 1 : 0;
+    if (backslashes == 0) {
+        carry = false;
+        return carried;
+    }
+    const std::uint64_t starts = backslashes & ~carried;
+    const std::uint64_t codes = (((starts << 1) | kOddBits) - starts) ^ kOddBits;
+    const std::uint64_t escapes = codes & backslashes;
+    carry = (escapes >> 63) != 0;
+    return codes ^ (backslashes | carried);
+}
+
+// Returns true when `ch` closes the container being skipped.
+bool stepContainer(ContainerScan& state, unsigned char ch) {
+    if (state.inString) {
+        if (state.escaped) {
+            state.escaped = false;
+        } else if (ch == '\\') {
+            state.escaped = true;
+        } else if (ch == '"') {
+            state.inString = false;
+        }
+        return false;
+    }
+    if (ch == '"') {
+        state.inString = true;
+    } else if (isOpenBracket(ch)) {
+        ++state.depth;
+    } else if (isCloseBracket(ch)) {
+        return --state.depth == 0;
+    }
+    return false;
+}
+
+// Applies one block of bit masks (bit i = byte i) to the container state. Blocks with
+// backslashes are left to the scalar path; without them, the bytes inside strings are the
+// running XOR of the quote bits, so brackets in text can be masked out without a loop.
+// Returns the offset past the closing bracket within the block, or `width` if none.
+template <typename Mask>
+std::size_t applyContainerMasks(ContainerScan& state, Mask quotes, Mask opens, Mask closes, std::size_t width) {
+    Mask inside = quotes;
+    for (std::size_t shift = 1; shift < width; shift *= 2) {
+        inside ^= static_cast<Mask>(inside << shift);
+    }
+    if (state.inString) {
+        inside = static_cast<Mask>(~inside);
+    }
+    opens &= static_cast<Mask>(~inside);
+    closes &= static_cast<Mask>(~inside);
+    if (closes == 0) {
+        state.depth += static_cast<std::size_t>(std::popcount(opens));
     } else {
-        throw std::runtime_error("Unsupported Unicode codepoint in JSON escape");
+        for (Mask brackets = opens | closes; brackets != 0; brackets &= static_cast<Mask>(brackets - 1)) {
+            const int bit = std::countr_zero(brackets);
+            if ((opens >> bit) & 1) {
+                ++state.depth;
+            } else if (--state.depth == 0) {
+                return static_cast<std::size_t>(bit) + 1;
+            }
+        }
+    }
+    state.inString ^= (std::popcount(quotes) & 1) != 0;
+    return width;
+}
+
+template <bool StopAtNonAscii = false>
+std::size_t findStringSpecialScalar(const char* data, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        const unsigned char ch = static_cast<unsigned char>(data[i]);
+        if (isStringSpecial(ch) || (StopAtNonAscii && ch >= 0x80)) {
+            return i;
+        }
+    }
+    return size;
+}
+
+std::size_t skipSpacesScalar(const char* data, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        if (!isJsonSpace(static_cast<unsigned char>(data[i]))) {
+            return i;
+        }
+    }
+    return size;
+}
+
+#if !defined(CASHSLOTH_JSON_X86_64)
+// The x86-64 builds always have SSE2, so only other targets classify blocks byte by byte.
+bool isStructuralChar(unsigned char ch) {
+    return isOpenBracket(ch) || isCloseBracket(ch) || ch == ':' || ch == ',';
+}
+
+BlockMasks classifyBlockScalar(const char* data) {
+    BlockMasks masks;
+    for (int i = 0; i < 64; ++i) {
+        const unsigned char ch = static_cast<unsigned char>(data[i]);
+        const std::uint64_t bit = std::uint64_t{1} << i;
+        masks.quotes |= ch == '"' ? bit : 0;
+        masks.backslashes |= ch == '\\' ? bit : 0;
+        masks.structurals |= isStructuralChar(ch) ? bit : 0;
+    }
+    return masks;
+}
+#endif
+
+std::size_t skipContainerScalar(const char* data, std::size_t size, ContainerScan& state) {
+    for (std::size_t i = 0; i < size; ++i) {
+        if (stepContainer(state, static_cast<unsigned char>(data[i]))) {
+            return i + 1;
+        }
+    }
+    return size;
+}
+
+#if defined(CASHSLOTH_JSON_X86_64)
+
+template <bool StopAtNonAscii = false>
+std::size_t findStringSpecialSse2(const char* data, std::size_t size) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i controlMax = _mm_set1_epi8(0x1F);
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, controlMax), controlMax));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if constexpr (StopAtNonAscii) {
+            mask |= static_cast<unsigned>(_mm_movemask_epi8(chunk));
+        }
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + findStringSpecialScalar<StopAtNonAscii>(data + i, size - i);
+}
+
+std::size_t skipSpacesSse2(const char* data, std::size_t size) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i blank = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+        const unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(blank)) & 0xFFFFu;
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + skipSpacesScalar(data + i, size - i);
+}
+
+std::size_t skipContainerSse2(const char* data, std::size_t size, ContainerScan& state) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i openBracket = _mm_set1_epi8('{');
+    const __m128i closeBracket = _mm_set1_epi8('}');
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const unsigned escapes = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)));
+        std::size_t closed = 16;
+        if (escapes != 0 || state.escaped) {
+            closed = skipContainerScalar(data + i, 16, state);
+        } else {
+            const __m128i folded = _mm_or_si128(chunk, caseBit);
+            closed = applyContainerMasks<std::uint16_t>(
+                state,
+                static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))),
+                static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, openBracket))),
+                static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, closeBracket))),
+                16);
+        }
+        if (closed < 16 || state.depth == 0) {
+            return i + closed;
+        }
+    }
+    return i + skipContainerScalar(data + i, size - i, state);
+}
+
+BlockMasks classifyBlockSse2(const char* data) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i openBracket = _mm_set1_epi8('{');
+    const __m128i closeBracket = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    BlockMasks masks;
+    for (int part = 0; part < 4; ++part) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + part * 16));
+        const __m128i folded = _mm_or_si128(chunk, caseBit);
+        const __m128i structural = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, openBracket), _mm_cmpeq_epi8(folded, closeBracket)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma)));
+        const int shift = part * 16;
+        masks.quotes |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))) << shift;
+        masks.backslashes |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)))) << shift;
+        masks.structurals |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(structural))) << shift;
+    }
+    return masks;
+}
+
+template <bool StopAtNonAscii = false>
+CASHSLOTH_TARGET_AVX2 std::size_t findStringSpecialAvx2(const char* data, std::size_t size) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i controlMax = _mm256_set1_epi8(0x1F);
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+            _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, controlMax), controlMax));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if constexpr (StopAtNonAscii) {
+            mask |= static_cast<unsigned>(_mm256_movemask_epi8(chunk));
+        }
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + findStringSpecialSse2<StopAtNonAscii>(data + i, size - i);
+}
+
+CASHSLOTH_TARGET_AVX2 std::size_t skipSpacesAvx2(const char* data, std::size_t size) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i blank = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, cr), _mm256_cmpeq_epi8(chunk, lf)));
+        const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(blank));
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
     }
-    return encoded;
+    return i + skipSpacesSse2(data + i, size - i);
+}
+
+CASHSLOTH_TARGET_AVX2 std::size_t skipContainerAvx2(const char* data, std::size_t size, ContainerScan& state) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i openBracket = _mm256_set1_epi8('{');
+    const __m256i closeBracket = _mm256_set1_epi8('}');
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const unsigned escapes = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash)));
+        std::size_t closed = 32;
+        if (escapes != 0 || state.escaped) {
+            closed = skipContainerScalar(data + i, 32, state);
+        } else {
+            const __m256i folded = _mm256_or_si256(chunk, caseBit);
+            closed = applyContainerMasks<std::uint32_t>(
+                state,
+                static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote))),
+                static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(folded, openBracket))),
+                static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(folded, closeBracket))),
+                32);
+        }
+        if (closed < 32 || state.depth == 0) {
+            return i + closed;
+        }
+    }
+    return i + skipContainerSse2(data + i, size - i, state);
+}
+
+CASHSLOTH_TARGET_AVX2 BlockMasks classifyBlockAvx2(const char* data) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i openBracket = _mm256_set1_epi8('{');
+    const __m256i closeBracket = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    BlockMasks masks;
+    for (int part = 0; part < 2; ++part) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + part * 32));
+        const __m256i folded = _mm256_or_si256(chunk, caseBit);
+        const __m256i structural = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, openBracket), _mm256_cmpeq_epi8(folded, closeBracket)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon), _mm256_cmpeq_epi8(chunk, comma)));
+        const int shift = part * 32;
+        masks.quotes |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)))) << shift;
+        masks.backslashes |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash)))) << shift;
+        masks.structurals |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm256_movemask_epi8(structural))) << shift;
+    }
+    return masks;
+}
+
+bool cpuSupportsAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4]{};
+    __cpuid(regs, 1);
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // defined(CASHSLOTH_JSON_X86_64)
+
+ScanKernels selectScanKernels() {
+#if defined(CASHSLOTH_JSON_X86_64)
+    if (cpuSupportsAvx2()) {
+        return {findStringSpecialAvx2, findStringSpecialAvx2<true>, skipSpacesAvx2, skipContainerAvx2, classifyBlockAvx2};
+    }
+    return {findStringSpecialSse2, findStringSpecialSse2<true>, skipSpacesSse2, skipContainerSse2, classifyBlockSse2};
+#else
+    return {findStringSpecialScalar,
+            findStringSpecialScalar<true>,
+            skipSpacesScalar,
+            skipContainerScalar,
+            classifyBlockScalar};
+#endif
+}
+
+const ScanKernels& scanKernels() {
+    static const ScanKernels kernels = selectScanKernels();
+    return kernels;
+}
+
+// Skips JSON whitespace and byte order marks that appear between tokens.
+std::size_t skipJsonSpace(std::string_view text, std::size_t offset) {
+    while (offset < text.size()) {
+        const unsigned char ch = static_cast<unsigned char>(text[offset]);
+        if (isJsonSpace(ch)) {
+            ++offset;
+            offset += scanKernels().skipSpaces(text.data() + offset, text.size() - offset);
+            continue;
+        }
+        if (ch == 0xEF && offset + 2 < text.size()) {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text.data() + offset);
+            if (bytes[1] == 0xBB && bytes[2] == 0xBF) {
+                offset += 3;
+                continue;
+            }
+        }
+        break;
+    }
+    return offset;
+}
+
+// Powers of ten that are exact doubles, and the largest integer below which every integer
+// is one, for the correctly rounded number conversion in JsonParser::scanNumber.
+constexpr int kMaxExactPowerOfTen = 22;
+constexpr double kPowersOfTen[kMaxExactPowerOfTen + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+constexpr std::uint64_t kMaxExactDoubleInteger = std::uint64_t{1} << 53;
+// Written exponents from this size on are only kept in the double.
+constexpr int kMaxDecimalExponent = 100000;
+
+// Value of the four hex digits at `text`, or -1 if any of them is not a hex digit.
+long parseHex4(const char* text) {
+    long value = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char ch = text[i];
+        value <<= 4;
+        if (ch >= '0' && ch <= '9') {
+            value |= ch - '0';
+        } else if ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'f') {
+            value |= (ch | 0x20) - 'a' + 10;
+        } else {
+            return -1;
+        }
+    }
+    return value;
 }
 
 }  // namespace
 
 namespace cashsloth {
 
-JsonValue JsonParser::parse() {
+JsonNumber::JsonNumber(double value) : value_(value), exact_(false) {
+    if (!std::isfinite(value)) {
+        return;
+    }
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    if (const std::optional<JsonNumber> parsed = parse(std::string_view(buffer, result.ptr - buffer))) {
+        mantissa_ = parsed->mantissa_;
+        exponent_ = parsed->exponent_;
+        exact_ = parsed->exact_;
+    }
+}
+
+// The double is derived through the parser so it is the correctly rounded one; values beyond
+// the double range come out as infinity or zero.
+JsonNumber JsonNumber::fromDecimal(std::int64_t mantissa, int exponent) {
+    const std::string text = std::to_string(mantissa) + 'e' + std::to_string(exponent);
+    JsonNumber number;
+    if (const std::optional<JsonNumber> parsed = parse(text)) {
+        number.value_ = parsed->value_;
+    } else {
+        number.value_ = std::copysign(exponent > 0 ? HUGE_VAL : 0.0, static_cast<double>(mantissa));
+    }
+    number.mantissa_ = mantissa;
+    number.exponent_ = exponent;
+    number.exact_ = true;
+    return number;
+}
+
+std::optional<JsonNumber> JsonNumber::parse(std::string_view text) {
+    if (text.empty() || (text.front() != '-' && (text.front() < '0' || text.front() > '9'))) {
+        return std::nullopt;
+    }
+    JsonParser parser(text);
+    JsonNumber number;
+    if (!parser.scanNumber(number) || parser.cursor_ != text.size()) {
+        return std::nullopt;
+    }
+    return number;
+}
+
+// Scaling walks one digit at a time; both loops end within 19 steps for a non-zero mantissa,
+// by overflow or by a digit that would be lost.
+std::optional<std::int64_t> JsonNumber::toScaled(int decimals) const {
+    if (!exact_) {
+        return std::nullopt;
+    }
+    if (mantissa_ == 0) {
+        return 0;
+    }
+    const long long shift = static_cast<long long>(exponent_) + decimals;
+    std::int64_t result = mantissa_;
+    for (long long i = 0; i < shift; ++i) {
+        if (result > std::numeric_limits<std::int64_t>::max() / 10 ||
+            result < std::numeric_limits<std::int64_t>::min() / 10) {
+            return std::nullopt;
+        }
+        result *= 10;
+    }
+    for (long long i = shift; i < 0; ++i) {
+        if (result % 10 != 0) {
+            return std::nullopt;
+        }
+        result /= 10;
+    }
+    return result;
+}
+
+std::size_t findJsonStringSpecial(const char* data, std::size_t size) {
+    return scanKernels().findStringSpecial(data, size);
+}
+
+// Quotes escaped by a backslash are removed with escapedBytes(); the remaining quotes then
+// delimit strings, which the prefix XOR turns into an in-string mask, like the container
+// kernels do.
+bool buildJsonStructuralIndex(std::string_view text, std::vector<std::uint32_t>& positions) {
+    positions.clear();
+    positions.reserve(text.size() / 8);
+    const auto classifyBlock = scanKernels().classifyBlock;
+    bool inString = false;
+    bool escapeCarry = false;
+    char padded[64];
+    for (std::size_t base = 0; base < text.size(); base += 64) {
+        const std::size_t length = std::min<std::size_t>(64, text.size() - base);
+        const char* block = text.data() + base;
+        if (length < 64) {
+            std::memset(padded, 0, sizeof(padded));
+            std::memcpy(padded, block, length);
+            block = padded;
+        }
+        const BlockMasks masks = classifyBlock(block);
+        const std::uint64_t quotes = masks.quotes & ~escapedBytes(masks.backslashes, escapeCarry);
+        std::uint64_t inside = prefixXor(quotes);
+        if (inString) {
+            inside = ~inside;
+        }
+        inString ^= (std::popcount(quotes) & 1) != 0;
+        std::uint64_t structurals = masks.structurals & ~inside;
+        while (structurals != 0) {
+            positions.push_back(static_cast<std::uint32_t>(base + static_cast<std::size_t>(std::countr_zero(structurals))));
+            structurals &= structurals - 1;
+        }
+    }
+    return !inString;
+}
+
+// Records the first error at the current position. Always returns false so that callers
+// can hand the failure up with a plain return. Defined ahead of its callers so that they see
+// it as cold and keep the error paths out of the hot code.
+CASHSLOTH_COLD bool JsonParser::fail(JsonErrorCode code, const char* message) {
+    error_ = {code, cursor_, message};
+    return false;
+}
+
+JsonResult<JsonValue> JsonParser::tryParse() {
     skipBom();
     skipWhitespace();
-    JsonValue value = parseValue();
+    JsonValue value;
+    if (!parseValue(value) || !parseEnd()) {
+        return error_;
+    }
+    return value;
+}
+
+std::optional<JsonError> JsonParser::tryParse(JsonHandler& handler) {
+    skipBom();
+    skipWhitespace();
+    if (!parseValue(handler) || !parseEnd()) {
+        return error_;
+    }
+    return std::nullopt;
+}
+
+JsonValue JsonParser::parse() {
+    JsonResult<JsonValue> result = tryParse();
+    if (!result) {
+        throwError();
+    }
+    return std::move(*result);
+}
+
+void JsonParser::parse(JsonHandler& handler) {
+    if (tryParse(handler)) {
+        throwError();
+    }
+}
+
+bool JsonParser::parseEnd() {
     skipWhitespace();
     if (cursor_ != text_.size()) {
-        error("Unexpected characters after JSON value");
+        return fail(JsonErrorCode::TrailingCharacters, "Unexpected characters after JSON value");
     }
-    return value;
+    return true;
 }
 
-JsonValue JsonParser::parseValue() {
+bool JsonParser::parseValue(JsonValue& value) {
     skipWhitespace();
     if (cursor_ >= text_.size()) {
-        error("Unexpected end of input while parsing value");
+        return fail(JsonErrorCode::UnexpectedEnd, "Unexpected end of input while parsing value");
     }
     const char ch = peek();
     switch (ch) {
         case '{':
-            return parseObject();
+            return parseObject(value);
         case '[':
-            return parseArray();
-        case '"':
-            return JsonValue(parseString());
+            return parseArray(value);
+        case '"': {
+            std::string_view text;
+            if (!scanString(text)) {
+                return false;
+            }
+            value = JsonValue(std::string(text));
+            return true;
+        }
         case 't':
-            return parseTrue();
+            if (!scanLiteral("true", "Invalid literal, expected true")) {
+                return false;
+            }
+            value = JsonValue(true);
+            return true;
         case 'f':
-            return parseFalse();
+            if (!scanLiteral("false", "Invalid literal, expected false")) {
+                return false;
+            }
+            value = JsonValue(false);
+            return true;
         case 'n':
-            return parseNull();
+            if (!scanLiteral("null", "Invalid literal, expected null")) {
+                return false;
+            }
+            value = JsonValue(nullptr);
+            return true;
         default:
             if (ch == '-' || (ch >= '0' && ch <= '9')) {
-                return parseNumber();
+                JsonNumber number;
+                if (!scanNumber(number)) {
+                    return false;
+                }
+                value = JsonValue(number);
+                return true;
             }
-            error("Unexpected character while parsing value");
+            return fail(JsonErrorCode::UnexpectedCharacter, "Unexpected character while parsing value");
     }
 }
 
-JsonValue JsonParser::parseObject() {
-    expect('{');
+bool JsonParser::parseObject(JsonValue& value) {
+    if (!expect('{')) {
+        return false;
+    }
     skipWhitespace();
     JsonValue::Object object;
+    if (!consume('}')) {
+        while (true) {
+            skipWhitespace();
+            if (cursor_ >= text_.size() || peek() != '"') {
+                return fail(JsonErrorCode::ExpectedKey, "Expected string key inside JSON object");
+            }
+            std::string_view keyText;
+            if (!scanString(keyText)) {
+                return false;
+            }
+            // Duplicate keys keep their first value; later ones are parsed and dropped.
+            const auto [member, inserted] = object.try_emplace(std::string(keyText));
+            skipWhitespace();
+            if (!expect(':')) {
+                return false;
+            }
+            skipWhitespace();
+            JsonValue duplicate;
+            if (!parseValue(inserted ? member->second : duplicate)) {
+                return false;
+            }
+            skipWhitespace();
+            if (consume('}')) {
+                break;
+            }
+            if (!expect(',')) {
+                return false;
+            }
+        }
+    }
+    value = JsonValue(std::move(object));
+    return true;
+}
+
+bool JsonParser::parseArray(JsonValue& value) {
+    if (!expect('[')) {
+        return false;
+    }
+    skipWhitespace();
+    JsonValue::Array array;
+    if (!consume(']')) {
+        while (true) {
+            if (!parseValue(array.emplace_back())) {
+                return false;
+            }
+            skipWhitespace();
+            if (consume(']')) {
+                break;
+            }
+            if (!expect(',')) {
+                return false;
+            }
+        }
+    }
+    value = JsonValue(std::move(array));
+    return true;
+}
+
+bool JsonParser::parseValue(JsonHandler& handler) {
+    skipWhitespace();
+    if (cursor_ >= text_.size()) {
+        return fail(JsonErrorCode::UnexpectedEnd, "Unexpected end of input while parsing value");
+    }
+    const char ch = peek();
+    switch (ch) {
+        case '{':
+            return parseObject(handler);
+        case '[':
+            return parseArray(handler);
+        case '"': {
+            std::string_view text;
+            if (!scanString(text)) {
+                return false;
+            }
+            handler.onString(text);
+            return true;
+        }
+        case 't':
+            if (!scanLiteral("true", "Invalid literal, expected true")) {
+                return false;
+            }
+            handler.onBool(true);
+            return true;
+        case 'f':
+            if (!scanLiteral("false", "Invalid literal, expected false")) {
+                return false;
+            }
+            handler.onBool(false);
+            return true;
+        case 'n':
+            if (!scanLiteral("null", "Invalid literal, expected null")) {
+                return false;
+            }
+            handler.onNull();
+            return true;
+        default:
+            if (ch == '-' || (ch >= '0' && ch <= '9')) {
+                JsonNumber number;
+                if (!scanNumber(number)) {
+                    return false;
+                }
+                handler.onNumber(number.toDouble());
+                return true;
+            }
+            return fail(JsonErrorCode::UnexpectedCharacter, "Unexpected character while parsing value");
+    }
+}
+
+bool JsonParser::parseObject(JsonHandler& handler) {
+    if (!expect('{')) {
+        return false;
+    }
+    handler.onStartObject();
+    skipWhitespace();
     if (consume('}')) {
-        return JsonValue(std::move(object));
+        handler.onEndObject();
+        return true;
     }
     while (true) {
         skipWhitespace();
-        if (peek() != '"') {
-            error("Expected string key inside JSON object");
+        if (cursor_ >= text_.size() || peek() != '"') {
+            return fail(JsonErrorCode::ExpectedKey, "Expected string key inside JSON object");
+        }
+        std::string_view key;
+        if (!scanString(key)) {
+            return false;
         }
-        std::string key = parseString();
+        handler.onKey(key);
         skipWhitespace();
-        expect(':');
+        if (!expect(':')) {
+            return false;
+        }
         skipWhitespace();
-        JsonValue value = parseValue();
-        object.emplace(std::move(key), std::move(value));
+        if (!parseValue(handler)) {
+            return false;
+        }
         skipWhitespace();
         if (consume('}')) {
             break;
         }
-        expect(',');
+        if (!expect(',')) {
+            return false;
+        }
     }
-    return JsonValue(std::move(object));
+    handler.onEndObject();
+    return true;
 }
 
-JsonValue JsonParser::parseArray() {
-    expect('[');
+bool JsonParser::parseArray(JsonHandler& handler) {
+    if (!expect('[')) {
+        return false;
+    }
+    handler.onStartArray();
     skipWhitespace();
-    JsonValue::Array array;
     if (consume(']')) {
-        return JsonValue(std::move(array));
+        handler.onEndArray();
+        return true;
     }
     while (true) {
-        array.push_back(parseValue());
+        if (!parseValue(handler)) {
+            return false;
+        }
         skipWhitespace();
         if (consume(']')) {
             break;
         }
-        expect(',');
+        if (!expect(',')) {
+            return false;
+        }
     }
-    return JsonValue(std::move(array));
+    handler.onEndArray();
+    return true;
 }
 
-JsonValue JsonParser::parseNumber() {
+// Validates the JSON number grammar in place and converts without copying the token. The
+// significant digits are collected into the decimal mantissa on the way. Integers of up to
+// 19 digits convert to double directly (the uint64 -> double conversion rounds exactly like
+// strtod), and so do decimals whose mantissa and power of ten are both exact doubles, because
+// a single multiplication or division is correctly rounded. Everything else goes through
+// std::from_chars, which is locale-independent and does not allocate.
+bool JsonParser::scanNumber(JsonNumber& number) {
     const std::size_t start = cursor_;
-    if (peek() == '-') {
+    const bool negative = peek() == '-';
+    if (negative) {
         advance();
     }
-    while (cursor_ < text_.size() && std::isdigit(static_cast<unsigned char>(peek()))) {
-        advance();
+    std::uint64_t magnitude = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool exact = true;
+    // Digits past the 19th no longer fit into the mantissa; in the integer part they still
+    // scale it, and any of them other than zero makes the decimal form inexact.
+    auto scanDigits = [&](bool fraction) {
+        const std::size_t first = cursor_;
+        while (cursor_ < text_.size() && peek() >= '0' && peek() <= '9') {
+            const unsigned digit = static_cast<unsigned>(peek() - '0');
+            if (significant < 19) {
+                magnitude = magnitude * 10 + digit;
+                significant += magnitude != 0 ? 1 : 0;
+                exponent -= fraction ? 1 : 0;
+            } else {
+                exact = exact && digit == 0;
+                exponent += fraction ? 0 : 1;
+            }
+            advance();
+        }
+        return cursor_ - first;
+    };
+
+    const std::size_t integerDigits = scanDigits(false);
+    if (integerDigits == 0) {
+        return fail(JsonErrorCode::InvalidNumber, "Invalid number, expected digits");
+    }
+    // RFC 8259 allows a zero only on its own, so "007" and "01.5" are not numbers.
+    if (integerDigits > 1 && text_[cursor_ - integerDigits] == '0') {
+        cursor_ -= integerDigits - 1;
+        return fail(JsonErrorCode::InvalidNumber, "Invalid number, leading zero");
     }
+    bool integral = true;
     if (cursor_ < text_.size() && peek() == '.') {
         advance();
-        while (cursor_ < text_.size() && std::isdigit(static_cast<unsigned char>(peek()))) {
-            advance();
+        integral = false;
+        if (scanDigits(true) == 0) {
+            return fail(JsonErrorCode::InvalidNumber, "Invalid number, expected digits after decimal point");
         }
     }
     if (cursor_ < text_.size() && (peek() == 'e' || peek() == 'E')) {
         advance();
+        integral = false;
+        bool negativeExponent = false;
         if (cursor_ < text_.size() && (peek() == '+' || peek() == '-')) {
+            negativeExponent = peek() == '-';
             advance();
         }
-        while (cursor_ < text_.size() && std::isdigit(static_cast<unsigned char>(peek()))) {
+        const std::size_t first = cursor_;
+        int written = 0;
+        while (cursor_ < text_.size() && peek() >= '0' && peek() <= '9') {
+            if (written < kMaxDecimalExponent) {
+                written = written * 10 + (peek() - '0');
+            }
             advance();
         }
+        if (cursor_ == first) {
+            return fail(JsonErrorCode::InvalidNumber, "Invalid number, expected exponent digits");
+        }
+        exact = exact && written < kMaxDecimalExponent;
+        exponent += negativeExponent ? -written : written;
     }
-    const double value = std::stod(std::string(text_.substr(start, cursor_ - start)));
-    return JsonValue(value);
-}
 
-JsonValue JsonParser::parseTrue() {
-    if (text_.substr(cursor_, 4) != "true") {
-        error("Invalid literal, expected true");
+    if (exact && magnitude <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+        number.mantissa_ = negative ? -static_cast<std::int64_t>(magnitude) : static_cast<std::int64_t>(magnitude);
+        number.exponent_ = exponent;
+        number.exact_ = true;
+    } else {
+        number.mantissa_ = 0;
+        number.exponent_ = 0;
+        number.exact_ = false;
     }
-    cursor_ += 4;
-    return JsonValue(true);
-}
 
-JsonValue JsonParser::parseFalse() {
-    if (text_.substr(cursor_, 5) != "false") {
-        error("Invalid literal, expected false");
+    if ((integral && integerDigits <= 19) ||
+        (exact && magnitude <= kMaxExactDoubleInteger && exponent >= -kMaxExactPowerOfTen &&
+         exponent <= kMaxExactPowerOfTen)) {
+        double value = static_cast<double>(magnitude);
+        if (exponent < 0) {
+            value /= kPowersOfTen[-exponent];
+        } else if (exponent > 0) {
+            value *= kPowersOfTen[exponent];
+        }
+        number.value_ = negative ? -value : value;
+        return true;
     }
-    cursor_ += 5;
-    return JsonValue(false);
+
+    const char* first = text_.data() + start;
+    const char* last = text_.data() + cursor_;
+    const auto [end, ec] = std::from_chars(first, last, number.value_);
+    if (ec != std::errc() || end != last) {
+        cursor_ = start;
+        return fail(JsonErrorCode::NumberOutOfRange, "Number out of range");
+    }
+    return true;
 }
 
-JsonValue JsonParser::parseNull() {
-    if (text_.substr(cursor_, 4) != "null") {
-        error("Invalid literal, expected null");
+bool JsonParser::scanLiteral(std::string_view literal, const char* message) {
+    if (text_.substr(cursor_, literal.size()) != literal) {
+        return fail(JsonErrorCode::InvalidLiteral, message);
     }
-    cursor_ += 4;
-    return JsonValue(nullptr);
+    cursor_ += literal.size();
+    return true;
 }
 
-std::string JsonParser::parseString() {
-    expect('"');
-    std::string result;
+// Yields a view into the input when the string has no escapes; otherwise the string is
+// decoded into scratch_ and the view refers to that buffer until the next call. Plain runs
+// between escapes are located with the vector kernels and copied in bulk.
+bool JsonParser::scanString(std::string_view& value) {
+    if (!expect('"')) {
+        return false;
+    }
+    const std::size_t start = cursor_;
+    // Plain ASCII strings are the common case and stay on this inline path.
+    cursor_ += scanKernels().findStringSpecialOrNonAscii(text_.data() + cursor_, text_.size() - cursor_);
+    if (cursor_ < text_.size() && static_cast<unsigned char>(peek()) >= 0x80 && !scanStringText()) {
+        return false;
+    }
+    if (cursor_ < text_.size() && peek() == '"') {
+        value = text_.substr(start, cursor_ - start);
+        advance();
+        return true;
+    }
+
+    std::string& result = scratch_;
+    result.assign(text_.substr(start, cursor_ - start));
     while (cursor_ < text_.size()) {
         const char ch = peek();
-        advance();
         if (ch == '"') {
-            break;
-        }
-        if (ch == '\\') {
-            if (cursor_ >= text_.size()) {
-                error("Unexpected end of escape sequence");
-            }
-            const char escape = peek();
             advance();
-            switch (escape) {
-                case '"': result.push_back('"'); break;
-                case '\\': result.push_back('\\'); break;
-                case '/': result.push_back('/'); break;
-                case 'b': result.push_back('\b'); break;
-                case 'f': result.push_back('\f'); break;
-                case 'n': result.push_back('\n'); break;
-                case 'r': result.push_back('\r'); break;
-                case 't': result.push_back('\t'); break;
-                case 'u': {
-                    if (cursor_ + 4 > text_.size()) {
-                        error("Incomplete unicode escape");
-                    }
-                    const std::string hex(text_.substr(cursor_, 4));
-                    cursor_ += 4;
-                    const unsigned codepoint = static_cast<unsigned>(std::stoul(hex, nullptr, 16));
-                    if (codepoint <= 0x7F) {
-                        result.push_back(static_cast<char>(codepoint));
-                    } else {
-                        result += encodeUtf8FromCodepoint(codepoint);
+            value = result;
+            return true;
+        }
+        if (ch != '\\') {
+            return fail(JsonErrorCode::ControlCharacter, "Unescaped control character in string");
+        }
+        advance();
+        if (cursor_ >= text_.size()) {
+            return fail(JsonErrorCode::UnterminatedString, "Unexpected end of escape sequence");
+        }
+        const char escape = peek();
+        switch (escape) {
+            case '"': result.push_back('"'); break;
+            case '\\': result.push_back('\\'); break;
+            case '/': result.push_back('/'); break;
+            case 'b': result.push_back('\b'); break;
+            case 'f': result.push_back('\f'); break;
+            case 'n': result.push_back('\n'); break;
+            case 'r': result.push_back('\r'); break;
+            case 't': result.push_back('\t'); break;
+            case 'u': {
+                if (cursor_ + 5 > text_.size()) {
+                    return fail(JsonErrorCode::InvalidEscape, "Incomplete unicode escape");
+                }
+                const long unit = parseHex4(text_.data() + cursor_ + 1);
+                if (unit < 0) {
+                    return fail(JsonErrorCode::InvalidEscape, "Invalid unicode escape");
+                }
+                cursor_ += 4;
+                char32_t codepoint = static_cast<char32_t>(unit);
+                // A high surrogate only names a character together with the low surrogate
+                // escape after it; unpaired halves have no UTF-8 form and become U+FFFD.
+                if (codepoint >= 0xD800 && codepoint <= 0xDBFF && cursor_ + 7 <= text_.size() &&
+                    text_[cursor_ + 1] == '\\' && text_[cursor_ + 2] == 'u') {
+                    const long low = parseHex4(text_.data() + cursor_ + 3);
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + static_cast<char32_t>(low - 0xDC00);
+                        cursor_ += 6;
                     }
-                    break;
                 }
-                default:
-                    error("Invalid escape sequence in string");
+                appendUtf8(result, codepoint);
+                break;
             }
-        } else {
-            result.push_back(ch);
+            default:
+                return fail(JsonErrorCode::InvalidEscape, "Invalid escape sequence in string");
+        }
+        advance();
+        const std::size_t run = cursor_;
+        if (!scanStringText()) {
+            return false;
         }
+        result.append(text_.data() + run, cursor_ - run);
     }
-    return result;
+    return fail(JsonErrorCode::UnterminatedString, "Unterminated string in JSON input");
 }
 
 bool JsonParser::consume(char expected) {
@@ -224,10 +1072,11 @@ bool JsonParser::consume(char expected) {
     return false;
 }
 
-void JsonParser::expect(char expected) {
+bool JsonParser::expect(char expected) {
     if (!consume(expected)) {
-        error("Unexpected token while parsing JSON");
+        return fail(JsonErrorCode::UnexpectedToken, "Unexpected token while parsing JSON");
     }
+    return true;
 }
 
 void JsonParser::skipBom() {
@@ -240,26 +1089,291 @@ void JsonParser::skipBom() {
 }
 
 void JsonParser::skipWhitespace() {
-    while (cursor_ < text_.size()) {
-        const unsigned char ch = static_cast<unsigned char>(text_[cursor_]);
-        if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
-            ++cursor_;
-            continue;
+    cursor_ = skipJsonSpace(text_, cursor_);
+}
+
+// Moves over unescaped string content up to the next '"', '\\', control byte or the end.
+// Those bytes are copied or viewed as they are, so multi-byte sequences are validated on the
+// way; escapes are encoded by the parser and are valid UTF-8 by construction.
+bool JsonParser::scanStringText() {
+    const auto findText = scanKernels().findStringSpecialOrNonAscii;
+    while (true) {
+        cursor_ += findText(text_.data() + cursor_, text_.size() - cursor_);
+        if (cursor_ >= text_.size() || static_cast<unsigned char>(peek()) < 0x80) {
+            return true;
         }
-        if (ch == 0xEF && cursor_ + 2 < text_.size()) {
-            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text_.data() + cursor_);
-            if (bytes[1] == 0xBB && bytes[2] == 0xBF) {
-                cursor_ += 3;
-                continue;
+        const std::size_t length = utf8SequenceLength(text_.data() + cursor_, text_.size() - cursor_);
+        if (length == 0) {
+            return fail(JsonErrorCode::InvalidUtf8, "Invalid UTF-8 in string");
+        }
+        cursor_ += length;
+    }
+}
+
+[[noreturn]] void JsonParser::throwError() const {
+    throw std::runtime_error(error_.message);
+}
+
+JsonCursor::JsonCursor(std::string_view text, Skipping skipping)
+    : text_(text), validated_(skipping == Skipping::Validated) {
+    JsonParser parser(text);
+    parser.skipBom();
+    offset_ = parser.cursor_;
+    skipSpace();
+    if (offset_ >= text_.size()) {
+        error("Unexpected end of input while parsing value");
+    }
+}
+
+bool JsonCursor::readBool() {
+    JsonParser parser(text_);
+    parser.cursor_ = offset_;
+    bool value = false;
+    if (peek() == 't') {
+        if (!parser.scanLiteral("true", "Invalid literal, expected true")) {
+            error(parser.error_);
+        }
+        value = true;
+    } else if (peek() == 'f') {
+        if (!parser.scanLiteral("false", "Invalid literal, expected false")) {
+            error(parser.error_);
+        }
+    } else {
+        error("JSON value is not a boolean");
+    }
+    offset_ = parser.cursor_;
+    return value;
+}
+
+double JsonCursor::readNumber() {
+    return readDecimal().toDouble();
+}
+
+JsonNumber JsonCursor::readDecimal() {
+    if (!isNumber()) {
+        error("JSON value is not a number");
+    }
+    JsonParser parser(text_);
+    parser.cursor_ = offset_;
+    JsonNumber value;
+    if (!parser.scanNumber(value)) {
+        error(parser.error_);
+    }
+    offset_ = parser.cursor_;
+    return value;
+}
+
+std::string_view JsonCursor::readString(std::string& scratch) {
+    if (!isString()) {
+        error("JSON value is not a string");
+    }
+    const std::size_t start = offset_ + 1;
+    const std::size_t special = start + findJsonStringSpecial(text_.data() + start, text_.size() - start);
+    if (special < text_.size() && text_[special] == '"') {
+        const std::string_view plain = text_.substr(start, special - start);
+        if (!isValidUtf8(plain)) {
+            error("Invalid UTF-8 in string");
+        }
+        offset_ = special + 1;
+        return plain;
+    }
+    JsonParser parser(text_);
+    parser.cursor_ = offset_;
+    std::string_view value;
+    if (!parser.scanString(value)) {
+        error(parser.error_);
+    }
+    scratch.assign(value);
+    offset_ = parser.cursor_;
+    return scratch;
+}
+
+// Containers are skipped by counting brackets outside of strings; see the container kernels.
+// Mismatched bracket kinds are not detected. A validating cursor parses the value instead and
+// only drops what it decodes.
+void JsonCursor::skipValue() {
+    if (validated_) {
+        JsonParser parser(text_);
+        parser.cursor_ = offset_;
+        JsonHandler ignored;
+        if (!parser.parseValue(ignored)) {
+            error(parser.error_);
+        }
+        offset_ = parser.cursor_;
+        return;
+    }
+    const char first = peek();
+    if (first == '"') {
+        skipString();
+        return;
+    }
+    if (first != '{' && first != '[') {
+        while (offset_ < text_.size()) {
+            const char ch = text_[offset_];
+            if (ch == ',' || ch == '}' || ch == ']' || isJsonSpace(static_cast<unsigned char>(ch))) {
+                break;
             }
+            ++offset_;
         }
-        break;
+        return;
+    }
+    ContainerScan state;
+    offset_ += scanKernels().skipContainer(text_.data() + offset_, text_.size() - offset_, state);
+    if (state.depth != 0) {
+        error("Unterminated container in JSON input");
     }
 }
 
-[[noreturn]] void JsonParser::error(const char* message) const {
-    throw std::runtime_error(message);
+void JsonCursor::beginObject() {
+    if (!isObject()) {
+        error("JSON value is not an object");
+    }
+    ++offset_;
+    entered_ = true;
+    if (validated_) {
+        closers_.push_back('}');
+    }
 }
 
-} // namespace cashsloth
+bool JsonCursor::nextKey(std::string_view& key) {
+    if (!nextItem('}')) {
+        return false;
+    }
+    if (!isString()) {
+        error("Expected string key inside JSON object");
+    }
+    key = readString(keyScratch_);
+    skipSpace();
+    if (peek() != ':') {
+        error("Unexpected token while parsing JSON");
+    }
+    ++offset_;
+    skipSpace();
+    if (offset_ >= text_.size()) {
+        error("Unexpected end of input while parsing value");
+    }
+    return true;
+}
 
+bool JsonCursor::findKey(std::string_view key) {
+    std::string_view name;
+    while (nextKey(name)) {
+        if (name == key) {
+            return true;
+        }
+        skipValue();
+    }
+    return false;
+}
+
+void JsonCursor::beginArray() {
+    if (!isArray()) {
+        error("JSON value is not an array");
+    }
+    ++offset_;
+    entered_ = true;
+    if (validated_) {
+        closers_.push_back(']');
+    }
+}
+
+bool JsonCursor::nextElement() {
+    if (!nextItem(']')) {
+        return false;
+    }
+    if (offset_ >= text_.size()) {
+        error("Unexpected end of input while parsing value");
+    }
+    return true;
+}
+
+void JsonCursor::leaveContainer() {
+    if (validated_) {
+        if (closers_.empty()) {
+            error("No JSON container to leave");
+        }
+        if (closers_.back() == '}') {
+            std::string_view key;
+            while (nextKey(key)) {
+                skipValue();
+            }
+        } else {
+            while (nextElement()) {
+                skipValue();
+            }
+        }
+        return;
+    }
+    ContainerScan state;
+    state.depth = 1;
+    offset_ += scanKernels().skipContainer(text_.data() + offset_, text_.size() - offset_, state);
+    if (state.depth != 0) {
+        error("Unterminated container in JSON input");
+    }
+    entered_ = false;
+}
+
+// `entered_` is only set between opening a container and asking for its first item, which
+// is the one place where no comma is expected.
+bool JsonCursor::nextItem(char close) {
+    skipSpace();
+    if (peek() == close) {
+        ++offset_;
+        entered_ = false;
+        if (validated_) {
+            closers_.pop_back();
+        }
+        return false;
+    }
+    if (entered_) {
+        entered_ = false;
+    } else {
+        if (peek() != ',') {
+            error(offset_ >= text_.size() ? "Unexpected end of input while parsing value"
+                                          : "Unexpected token while parsing JSON");
+        }
+        ++offset_;
+    }
+    skipSpace();
+    return true;
+}
+
+// Jumps over a string without decoding it: only the closing quote matters, so the scan
+// stops at backslashes just long enough to step over the escaped byte.
+void JsonCursor::skipString() {
+    ++offset_;
+    while (offset_ < text_.size()) {
+        offset_ += findJsonStringSpecial(text_.data() + offset_, text_.size() - offset_);
+        if (offset_ >= text_.size()) {
+            break;
+        }
+        const char ch = text_[offset_];
+        if (ch == '"') {
+            ++offset_;
+            return;
+        }
+        offset_ += ch == '\\' ? 2 : 1;
+    }
+    error("Unterminated string in JSON input");
+}
+
+void JsonCursor::skipSpace() {
+    offset_ = skipJsonSpace(text_, offset_);
+}
+
+void JsonCursor::finish() {
+    skipSpace();
+    if (offset_ < text_.size()) {
+        error("Unexpected characters after JSON value");
+    }
+}
+
+[[noreturn]] void JsonCursor::error(const char* message) const {
+    throw JsonCursorError(message, offset_);
+}
+
+[[noreturn]] void JsonCursor::error(const JsonError& error) const {
+    throw JsonCursorError(error.message, error.offset);
+}
+
+} // namespace cashsloth
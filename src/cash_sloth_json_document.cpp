@@ -0,0 +1,160 @@
+#include "cash_sloth_json_document.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "cash_sloth_json.h"
+
+namespace {
+
+// Every value follows the start of the document, '[', ',' or ':' and every key follows '{'
+// or ','. Counting those bytes anywhere in the text (including inside strings) therefore
+// bounds the number of tape entries without a second parse.
+std::size_t countEntriesUpperBound(std::string_view text) {
+    std::size_t count = 1;
+    for (char ch : text) {
+        count += (ch == '[' || ch == '{' || ch == ',' || ch == ':') ? 1 : 0;
+    }
+    return count;
+}
+
+constexpr std::uint64_t kNoContainer = std::numeric_limits<std::uint64_t>::max();
+constexpr std::size_t kArenaBlockSize = 4096;
+
+}  // namespace
+
+namespace cashsloth {
+
+// Writes parser events onto the preallocated tape. Open containers are chained through
+// their payload field (pointing at the enclosing container) until they close, so no
+// separate stack is needed while building. String bytes go to the preallocated pool, or in
+// in-place mode are referenced in `source` when the parser handed out a view into it.
+class JsonTapeBuilder : public JsonHandler {
+public:
+    JsonTapeBuilder(JsonDocument& document, JsonDocument::Entry* entries, char* pool, std::size_t poolSize,
+                    std::string_view source)
+        : document_(document), entries_(entries), poolCursor_(pool), poolEnd_(pool + poolSize), source_(source) {}
+
+    void onNull() override { pushValue(JsonDocument::Type::Null, 0, 0); }
+    void onBool(bool value) override {
+        pushValue(value ? JsonDocument::Type::True : JsonDocument::Type::False, 0, 0);
+    }
+    void onNumber(double value) override {
+        pushValue(JsonDocument::Type::Number, 0, std::bit_cast<std::uint64_t>(value));
+    }
+    void onString(std::string_view value) override {
+        const std::uint64_t address = appendString(value);
+        pushValue(JsonDocument::Type::String, static_cast<std::uint32_t>(value.size()), address);
+    }
+    void onKey(std::string_view key) override {
+        ++entries_[open_].size;
+        const std::uint64_t address = appendString(key);
+        entries_[count_++] = {JsonDocument::Type::String, static_cast<std::uint32_t>(key.size()), address};
+    }
+    void onStartObject() override { openContainer(JsonDocument::Type::Object); }
+    void onStartArray() override { openContainer(JsonDocument::Type::Array); }
+    void onEndObject() override { closeContainer(); }
+    void onEndArray() override { closeContainer(); }
+
+private:
+    void countArrayElement() {
+        if (open_ != kNoContainer && entries_[open_].type == JsonDocument::Type::Array) {
+            ++entries_[open_].size;
+        }
+    }
+
+    void pushValue(JsonDocument::Type type, std::uint32_t size, std::uint64_t payload) {
+        countArrayElement();
+        entries_[count_++] = {type, size, payload};
+    }
+
+    void openContainer(JsonDocument::Type type) {
+        countArrayElement();
+        entries_[count_] = {type, 0, open_};
+        open_ = count_++;
+    }
+
+    void closeContainer() {
+        JsonDocument::Entry& container = entries_[open_];
+        open_ = container.payload;
+        container.payload = count_;
+    }
+
+    std::uint64_t appendString(std::string_view value) {
+        if (value.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("JSON string too long for document storage");
+        }
+        const char* bytes = value.data();
+        if (!source_.empty() && bytes >= source_.data() && bytes < source_.data() + source_.size()) {
+            return reinterpret_cast<std::uintptr_t>(bytes);
+        }
+        if (static_cast<std::size_t>(poolEnd_ - poolCursor_) < value.size()) {
+            const std::size_t blockSize = std::max(kArenaBlockSize, value.size());
+            document_.arena_.push_back(std::make_unique_for_overwrite<char[]>(blockSize));
+            poolCursor_ = document_.arena_.back().get();
+            poolEnd_ = poolCursor_ + blockSize;
+        }
+        char* target = poolCursor_;
+        value.copy(target, value.size());
+        poolCursor_ += value.size();
+        return reinterpret_cast<std::uintptr_t>(target);
+    }
+
+    JsonDocument& document_;
+    JsonDocument::Entry* entries_;
+    char* poolCursor_;
+    char* poolEnd_;
+    std::string_view source_;
+    std::size_t count_ = 0;
+    std::uint64_t open_ = kNoContainer;
+};
+
+JsonDocument JsonDocument::parse(std::string_view text) {
+    JsonResult<JsonDocument> result = build(text, false);
+    if (!result) {
+        throw std::runtime_error(result.error().message);
+    }
+    return std::move(*result);
+}
+
+JsonDocument JsonDocument::parseInPlace(std::string_view text) {
+    JsonResult<JsonDocument> result = build(text, true);
+    if (!result) {
+        throw std::runtime_error(result.error().message);
+    }
+    return std::move(*result);
+}
+
+JsonResult<JsonDocument> JsonDocument::tryParse(std::string_view text) {
+    return build(text, false);
+}
+
+JsonResult<JsonDocument> JsonDocument::tryParseInPlace(std::string_view text) {
+    return build(text, true);
+}
+
+JsonResult<JsonDocument> JsonDocument::build(std::string_view text, bool inPlace) {
+    // Decoded strings are never longer than their escaped source, so the text size bounds
+    // the string pool as well. In-place documents only copy escaped strings and leave
+    // those to the arena instead.
+    const std::size_t entryCapacity = countEntriesUpperBound(text);
+    const std::size_t entryBytes = entryCapacity * sizeof(Entry);
+    const std::size_t poolBytes = inPlace ? 0 : text.size();
+
+    JsonDocument document;
+    document.storage_ = std::make_unique_for_overwrite<unsigned char[]>(entryBytes + poolBytes + 1);
+    auto* entries = reinterpret_cast<Entry*>(document.storage_.get());
+    auto* pool = reinterpret_cast<char*>(document.storage_.get() + entryBytes);
+
+    JsonTapeBuilder builder(document, entries, pool, poolBytes, inPlace ? text : std::string_view());
+    JsonParser parser(text);
+    if (std::optional<JsonError> error = parser.tryParse(builder)) {
+        return *error;
+    }
+
+    document.entries_ = entries;
+    return document;
+}
+
+} // namespace cashsloth
@@ -0,0 +1,149 @@
+#include "cash_sloth_json_lines.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+bool isBlankLine(std::string_view line) {
+    return std::all_of(line.begin(), line.end(), [](char ch) { return ch == ' ' || ch == '\t' || ch == '\r'; });
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+JsonLinesReader::JsonLinesReader(std::istream& input, std::size_t chunkSize, std::size_t maxRecordSize)
+    : input_(&input), chunkSize_(std::max<std::size_t>(chunkSize, 1)), maxRecordSize_(maxRecordSize) {}
+
+JsonLinesReader::JsonLinesReader(const std::filesystem::path& path, std::size_t chunkSize, std::size_t maxRecordSize)
+    : ownedInput_(std::make_unique<std::ifstream>(path, std::ios::binary)),
+      chunkSize_(std::max<std::size_t>(chunkSize, 1)),
+      maxRecordSize_(maxRecordSize) {
+    if (*ownedInput_) {
+        input_ = ownedInput_.get();
+    }
+}
+
+JsonLinesReader::~JsonLinesReader() = default;
+
+bool JsonLinesReader::next(JsonValue& record) {
+    std::string_view line;
+    while (nextLine(line)) {
+        if (isBlankLine(line)) {
+            continue;
+        }
+        JsonResult<JsonValue> parsed = JsonParser(line).tryParse();
+        if (!parsed) {
+            recordError(parsed.error().message);
+        }
+        record = std::move(*parsed);
+        return true;
+    }
+    return false;
+}
+
+bool JsonLinesReader::next(JsonHandler& handler) {
+    std::string_view line;
+    while (nextLine(line)) {
+        if (isBlankLine(line)) {
+            continue;
+        }
+        if (const std::optional<JsonError> error = JsonParser(line).tryParse(handler)) {
+            recordError(error->message);
+        }
+        return true;
+    }
+    return false;
+}
+
+// The line returned stays valid until the next call. A line that runs past the record limit
+// is reported once and then dropped up to its newline, so the buffer never grows beyond the
+// limit plus one chunk.
+bool JsonLinesReader::nextLine(std::string_view& line) {
+    if (!input_) {
+        return false;
+    }
+    while (true) {
+        const char* data = buffer_.data();
+        const void* newline = scanned_ < end_ ? std::memchr(data + scanned_, '\n', end_ - scanned_) : nullptr;
+        if (newline) {
+            const std::size_t lineEnd = static_cast<std::size_t>(static_cast<const char*>(newline) - data);
+            const std::size_t lineBegin = begin_;
+            begin_ = lineEnd + 1;
+            scanned_ = begin_;
+            if (skippingLongLine_) {
+                skippingLongLine_ = false;
+                ++nextLineNumber_;
+                continue;
+            }
+            lineNumber_ = nextLineNumber_++;
+            if (lineEnd - lineBegin > maxRecordSize_) {
+                recordError("Record exceeds the maximum size");
+            }
+            line = std::string_view(data + lineBegin, lineEnd - lineBegin);
+            return true;
+        }
+        scanned_ = end_;
+        if (skippingLongLine_) {
+            begin_ = end_;
+        } else if (end_ - begin_ > maxRecordSize_) {
+            begin_ = end_;
+            skippingLongLine_ = true;
+            lineNumber_ = nextLineNumber_;
+            recordError("Record exceeds the maximum size");
+        }
+        if (!fill()) {
+            break;
+        }
+    }
+    if (skippingLongLine_) {
+        skippingLongLine_ = false;
+        ++nextLineNumber_;
+        return false;
+    }
+    if (begin_ == end_) {
+        return false;
+    }
+    // The last line may end without a newline.
+    line = std::string_view(buffer_.data() + begin_, end_ - begin_);
+    begin_ = end_;
+    scanned_ = end_;
+    lineNumber_ = nextLineNumber_++;
+    if (line.size() > maxRecordSize_) {
+        recordError("Record exceeds the maximum size");
+    }
+    return true;
+}
+
+// Moves the unfinished line to the front of the buffer and appends one chunk behind it.
+bool JsonLinesReader::fill() {
+    if (eof_) {
+        return false;
+    }
+    if (begin_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        scanned_ -= begin_;
+        begin_ = 0;
+    }
+    if (buffer_.size() < end_ + chunkSize_) {
+        buffer_.resize(end_ + chunkSize_);
+    }
+    input_->read(buffer_.data() + end_, static_cast<std::streamsize>(chunkSize_));
+    const std::size_t count = static_cast<std::size_t>(input_->gcount());
+    end_ += count;
+    if (!*input_) {
+        eof_ = true;
+    }
+    return count > 0;
+}
+
+[[noreturn]] void JsonLinesReader::recordError(const char* message) const {
+    throw std::runtime_error("JSON Lines record in line " + std::to_string(lineNumber_) + ": " + message);
+}
+
+} // namespace cashsloth
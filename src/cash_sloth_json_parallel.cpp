@@ -0,0 +1,230 @@
+#include "cash_sloth_json_parallel.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "cash_sloth_thread_pool.h"
+
+namespace {
+
+using cashsloth::JsonParser;
+using cashsloth::JsonStructuralIndex;
+using cashsloth::JsonValue;
+
+// Below this size a document or subtree is not worth cutting up.
+constexpr std::size_t kParallelMinBytes = 256 * 1024;
+// Target number of element runs per thread, so uneven elements still balance out.
+constexpr std::size_t kRunsPerThread = 4;
+
+bool isSpace(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+bool startsWithBom(std::string_view text) {
+    return text.size() >= 3 && static_cast<unsigned char>(text[0]) == 0xEF &&
+           static_cast<unsigned char>(text[1]) == 0xBB && static_cast<unsigned char>(text[2]) == 0xBF;
+}
+
+// Strips JSON whitespace and the byte order marks the parser tolerates between tokens.
+std::string_view trimSpan(std::string_view span) {
+    while (!span.empty()) {
+        if (isSpace(span.front())) {
+            span.remove_prefix(1);
+        } else if (startsWithBom(span)) {
+            span.remove_prefix(3);
+        } else {
+            break;
+        }
+    }
+    while (!span.empty()) {
+        if (isSpace(span.back())) {
+            span.remove_suffix(1);
+        } else if (span.size() >= 3 && startsWithBom(span.substr(span.size() - 3))) {
+            span.remove_suffix(3);
+        } else {
+            break;
+        }
+    }
+    return span;
+}
+
+std::string_view nonEmptySpan(std::string_view text, std::size_t begin, std::size_t end) {
+    const std::string_view span = trimSpan(text.substr(begin, end - begin));
+    if (span.empty()) {
+        throw std::runtime_error("Unexpected end of input while parsing value");
+    }
+    return span;
+}
+
+class ParallelParser {
+public:
+    ParallelParser(const JsonStructuralIndex& index, cashsloth::ThreadPool& pool) : index_(index), pool_(pool) {}
+
+    JsonValue parse(std::string_view span) {
+        if (span.size() < kParallelMinBytes || (span.front() != '[' && span.front() != '{')) {
+            return JsonParser(span).parse();
+        }
+        const std::size_t offset = static_cast<std::size_t>(span.data() - index_.text().data());
+        if (index_.containerEnd(offset) != offset + span.size()) {
+            throw std::runtime_error("Unexpected characters after JSON value");
+        }
+        if (span.front() == '{') {
+            return parseObject(offset);
+        }
+        return parseArray(offset);
+    }
+
+private:
+    JsonValue parseObject(std::size_t offset) {
+        JsonValue::Object object;
+        for (const auto& [keyText, valueText] : index_.objectMembers(offset)) {
+            JsonValue key = JsonParser(keyText).parse();
+            if (!key.isString()) {
+                throw std::runtime_error("Expected string key inside JSON object");
+            }
+            std::string name = key.asString();
+            object.emplace(std::move(name), parse(valueText));
+        }
+        return JsonValue(std::move(object));
+    }
+
+    JsonValue parseArray(std::size_t offset) {
+        const std::vector<std::string_view> elements = index_.arrayElements(offset);
+        const std::size_t threads = pool_.concurrency();
+        JsonValue::Array array(elements.size());
+        if (elements.size() < threads * 2) {
+            // Too few elements to share; look for large arrays inside them instead.
+            for (std::size_t i = 0; i < elements.size(); ++i) {
+                array[i] = parse(elements[i]);
+            }
+            return JsonValue(std::move(array));
+        }
+        const std::size_t runs = std::min(elements.size(), threads * kRunsPerThread);
+        pool_.parallelFor(runs, [&](std::size_t run) {
+            const std::size_t first = elements.size() * run / runs;
+            const std::size_t last = elements.size() * (run + 1) / runs;
+            for (std::size_t i = first; i < last; ++i) {
+                array[i] = JsonParser(elements[i]).parse();
+            }
+        });
+        return JsonValue(std::move(array));
+    }
+
+    const JsonStructuralIndex& index_;
+    cashsloth::ThreadPool& pool_;
+};
+
+}  // namespace
+
+namespace cashsloth {
+
+JsonStructuralIndex::JsonStructuralIndex(std::string_view text) : text_(text) {
+    if (text.size() >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("JSON input too large for structural index");
+    }
+    if (!buildJsonStructuralIndex(text, positions_)) {
+        throw std::runtime_error("Unterminated string in JSON input");
+    }
+}
+
+std::vector<std::string_view> JsonStructuralIndex::arrayElements(std::size_t open) const {
+    std::vector<std::size_t> separators;
+    const std::size_t close = positions_[findSeparators(open, separators)];
+    if (text_[open] != '[') {
+        throw std::runtime_error("Unexpected token while parsing JSON");
+    }
+    std::vector<std::string_view> elements;
+    if (separators.empty() && trimSpan(text_.substr(open + 1, close - open - 1)).empty()) {
+        return elements;
+    }
+    elements.reserve(separators.size() + 1);
+    std::size_t begin = open + 1;
+    for (std::size_t separator : separators) {
+        if (text_[separator] != ',') {
+            throw std::runtime_error("Unexpected token while parsing JSON");
+        }
+        elements.push_back(nonEmptySpan(text_, begin, separator));
+        begin = separator + 1;
+    }
+    elements.push_back(nonEmptySpan(text_, begin, close));
+    return elements;
+}
+
+std::vector<std::pair<std::string_view, std::string_view>> JsonStructuralIndex::objectMembers(std::size_t open) const {
+    std::vector<std::size_t> separators;
+    const std::size_t close = positions_[findSeparators(open, separators)];
+    if (text_[open] != '{') {
+        throw std::runtime_error("Unexpected token while parsing JSON");
+    }
+    std::vector<std::pair<std::string_view, std::string_view>> members;
+    if (separators.empty() && trimSpan(text_.substr(open + 1, close - open - 1)).empty()) {
+        return members;
+    }
+    // Separators must alternate ':' and ',' and end on a ':' followed by the last value.
+    if (separators.size() % 2 == 0) {
+        throw std::runtime_error("Unexpected token while parsing JSON");
+    }
+    members.reserve(separators.size() / 2 + 1);
+    std::size_t begin = open + 1;
+    for (std::size_t i = 0; i < separators.size(); i += 2) {
+        const std::size_t colon = separators[i];
+        const std::size_t end = i + 1 < separators.size() ? separators[i + 1] : close;
+        if (text_[colon] != ':' || (end != close && text_[end] != ',')) {
+            throw std::runtime_error("Unexpected token while parsing JSON");
+        }
+        members.emplace_back(nonEmptySpan(text_, begin, colon), nonEmptySpan(text_, colon + 1, end));
+        begin = end + 1;
+    }
+    return members;
+}
+
+std::size_t JsonStructuralIndex::containerEnd(std::size_t open) const {
+    std::vector<std::size_t> separators;
+    return positions_[findSeparators(open, separators)] + 1;
+}
+
+std::size_t JsonStructuralIndex::findSeparators(std::size_t open, std::vector<std::size_t>& separators) const {
+    const auto first = std::lower_bound(positions_.begin(), positions_.end(), static_cast<std::uint32_t>(open));
+    if (first == positions_.end() || *first != open) {
+        throw std::runtime_error("Unexpected token while parsing JSON");
+    }
+    std::string expected;
+    for (auto it = first; it != positions_.end(); ++it) {
+        const char ch = text_[*it];
+        if (ch == '{' || ch == '[') {
+            expected.push_back(ch == '{' ? '}' : ']');
+        } else if (ch == '}' || ch == ']') {
+            if (expected.empty() || expected.back() != ch) {
+                throw std::runtime_error("Unexpected token while parsing JSON");
+            }
+            expected.pop_back();
+            if (expected.empty()) {
+                return static_cast<std::size_t>(it - positions_.begin());
+            }
+        } else if (expected.size() == 1) {
+            separators.push_back(*it);
+        }
+    }
+    throw std::runtime_error("Unexpected end of input while parsing value");
+}
+
+JsonValue parseJsonParallel(std::string_view text, ThreadPool& pool) {
+    if (text.size() < kParallelMinBytes || pool.concurrency() < 2) {
+        return JsonParser(text).parse();
+    }
+    try {
+        const JsonStructuralIndex index(text);
+        const std::string_view root = trimSpan(text);
+        if (root.empty() || (root.front() != '[' && root.front() != '{')) {
+            return JsonParser(text).parse();
+        }
+        return ParallelParser(index, pool).parse(root);
+    } catch (const std::exception&) {
+        // Report malformed input exactly as the serial parser does.
+        return JsonParser(text).parse();
+    }
+}
+
+} // namespace cashsloth
@@ -0,0 +1,258 @@
+#include "cash_sloth_json_writer.h"
+
+#include <charconv>
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+
+namespace {
+
+constexpr std::size_t kStreamFlushThreshold = 64 * 1024;
+// Exact decimals with more fraction digits than this are written in exponent form.
+constexpr int kMaxPlainFractionDigits = 30;
+
+const char* shortEscape(unsigned char ch) {
+    switch (ch) {
+        case '"': return "\\\"";
+        case '\\': return "\\\\";
+        case '\b': return "\\b";
+        case '\f': return "\\f";
+        case '\n': return "\\n";
+        case '\r': return "\\r";
+        case '\t': return "\\t";
+        default: return nullptr;
+    }
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+JsonWriter::JsonWriter(std::string& buffer, int indent)
+    : out_(&buffer), indent_(indent) {}
+
+JsonWriter::JsonWriter(std::ostream& stream, int indent)
+    : out_(&staging_), stream_(&stream), indent_(indent) {
+    staging_.reserve(kStreamFlushThreshold * 2);
+}
+
+JsonWriter::~JsonWriter() {
+    flush();
+}
+
+void JsonWriter::beginObject() {
+    beforeValue();
+    out_->push_back('{');
+    hasElements_.push_back(false);
+}
+
+void JsonWriter::endObject() {
+    const bool nonEmpty = hasElements_.back();
+    hasElements_.pop_back();
+    if (nonEmpty) {
+        newline();
+    }
+    out_->push_back('}');
+    maybeFlush();
+}
+
+void JsonWriter::beginArray() {
+    beforeValue();
+    out_->push_back('[');
+    hasElements_.push_back(false);
+}
+
+void JsonWriter::endArray() {
+    const bool nonEmpty = hasElements_.back();
+    hasElements_.pop_back();
+    if (nonEmpty) {
+        newline();
+    }
+    out_->push_back(']');
+    maybeFlush();
+}
+
+void JsonWriter::key(std::string_view name) {
+    if (hasElements_.back()) {
+        out_->push_back(',');
+    }
+    hasElements_.back() = true;
+    newline();
+    appendEscaped(name);
+    out_->push_back(':');
+    if (indent_ > 0) {
+        out_->push_back(' ');
+    }
+    afterKey_ = true;
+}
+
+void JsonWriter::value(std::string_view text) {
+    beforeValue();
+    appendEscaped(text);
+    maybeFlush();
+}
+
+void JsonWriter::value(double number) {
+    if (!std::isfinite(number)) {
+        nullValue();
+        return;
+    }
+    beforeValue();
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out_->append(buffer, result.ptr);
+    maybeFlush();
+}
+
+void JsonWriter::value(std::int64_t number) {
+    beforeValue();
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out_->append(buffer, result.ptr);
+    maybeFlush();
+}
+
+void JsonWriter::value(bool flag) {
+    beforeValue();
+    out_->append(flag ? "true" : "false");
+    maybeFlush();
+}
+
+// Exact decimals keep their scale, so a price read as "3.50" is written back as "3.50".
+void JsonWriter::value(const JsonNumber& number) {
+    if (!number.isExact()) {
+        value(number.toDouble());
+        return;
+    }
+    // The sign comes from the double so that -0 survives the zero mantissa.
+    const std::int64_t mantissa = number.mantissa();
+    const int exponent = number.exponent();
+    const bool negative = std::signbit(number.toDouble());
+    const std::uint64_t magnitude = mantissa < 0 ? 0 - static_cast<std::uint64_t>(mantissa)
+                                                 : static_cast<std::uint64_t>(mantissa);
+    beforeValue();
+    if (negative) {
+        out_->push_back('-');
+    }
+    char buffer[48];
+    char* end = buffer;
+    if (exponent >= 0 || exponent < -kMaxPlainFractionDigits) {
+        out_->append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), magnitude).ptr);
+        if (exponent != 0) {
+            out_->push_back('e');
+            out_->append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), exponent).ptr);
+        }
+    } else {
+        char digits[24];
+        char* digitsEnd = std::to_chars(digits, digits + sizeof(digits), magnitude).ptr;
+        const std::size_t count = static_cast<std::size_t>(digitsEnd - digits);
+        const std::size_t scale = static_cast<std::size_t>(-exponent);
+        if (count <= scale) {
+            *end++ = '0';
+            *end++ = '.';
+            end = std::fill_n(end, scale - count, '0');
+            end = std::copy(digits, digitsEnd, end);
+        } else {
+            end = std::copy(digits, digitsEnd - scale, end);
+            *end++ = '.';
+            end = std::copy(digitsEnd - scale, digitsEnd, end);
+        }
+    }
+    out_->append(buffer, end);
+    maybeFlush();
+}
+
+void JsonWriter::nullValue() {
+    beforeValue();
+    out_->append("null");
+    maybeFlush();
+}
+
+void JsonWriter::write(const JsonValue& value) {
+    if (value.isNull()) {
+        nullValue();
+    } else if (value.isBool()) {
+        this->value(value.asBool());
+    } else if (value.isNumber()) {
+        this->value(value.asDecimal());
+    } else if (value.isString()) {
+        this->value(std::string_view(value.asString()));
+    } else if (value.isArray()) {
+        beginArray();
+        for (const JsonValue& element : value.asArray()) {
+            write(element);
+        }
+        endArray();
+    } else {
+        beginObject();
+        for (const auto& [name, member] : value.asObject()) {
+            key(name);
+            write(member);
+        }
+        endObject();
+    }
+}
+
+void JsonWriter::reset() {
+    hasElements_.clear();
+    afterKey_ = false;
+}
+
+void JsonWriter::flush() {
+    if (stream_ && !staging_.empty()) {
+        stream_->write(staging_.data(), static_cast<std::streamsize>(staging_.size()));
+        staging_.clear();
+    }
+}
+
+void JsonWriter::beforeValue() {
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (hasElements_.empty()) {
+        return;
+    }
+    if (hasElements_.back()) {
+        out_->push_back(',');
+    }
+    hasElements_.back() = true;
+    newline();
+}
+
+void JsonWriter::newline() {
+    if (indent_ <= 0) {
+        return;
+    }
+    out_->push_back('\n');
+    out_->append(hasElements_.size() * static_cast<std::size_t>(indent_), ' ');
+}
+
+void JsonWriter::appendEscaped(std::string_view text) {
+    out_->push_back('"');
+    while (!text.empty()) {
+        const std::size_t run = findJsonStringSpecial(text.data(), text.size());
+        out_->append(text.data(), run);
+        if (run == text.size()) {
+            break;
+        }
+        const unsigned char ch = static_cast<unsigned char>(text[run]);
+        if (const char* escape = shortEscape(ch)) {
+            out_->append(escape);
+        } else {
+            static constexpr char kHex[] = "0123456789abcdef";
+            const char unicode[] = {'\\', 'u', '0', '0', kHex[ch >> 4], kHex[ch & 0x0F]};
+            out_->append(unicode, sizeof(unicode));
+        }
+        text.remove_prefix(run + 1);
+    }
+    out_->push_back('"');
+}
+
+void JsonWriter::maybeFlush() {
+    if (stream_ && staging_.size() >= kStreamFlushThreshold) {
+        flush();
+    }
+}
+
+} // namespace cashsloth
@@ -0,0 +1,153 @@
+#include "cash_sloth_mapped_file.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cashsloth {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    HANDLE file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX) {
+        CloseHandle(file);
+        return;
+    }
+    size_ = static_cast<std::size_t>(fileSize.QuadPart);
+    if (size_ == 0) {
+        // Zero-length files cannot be mapped.
+        CloseHandle(file);
+        open_ = true;
+        return;
+    }
+    // The view keeps the mapping alive on its own, so both handles can be closed right away.
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) {
+        mapping_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    if (mapping_) {
+        data_ = static_cast<const char*>(mapping_);
+        open_ = true;
+        return;
+    }
+    open_ = readAll(path);
+}
+
+void MappedFile::release() {
+    if (mapping_) {
+        UnmapViewOfFile(mapping_);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return;
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ == 0) {
+        ::close(fd);
+        open_ = true;
+        return;
+    }
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping != MAP_FAILED) {
+        // Loaders read the file front to back exactly once.
+        ::madvise(mapping, size_, MADV_SEQUENTIAL);
+        mapping_ = mapping;
+        data_ = static_cast<const char*>(mapping);
+        open_ = true;
+        return;
+    }
+    open_ = readAll(path);
+}
+
+void MappedFile::release() {
+    if (mapping_) {
+        ::munmap(mapping_, size_);
+    }
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      mapping_(std::exchange(other.mapping_, nullptr)),
+      buffer_(std::move(other.buffer_)),
+      open_(std::exchange(other.open_, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        buffer_ = std::move(other.buffer_);
+        open_ = std::exchange(other.open_, false);
+    }
+    return *this;
+}
+
+// Fallback for files that cannot be mapped: one allocation sized from the file and as few
+// read calls as the C library needs to fill it.
+bool MappedFile::readAll(const std::filesystem::path& path) {
+#ifdef _WIN32
+    std::FILE* file = _wfopen(path.c_str(), L"rb");
+#else
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+#endif
+    if (!file) {
+        return false;
+    }
+    buffer_ = std::make_unique_for_overwrite<char[]>(size_);
+    const std::size_t read = std::fread(buffer_.get(), 1, size_, file);
+    std::fclose(file);
+    if (read != size_) {
+        buffer_.reset();
+        size_ = 0;
+        return false;
+    }
+    data_ = buffer_.get();
+    return true;
+}
+
+} // namespace cashsloth
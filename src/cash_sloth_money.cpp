@@ -0,0 +1,231 @@
+#include "cash_sloth_money.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::int64_t kMax = std::numeric_limits<std::int64_t>::max();
+constexpr std::int64_t kMin = std::numeric_limits<std::int64_t>::min();
+
+[[noreturn]] void overflow() {
+    throw std::overflow_error("Amount out of range");
+}
+
+bool isSpace(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\v' || ch == '\f';
+}
+
+bool isDigit(char ch) {
+    return ch >= '0' && ch <= '9';
+}
+
+std::string_view trimmed(std::string_view text) {
+    while (!text.empty() && isSpace(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && isSpace(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool isCurrencyCode(std::string_view text) {
+    return text.size() == 3 && (text[0] | 0x20) == 'c' && (text[1] | 0x20) == 'h' && (text[2] | 0x20) == 'f';
+}
+
+// "CHF" in front of or behind the amount is dropped.
+std::string_view withoutCurrency(std::string_view text) {
+    text = trimmed(text);
+    if (text.size() >= 3 && isCurrencyCode(text.substr(0, 3))) {
+        text.remove_prefix(3);
+    } else if (text.size() >= 3 && isCurrencyCode(text.substr(text.size() - 3))) {
+        text.remove_suffix(3);
+    }
+    return text;
+}
+
+// Digits are written from the back, so no intermediate string is needed. The magnitude is
+// taken as unsigned, which keeps INT64_MIN from overflowing.
+template <typename Char>
+std::size_t formatRappen(std::int64_t rappen, Char* out) {
+    Char digits[24];
+    std::size_t count = 0;
+    std::uint64_t magnitude = rappen < 0 ? 0 - static_cast<std::uint64_t>(rappen) : static_cast<std::uint64_t>(rappen);
+    do {
+        digits[count++] = static_cast<Char>('0' + magnitude % 10);
+        magnitude /= 10;
+        if (count == 2) {
+            digits[count++] = static_cast<Char>('.');
+        }
+    } while (magnitude != 0 || count < 4);
+
+    std::size_t length = 0;
+    if (rappen < 0) {
+        out[length++] = static_cast<Char>('-');
+    }
+    while (count != 0) {
+        out[length++] = digits[--count];
+    }
+    return length;
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+// Scaling up multiplies by ten per step; scaling down divides once by the power of ten and
+// rounds on the remainder. 10^19 still fits an unsigned magnitude, and anything scaled down
+// further is below half a Rappen.
+std::optional<Money> Money::fromDecimal(std::int64_t mantissa, int exponent) {
+    if (mantissa == 0) {
+        return Money();
+    }
+    const long long shift = static_cast<long long>(exponent) + 2;
+    if (shift >= 0) {
+        std::int64_t result = mantissa;
+        for (long long i = 0; i < shift; ++i) {
+            if (result > kMax / 10 || result < kMin / 10) {
+                return std::nullopt;
+            }
+            result *= 10;
+        }
+        return Money(result);
+    }
+    if (shift < -19) {
+        return Money();
+    }
+    std::uint64_t divisor = 1;
+    for (long long i = shift; i < 0; ++i) {
+        divisor *= 10;
+    }
+    const bool negative = mantissa < 0;
+    const std::uint64_t magnitude = negative ? 0 - static_cast<std::uint64_t>(mantissa) : static_cast<std::uint64_t>(mantissa);
+    std::uint64_t quotient = magnitude / divisor;
+    const std::uint64_t remainder = magnitude % divisor;
+    if (remainder >= divisor - remainder) {
+        ++quotient;
+    }
+    const std::int64_t rappen = static_cast<std::int64_t>(quotient);
+    return Money(negative ? -rappen : rappen);
+}
+
+// One pass over the characters: a sign, the francs with optional apostrophes between digits,
+// and after a point or comma the Rappen. The third decimal decides the rounding; later ones
+// only have to be digits. Negative amounts reach one Rappen further than positive ones, so
+// that everything format() writes reads back.
+std::optional<Money> Money::parse(std::string_view text) {
+    text = withoutCurrency(text);
+    bool negative = false;
+    bool sawDigit = false;
+    bool sawSeparator = false;
+    bool roundUp = false;
+    int decimals = 0;
+    char previous = '\0';
+    std::uint64_t rappen = 0;
+    std::uint64_t limit = static_cast<std::uint64_t>(kMax);
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const char ch = text[i];
+        if (isSpace(ch)) {
+            continue;
+        }
+        if ((ch == '-' || ch == '+') && !sawDigit && !sawSeparator && previous == '\0') {
+            negative = ch == '-';
+            limit = static_cast<std::uint64_t>(kMax) + (negative ? 1 : 0);
+        } else if (isDigit(ch)) {
+            const std::uint64_t digit = static_cast<std::uint64_t>(ch - '0');
+            if (!sawSeparator) {
+                if (rappen > (limit - digit * 100) / 10) {
+                    return std::nullopt;
+                }
+                rappen = rappen * 10 + digit * 100;
+            } else if (decimals == 0) {
+                rappen += digit * 10;
+            } else if (decimals == 1) {
+                rappen += digit;
+            } else if (decimals == 2) {
+                roundUp = digit >= 5;
+            }
+            if (sawSeparator) {
+                ++decimals;
+            }
+            sawDigit = true;
+        } else if ((ch == '.' || ch == ',') && !sawSeparator) {
+            sawSeparator = true;
+        } else if (ch == '\'' && !sawSeparator && isDigit(previous) && i + 1 < text.size() && isDigit(text[i + 1])) {
+            // A thousands separator, as in 1'250.
+        } else {
+            return std::nullopt;
+        }
+        previous = ch;
+    }
+    if (!sawDigit || rappen > limit) {
+        return std::nullopt;
+    }
+    if (roundUp) {
+        if (rappen == limit) {
+            return std::nullopt;
+        }
+        ++rappen;
+    }
+    return Money(static_cast<std::int64_t>(negative ? 0 - rappen : rappen));
+}
+
+Money Money::roundedToFiveRappen() const {
+    const std::int64_t remainder = rappen_ % 5;
+    if (remainder >= 3) {
+        return *this + Money(5 - remainder);
+    }
+    if (remainder <= -3) {
+        return *this - Money(5 + remainder);
+    }
+    return Money(rappen_ - remainder);
+}
+
+std::size_t Money::format(char* out) const {
+    return formatRappen(rappen_, out);
+}
+
+std::size_t Money::format(char16_t* out) const {
+    return formatRappen(rappen_, out);
+}
+
+Money& Money::operator+=(Money other) {
+    if ((other.rappen_ > 0 && rappen_ > kMax - other.rappen_) || (other.rappen_ < 0 && rappen_ < kMin - other.rappen_)) {
+        overflow();
+    }
+    rappen_ += other.rappen_;
+    return *this;
+}
+
+Money& Money::operator-=(Money other) {
+    if ((other.rappen_ < 0 && rappen_ > kMax + other.rappen_) || (other.rappen_ > 0 && rappen_ < kMin + other.rappen_)) {
+        overflow();
+    }
+    rappen_ -= other.rappen_;
+    return *this;
+}
+
+Money Money::operator-() const {
+    if (rappen_ == kMin) {
+        overflow();
+    }
+    return Money(-rappen_);
+}
+
+// The product is checked on magnitudes, which keeps the sign cases together; a result of
+// exactly INT64_MIN is reported as an overflow as well.
+Money operator*(Money amount, std::int64_t quantity) {
+    const auto magnitude = [](std::int64_t value) {
+        return value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+    };
+    const std::uint64_t left = magnitude(amount.rappen_);
+    const std::uint64_t right = magnitude(quantity);
+    if (right != 0 && left > static_cast<std::uint64_t>(kMax) / right) {
+        overflow();
+    }
+    const std::int64_t product = static_cast<std::int64_t>(left * right);
+    return Money((amount.rappen_ < 0) != (quantity < 0) ? -product : product);
+}
+
+} // namespace cashsloth
@@ -0,0 +1,158 @@
+#include "cash_sloth_scanner_input.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "cash_sloth_catalogue.h"
+
+namespace {
+
+bool isTerminator(char16_t unit) {
+    return unit == u'\r' || unit == u'\n' || unit == u'\t';
+}
+
+// Barcodes are printable ASCII without spaces.
+bool isCodeUnit(char16_t unit) {
+    return unit > u' ' && unit < 0x7F;
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+void BurstDetector::feed(const Keystroke& key, ScannerOutput& output) {
+    if (!held_.empty() && key.timeMicros - lastMicros_ > settings_.maxGapMicros) {
+        settle(output);
+    }
+    lastMicros_ = key.timeMicros;
+    if (isTerminator(key.unit)) {
+        // The suffix of a scan is swallowed; after typing it is passed on like any key.
+        const bool scanned = held_.size() >= settings_.minLength && std::all_of(held_.begin(), held_.end(), isCodeUnit);
+        settle(output);
+        if (!scanned) {
+            output.typed.push_back(key.unit);
+        }
+        return;
+    }
+    held_.push_back(key.unit);
+}
+
+void BurstDetector::flush(std::uint64_t nowMicros, ScannerOutput& output) {
+    if (!held_.empty() && nowMicros - lastMicros_ > settings_.maxGapMicros) {
+        settle(output);
+    }
+}
+
+std::optional<std::uint64_t> BurstDetector::deadline() const {
+    if (held_.empty()) {
+        return std::nullopt;
+    }
+    return lastMicros_ + settings_.maxGapMicros + 1;
+}
+
+void BurstDetector::settle(ScannerOutput& output) {
+    if (held_.size() >= settings_.minLength && std::all_of(held_.begin(), held_.end(), isCodeUnit)) {
+        output.codes.emplace_back(held_.begin(), held_.end());
+    } else {
+        output.typed += held_;
+    }
+    held_.clear();
+}
+
+ScannerInput::ScannerInput(Clock clock, std::function<void()> onBatch, ScanSettings settings)
+    : clock_(std::move(clock)), onBatch_(std::move(onBatch)), detector_(settings) {
+    thread_ = std::thread([this] { run(); });
+}
+
+ScannerInput::~ScannerInput() {
+    stopping_.store(true, std::memory_order_release);
+    pushed_.fetch_add(1, std::memory_order_release);
+    pushed_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool ScannerInput::push(const Keystroke& key) {
+    if (!ring_.tryPush(key)) {
+        return false;
+    }
+    pushed_.fetch_add(1, std::memory_order_release);
+    pushed_.notify_one();
+    return true;
+}
+
+void ScannerInput::setCatalogue(std::shared_ptr<const Catalogue> catalogue) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    catalogue_ = std::move(catalogue);
+}
+
+ScanBatch ScannerInput::takeBatch() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return std::exchange(batch_, ScanBatch{});
+}
+
+// The push count is read before the ring is drained, so a keystroke pushed after draining
+// changes it and wait() returns at once. While a keystroke is held back the worker sleeps
+// until the detector can decide instead; keystrokes arriving meanwhile carry their own time
+// and are classified correctly when it wakes.
+void ScannerInput::run() {
+    ScannerOutput output;
+    while (true) {
+        const std::uint32_t seen = pushed_.load(std::memory_order_acquire);
+        if (stopping_.load(std::memory_order_acquire)) {
+            return;
+        }
+        Keystroke key;
+        while (ring_.tryPop(key)) {
+            detector_.feed(key, output);
+        }
+        detector_.flush(clock_(), output);
+        if (!output.empty()) {
+            deliver(output);
+            output.clear();
+        }
+        if (const std::optional<std::uint64_t> deadline = detector_.deadline()) {
+            const std::uint64_t now = clock_();
+            if (*deadline > now) {
+                std::this_thread::sleep_for(std::chrono::microseconds(*deadline - now));
+            }
+        } else {
+            pushed_.wait(seen, std::memory_order_acquire);
+        }
+    }
+}
+
+// Lookups run outside the lock; only the catalogue pointer and the append to the batch are
+// taken under it.
+void ScannerInput::deliver(const ScannerOutput& output) {
+    std::shared_ptr<const Catalogue> catalogue;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        catalogue = catalogue_;
+    }
+    std::vector<ArticleHandle> articles;
+    std::vector<std::string> unknownCodes;
+    for (const std::string& code : output.codes) {
+        const std::optional<std::size_t> article = catalogue ? catalogue->findByBarcode(code) : std::nullopt;
+        if (article) {
+            articles.push_back(catalogue->store().handle(*article));
+        } else {
+            unknownCodes.push_back(code);
+        }
+    }
+    bool notify = false;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        notify = batch_.empty();
+        batch_.articles.insert(batch_.articles.end(), articles.begin(), articles.end());
+        batch_.unknownCodes.insert(batch_.unknownCodes.end(), unknownCodes.begin(), unknownCodes.end());
+        batch_.typed += output.typed;
+    }
+    if (notify) {
+        onBatch_();
+    }
+}
+
+} // namespace cashsloth
@@ -0,0 +1,163 @@
+#include "cash_sloth_startup_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cash_sloth_json_writer.h"
+
+namespace {
+
+using Clock = cashsloth::StartupTrace::Clock;
+
+const Clock::time_point kProgramStart = Clock::now();
+
+struct TraceEvent {
+    const char* name;
+    std::thread::id thread;
+    std::int64_t startMicros;
+    // -1 for a mark.
+    std::int64_t durationMicros;
+};
+
+struct TraceState {
+    std::atomic<bool> enabled{false};
+    std::mutex mutex;
+    std::thread::id mainThread;
+    std::vector<TraceEvent> events;
+};
+
+TraceState& state() {
+    static TraceState instance;
+    return instance;
+}
+
+std::int64_t microsSinceStart(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - kProgramStart).count();
+}
+
+void record(const char* name, Clock::time_point start, std::int64_t durationMicros) {
+    TraceState& trace = state();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    trace.events.push_back(TraceEvent{name, std::this_thread::get_id(), microsSinceStart(start), durationMicros});
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+StartupTrace::Span::Span(const char* name) : name_(name), start_(enabled() ? Clock::now() : Clock::time_point{}) {}
+
+StartupTrace::Span::~Span() {
+    if (start_ != Clock::time_point{} && enabled()) {
+        record(name_, start_, std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_).count());
+    }
+}
+
+void StartupTrace::enable() {
+    TraceState& trace = state();
+    {
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        trace.mainThread = std::this_thread::get_id();
+    }
+    trace.enabled.store(true, std::memory_order_release);
+}
+
+bool StartupTrace::enabled() {
+    return state().enabled.load(std::memory_order_acquire);
+}
+
+void StartupTrace::mark(const char* name) {
+    if (enabled()) {
+        record(name, Clock::now(), -1);
+    }
+}
+
+// Threads are numbered in the order they first recorded something, the main thread as 1, and
+// named through metadata events so the viewer labels their rows.
+bool StartupTrace::writeTo(const std::filesystem::path& path) {
+    TraceState& trace = state();
+    trace.enabled.store(false, std::memory_order_release);
+    std::vector<TraceEvent> events;
+    std::thread::id mainThread;
+    {
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        events = std::move(trace.events);
+        trace.events = {};
+        mainThread = trace.mainThread;
+    }
+    std::stable_sort(events.begin(), events.end(), [](const TraceEvent& left, const TraceEvent& right) {
+        return left.startMicros < right.startMicros;
+    });
+    std::vector<std::thread::id> threads{mainThread};
+    auto threadNumber = [&](std::thread::id thread) -> std::int64_t {
+        auto found = std::find(threads.begin(), threads.end(), thread);
+        if (found == threads.end()) {
+            found = threads.insert(threads.end(), thread);
+        }
+        return static_cast<std::int64_t>(found - threads.begin()) + 1;
+    };
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    if (!output.is_open()) {
+        return false;
+    }
+    {
+        JsonWriter writer(output, 1);
+        writer.beginObject();
+        writer.key("displayTimeUnit");
+        writer.value("ms");
+        writer.key("traceEvents");
+        writer.beginArray();
+        for (const TraceEvent& event : events) {
+            writer.beginObject();
+            writer.key("name");
+            writer.value(event.name);
+            writer.key("ph");
+            writer.value(event.durationMicros < 0 ? "i" : "X");
+            writer.key("ts");
+            writer.value(event.startMicros);
+            if (event.durationMicros < 0) {
+                writer.key("s");
+                writer.value("g");
+            } else {
+                writer.key("dur");
+                writer.value(event.durationMicros);
+            }
+            writer.key("pid");
+            writer.value(1);
+            writer.key("tid");
+            writer.value(threadNumber(event.thread));
+            writer.endObject();
+        }
+        for (std::size_t thread = 0; thread < threads.size(); ++thread) {
+            writer.beginObject();
+            writer.key("name");
+            writer.value("thread_name");
+            writer.key("ph");
+            writer.value("M");
+            writer.key("pid");
+            writer.value(1);
+            writer.key("tid");
+            writer.value(static_cast<std::int64_t>(thread) + 1);
+            writer.key("args");
+            writer.beginObject();
+            writer.key("name");
+            writer.value(thread == 0 ? std::string("main") : "worker " + std::to_string(thread));
+            writer.endObject();
+            writer.endObject();
+        }
+        writer.endArray();
+        writer.endObject();
+    }
+    output.put('\n');
+    return static_cast<bool>(output);
+}
+
+} // namespace cashsloth
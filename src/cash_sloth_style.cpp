@@ -1,227 +1,47 @@
 #include "cash_sloth_style.h"
 
 #include <algorithm>
+#include <charconv>
 #include <cmath>
-#include <fstream>
 #include <iostream>
+#include <optional>
+#include <string_view>
 
+#include "cash_sloth_asset_paths.h"
+#include "cash_sloth_json_schema.h"
+#include "cash_sloth_mapped_file.h"
 #include "cash_sloth_utils.h"
 
-namespace cashsloth {
-
-StyleSheet StyleSheet::load(const std::filesystem::path& baseDir) {
-    StyleSheet sheet;
-    const std::vector<std::filesystem::path> candidates = {
-        baseDir / "assets" / "style.json",
-        baseDir / "style.json",
-        baseDir / "cash_sloth_styles_v25.11.json"
-    };
-
-    std::ifstream input;
-    for (const auto& candidate : candidates) {
-        input.open(candidate);
-        if (input.is_open()) {
-            break;
-        }
-        input.clear();
-    }
-    if (!input.is_open()) {
-        return sheet;
-    }
-    const std::string payload{
-        std::istreambuf_iterator<char>(input),
-        std::istreambuf_iterator<char>()
-    };
-    try {
-        JsonParser parser(payload);
-        const JsonValue root = parser.parse();
-        if (!root.isObject()) {
-            return sheet;
-        }
-        const auto& object = root.asObject();
-
-        const auto paletteIt = object.find("palette");
-        if (paletteIt != object.end() && paletteIt->second.isObject()) {
-            const auto& paletteObj = paletteIt->second.asObject();
-            auto colorOr = [&](const char* key, COLORREF fallback) {
-                const auto it = paletteObj.find(key);
-                if (it == paletteObj.end()) {
-                    return fallback;
-                }
-                const auto parsed = parseColorValue(it->second);
-                return parsed.value_or(fallback);
-            };
-            sheet.palette.background = colorOr("background", sheet.palette.background);
-            sheet.palette.backgroundGlow = colorOr("background_glow", sheet.palette.backgroundGlow);
-            sheet.palette.panelBase = colorOr("panel_base", sheet.palette.panelBase);
-            sheet.palette.panelElevated = colorOr("panel_elevated", sheet.palette.panelElevated);
-            sheet.palette.panelBorder = colorOr("panel_border", sheet.palette.panelBorder);
-            sheet.palette.accent = colorOr("accent", sheet.palette.accent);
-            sheet.palette.accentStrong = colorOr("accent_strong", sheet.palette.accentStrong);
-            sheet.palette.accentSoft = colorOr("accent_soft", sheet.palette.accentSoft);
-            sheet.palette.textPrimary = colorOr("text_primary", sheet.palette.textPrimary);
-            sheet.palette.textSecondary = colorOr("text_secondary", sheet.palette.textSecondary);
-            sheet.palette.success = colorOr("success", sheet.palette.success);
-            sheet.palette.danger = colorOr("danger", sheet.palette.danger);
-            sheet.palette.tileBase = colorOr("tile_base", sheet.palette.tileBase);
-            sheet.palette.tileRaised = colorOr("tile_raised", sheet.palette.tileRaised);
-            sheet.palette.quickBase = colorOr("quick_base", sheet.palette.quickBase);
-            sheet.palette.quickPressed = colorOr("quick_pressed", sheet.palette.quickPressed);
-            sheet.palette.actionBase = colorOr("action_base", sheet.palette.actionBase);
-        }
-
-        const auto metricsIt = object.find("metrics");
-        if (metricsIt != object.end() && metricsIt->second.isObject()) {
-            const auto& metricsObj = metricsIt->second.asObject();
-            auto intOr = [&](const char* key, int fallback) {
-                const auto it = metricsObj.find(key);
-                if (it == metricsObj.end() || !it->second.isNumber()) {
-                    return fallback;
-                }
-                return static_cast<int>(std::round(it->second.asNumber()));
-            };
-            sheet.metrics.baseWidth = intOr("base_width", sheet.metrics.baseWidth);
-            sheet.metrics.baseHeight = intOr("base_height", sheet.metrics.baseHeight);
-            sheet.metrics.margin = intOr("margin", sheet.metrics.margin);
-            sheet.metrics.infoHeight = intOr("info_height", sheet.metrics.infoHeight);
-            sheet.metrics.summaryHeight = intOr("summary_height", sheet.metrics.summaryHeight);
-            sheet.metrics.gap = intOr("gap", sheet.metrics.gap);
-            sheet.metrics.leftColumnWidth = intOr("left_column_width", sheet.metrics.leftColumnWidth);
-            sheet.metrics.minLeftColumnWidth = intOr("min_left_column_width", sheet.metrics.minLeftColumnWidth);
-            sheet.metrics.maxLeftColumnWidth = intOr("max_left_column_width", sheet.metrics.maxLeftColumnWidth);
-            sheet.metrics.minProductsWidth = intOr("min_products_width", sheet.metrics.minProductsWidth);
-            sheet.metrics.minRightColumnWidth = intOr("min_right_column_width", sheet.metrics.minRightColumnWidth);
-            sheet.metrics.rightColumnWidth = intOr("right_column_width", sheet.metrics.rightColumnWidth);
-            sheet.metrics.minCartListWidth = intOr("min_cart_list_width", sheet.metrics.minCartListWidth);
-            sheet.metrics.minPaymentWidth = intOr("min_payment_width", sheet.metrics.minPaymentWidth);
-            sheet.metrics.categoryHeight = intOr("category_height", sheet.metrics.categoryHeight);
-            sheet.metrics.categorySpacing = intOr("category_spacing", sheet.metrics.categorySpacing);
-            sheet.metrics.productTileHeight = intOr("product_tile_height", sheet.metrics.productTileHeight);
-            sheet.metrics.tileGap = intOr("tile_gap", sheet.metrics.tileGap);
-            sheet.metrics.quickButtonHeight = intOr("quick_button_height", sheet.metrics.quickButtonHeight);
-            sheet.metrics.quickColumns = (std::max)(1, intOr("quick_columns", sheet.metrics.quickColumns));
-            sheet.metrics.actionButtonHeight = intOr("action_button_height", sheet.metrics.actionButtonHeight);
-            sheet.metrics.panelRadius = intOr("panel_radius", sheet.metrics.panelRadius);
-            sheet.metrics.buttonRadius = intOr("button_radius", sheet.metrics.buttonRadius);
-            sheet.metrics.titleHeight = intOr("title_height", sheet.metrics.titleHeight);
-            sheet.metrics.titleGap = intOr("title_gap", sheet.metrics.titleGap);
-        }
-
-        const auto typographyIt = object.find("typography");
-        if (typographyIt != object.end() && typographyIt->second.isObject()) {
-            const auto& typoObj = typographyIt->second.asObject();
-            auto fontIt = typoObj.find("heading");
-            if (fontIt != typoObj.end()) {
-                sheet.typography.heading = parseFontSpec(fontIt->second, sheet.typography.heading);
-            }
-            fontIt = typoObj.find("tile");
-            if (fontIt != typoObj.end()) {
-                sheet.typography.tile = parseFontSpec(fontIt->second, sheet.typography.tile);
-            }
-            fontIt = typoObj.find("button");
-            if (fontIt != typoObj.end()) {
-                sheet.typography.button = parseFontSpec(fontIt->second, sheet.typography.button);
-            }
-            fontIt = typoObj.find("body");
-            if (fontIt != typoObj.end()) {
-                sheet.typography.body = parseFontSpec(fontIt->second, sheet.typography.body);
-            }
-            const auto familyIt = typoObj.find("font_family");
-            if (familyIt != typoObj.end() && familyIt->second.isString()) {
-                sheet.fontFamily = toWide(familyIt->second.asString());
-            }
-        }
-
-        const auto quickIt = object.find("quick_amounts");
-        if (quickIt != object.end() && quickIt->second.isArray()) {
-            std::vector<double> amounts;
-            for (const JsonValue& entry : quickIt->second.asArray()) {
-                if (entry.isNumber()) {
-                    const double value = entry.asNumber();
-                    if (value > 0.0) {
-                        amounts.push_back(value);
-                    }
-                }
-            }
-            if (!amounts.empty()) {
-                sheet.quickAmounts = std::move(amounts);
-            }
-        }
+namespace {
 
-        const auto heroIt = object.find("hero");
-        if (heroIt != object.end() && heroIt->second.isObject()) {
-            const auto& heroObj = heroIt->second.asObject();
-            const auto titleIt = heroObj.find("title");
-            if (titleIt != heroObj.end() && titleIt->second.isString()) {
-                sheet.hero.title = toWide(titleIt->second.asString());
-            }
-            const auto subtitleIt = heroObj.find("subtitle");
-            if (subtitleIt != heroObj.end() && subtitleIt->second.isString()) {
-                sheet.hero.subtitle = toWide(subtitleIt->second.asString());
-            }
-            const auto badgeIt = heroObj.find("badge");
-            if (badgeIt != heroObj.end() && badgeIt->second.isString()) {
-                sheet.hero.badge = toWide(badgeIt->second.asString());
-            }
-        }
-
-        const auto glassIt = object.find("glass_strength");
-        if (glassIt != object.end() && glassIt->second.isNumber()) {
-            sheet.glassStrength = std::clamp(glassIt->second.asNumber(), 0.05, 0.5);
-        }
-        const auto glowIt = object.find("accent_glow");
-        if (glowIt != object.end() && glowIt->second.isNumber()) {
-            sheet.accentGlow = std::clamp(glowIt->second.asNumber(), 0.05, 0.6);
-        }
-    } catch (const std::exception& exc) {
-        std::cerr << "Warnung: Stylesheet konnte nicht geladen werden: " << exc.what() << '\n';
-    }
-    return sheet;
-}
-
-std::optional<COLORREF> StyleSheet::parseColorValue(const JsonValue& value) {
-    if (value.isString()) {
-        return parseHexColor(value.asString());
-    }
-    if (value.isArray()) {
-        const auto& arr = value.asArray();
-        if (arr.size() >= 3 && arr[0].isNumber() && arr[1].isNumber() && arr[2].isNumber()) {
-            auto clampChannel = [](double v) -> int {
-                return static_cast<int>(std::clamp(std::round(v), 0.0, 255.0));
-            };
-            return RGB(
-                clampChannel(arr[0].asNumber()),
-                clampChannel(arr[1].asNumber()),
-                clampChannel(arr[2].asNumber()));
-        }
-    }
-    return std::nullopt;
-}
+using cashsloth::JsonCursor;
+using cashsloth::Money;
+using cashsloth::StyleSheet;
 
-std::optional<COLORREF> StyleSheet::parseHexColor(const std::string& text) {
-    std::string raw = trim(text);
+std::optional<COLORREF> parseHexColor(std::string_view text) {
+    std::string raw = cashsloth::trim(text);
     if (!raw.empty() && raw.front() == '#') {
         raw.erase(raw.begin());
     }
     if (raw.size() != 6 && raw.size() != 8) {
         return std::nullopt;
     }
-    try {
-        unsigned long value = std::stoul(raw, nullptr, 16);
-        if (raw.size() == 8) {
-            value &= 0x00FFFFFF;
-        }
-        const int r = static_cast<int>((value >> 16) & 0xFF);
-        const int g = static_cast<int>((value >> 8) & 0xFF);
-        const int b = static_cast<int>(value & 0xFF);
-        return RGB(r, g, b);
-    } catch (const std::exception&) {
+    unsigned long value = 0;
+    const auto [end, ec] = std::from_chars(raw.data(), raw.data() + raw.size(), value, 16);
+    if (ec != std::errc() || end != raw.data() + raw.size()) {
         return std::nullopt;
     }
+    if (raw.size() == 8) {
+        value &= 0x00FFFFFF;
+    }
+    const int r = static_cast<int>((value >> 16) & 0xFF);
+    const int g = static_cast<int>((value >> 8) & 0xFF);
+    const int b = static_cast<int>(value & 0xFF);
+    return RGB(r, g, b);
 }
 
-int StyleSheet::parseFontWeightToken(const std::string& token) {
-    const std::string lower = toLower(trim(token));
+int parseFontWeightToken(std::string_view token) {
+    const std::string lower = cashsloth::toLower(cashsloth::trim(token));
     if (lower == "thin") {
         return FW_THIN;
     }
@@ -243,21 +63,225 @@ int StyleSheet::parseFontWeightToken(const std::string& token) {
     return FW_NORMAL;
 }
 
-StyleSheet::FontSpec StyleSheet::parseFontSpec(const JsonValue& node, FontSpec fallback) {
-    FontSpec spec = fallback;
-    if (!node.isObject()) {
-        return spec;
+// Colours are "#RRGGBB" (an alpha byte in front is ignored) or an array whose first three
+// elements are the channels; further elements are ignored.
+bool readColor(JsonCursor& cursor, std::string& scratch, COLORREF& color) {
+    if (cursor.isString()) {
+        const std::optional<COLORREF> parsed = parseHexColor(cursor.readString(scratch));
+        if (!parsed) {
+            return false;
+        }
+        color = *parsed;
+        return true;
+    }
+    if (!cursor.isArray()) {
+        return false;
+    }
+    double channels[3] = {};
+    std::size_t count = 0;
+    bool numeric = true;
+    cursor.beginArray();
+    while (cursor.nextElement()) {
+        if (count < 3 && cursor.isNumber()) {
+            channels[count] = cursor.readNumber();
+        } else {
+            numeric = numeric && count >= 3;
+            cursor.skipValue();
+        }
+        ++count;
     }
-    const auto& obj = node.asObject();
-    const auto sizeIt = obj.find("size");
-    if (sizeIt != obj.end() && sizeIt->second.isNumber()) {
-        spec.sizePt = static_cast<int>(std::round(sizeIt->second.asNumber()));
+    if (!numeric || count < 3) {
+        return false;
     }
-    const auto weightIt = obj.find("weight");
-    if (weightIt != obj.end() && weightIt->second.isString()) {
-        spec.weight = parseFontWeightToken(weightIt->second.asString());
+    auto clampChannel = [](double v) -> int {
+        return static_cast<int>(std::clamp(std::round(v), 0.0, 255.0));
+    };
+    color = RGB(clampChannel(channels[0]), clampChannel(channels[1]), clampChannel(channels[2]));
+    return true;
+}
+
+bool readFontWeight(JsonCursor& cursor, std::string& scratch, int& weight) {
+    if (!cursor.isString()) {
+        return false;
     }
-    return spec;
+    weight = parseFontWeightToken(cursor.readString(scratch));
+    return true;
+}
+
+bool readWideString(JsonCursor& cursor, std::string& scratch, std::wstring& value) {
+    if (!cursor.isString()) {
+        return false;
+    }
+    value = cashsloth::toWide(cursor.readString(scratch));
+    return true;
+}
+
+// Keeps the positive amounts, rounded to whole Rappen; a list without any leaves the defaults
+// in place.
+bool readQuickAmounts(JsonCursor& cursor, std::string&, std::vector<Money>& amounts) {
+    if (!cursor.isArray()) {
+        return false;
+    }
+    std::vector<Money> parsed;
+    cursor.beginArray();
+    while (cursor.nextElement()) {
+        if (cursor.isNumber()) {
+            const cashsloth::JsonNumber number = cursor.readDecimal();
+            const std::optional<Money> value =
+                number.isExact() ? Money::fromDecimal(number.mantissa(), number.exponent()) : std::nullopt;
+            if (value.has_value() && value.value() > Money()) {
+                parsed.push_back(value.value());
+            }
+        } else {
+            cursor.skipValue();
+        }
+    }
+    if (parsed.empty()) {
+        return false;
+    }
+    amounts = std::move(parsed);
+    return true;
+}
+
+using Palette = StyleSheet::Palette;
+using Metrics = StyleSheet::Metrics;
+using FontSpec = StyleSheet::FontSpec;
+using HeroContent = StyleSheet::HeroContent;
+using cashsloth::jsonField;
+using cashsloth::jsonMember;
+using cashsloth::makeJsonSchema;
+using cashsloth::readJsonInt;
+using cashsloth::readJsonNumber;
+using cashsloth::readJsonObject;
+
+constexpr auto kPaletteSchema = makeJsonSchema(
+    jsonMember<&Palette::background, readColor>("background"),
+    jsonMember<&Palette::backgroundGlow, readColor>("background_glow"),
+    jsonMember<&Palette::panelBase, readColor>("panel_base"),
+    jsonMember<&Palette::panelElevated, readColor>("panel_elevated"),
+    jsonMember<&Palette::panelBorder, readColor>("panel_border"),
+    jsonMember<&Palette::accent, readColor>("accent"),
+    jsonMember<&Palette::accentStrong, readColor>("accent_strong"),
+    jsonMember<&Palette::accentSoft, readColor>("accent_soft"),
+    jsonMember<&Palette::textPrimary, readColor>("text_primary"),
+    jsonMember<&Palette::textSecondary, readColor>("text_secondary"),
+    jsonMember<&Palette::success, readColor>("success"),
+    jsonMember<&Palette::danger, readColor>("danger"),
+    jsonMember<&Palette::tileBase, readColor>("tile_base"),
+    jsonMember<&Palette::tileRaised, readColor>("tile_raised"),
+    jsonMember<&Palette::quickBase, readColor>("quick_base"),
+    jsonMember<&Palette::quickPressed, readColor>("quick_pressed"),
+    jsonMember<&Palette::actionBase, readColor>("action_base"));
+
+constexpr auto kMetricsSchema = makeJsonSchema(
+    jsonMember<&Metrics::baseWidth, readJsonInt<>>("base_width"),
+    jsonMember<&Metrics::baseHeight, readJsonInt<>>("base_height"),
+    jsonMember<&Metrics::margin, readJsonInt<>>("margin"),
+    jsonMember<&Metrics::infoHeight, readJsonInt<>>("info_height"),
+    jsonMember<&Metrics::summaryHeight, readJsonInt<>>("summary_height"),
+    jsonMember<&Metrics::gap, readJsonInt<>>("gap"),
+    jsonMember<&Metrics::leftColumnWidth, readJsonInt<>>("left_column_width"),
+    jsonMember<&Metrics::minLeftColumnWidth, readJsonInt<>>("min_left_column_width"),
+    jsonMember<&Metrics::maxLeftColumnWidth, readJsonInt<>>("max_left_column_width"),
+    jsonMember<&Metrics::minProductsWidth, readJsonInt<>>("min_products_width"),
+    jsonMember<&Metrics::minRightColumnWidth, readJsonInt<>>("min_right_column_width"),
+    jsonMember<&Metrics::rightColumnWidth, readJsonInt<>>("right_column_width"),
+    jsonMember<&Metrics::minCartListWidth, readJsonInt<>>("min_cart_list_width"),
+    jsonMember<&Metrics::minPaymentWidth, readJsonInt<>>("min_payment_width"),
+    jsonMember<&Metrics::categoryHeight, readJsonInt<>>("category_height"),
+    jsonMember<&Metrics::categorySpacing, readJsonInt<>>("category_spacing"),
+    jsonMember<&Metrics::productTileHeight, readJsonInt<>>("product_tile_height"),
+    jsonMember<&Metrics::tileGap, readJsonInt<>>("tile_gap"),
+    jsonMember<&Metrics::quickButtonHeight, readJsonInt<>>("quick_button_height"),
+    jsonMember<&Metrics::quickColumns, readJsonInt<1>>("quick_columns"),
+    jsonMember<&Metrics::actionButtonHeight, readJsonInt<>>("action_button_height"),
+    jsonMember<&Metrics::panelRadius, readJsonInt<>>("panel_radius"),
+    jsonMember<&Metrics::buttonRadius, readJsonInt<>>("button_radius"),
+    jsonMember<&Metrics::titleHeight, readJsonInt<>>("title_height"),
+    jsonMember<&Metrics::titleGap, readJsonInt<>>("title_gap"));
+
+constexpr auto kFontSpecSchema = makeJsonSchema(
+    jsonMember<&FontSpec::sizePt, readJsonInt<>>("size"),
+    jsonMember<&FontSpec::weight, readFontWeight>("weight"));
+
+// "typography" carries the font family next to the font specs, so it is bound to the whole
+// sheet rather than to StyleSheet::Typography.
+constexpr auto kTypographySchema = makeJsonSchema(
+    jsonField<StyleSheet>(
+        [](JsonCursor& cursor, std::string& scratch, StyleSheet& sheet) {
+            return kFontSpecSchema.read(cursor, scratch, sheet.typography.heading);
+        },
+        "heading"),
+    jsonField<StyleSheet>(
+        [](JsonCursor& cursor, std::string& scratch, StyleSheet& sheet) {
+            return kFontSpecSchema.read(cursor, scratch, sheet.typography.tile);
+        },
+        "tile"),
+    jsonField<StyleSheet>(
+        [](JsonCursor& cursor, std::string& scratch, StyleSheet& sheet) {
+            return kFontSpecSchema.read(cursor, scratch, sheet.typography.button);
+        },
+        "button"),
+    jsonField<StyleSheet>(
+        [](JsonCursor& cursor, std::string& scratch, StyleSheet& sheet) {
+            return kFontSpecSchema.read(cursor, scratch, sheet.typography.body);
+        },
+        "body"),
+    jsonMember<&StyleSheet::fontFamily, readWideString>("font_family"));
+
+constexpr auto kHeroSchema = makeJsonSchema(
+    jsonMember<&HeroContent::title, readWideString>("title"),
+    jsonMember<&HeroContent::subtitle, readWideString>("subtitle"),
+    jsonMember<&HeroContent::badge, readWideString>("badge"));
+
+constexpr auto kStyleSheetSchema = makeJsonSchema(
+    jsonMember<&StyleSheet::palette, readJsonObject<kPaletteSchema>>("palette"),
+    jsonMember<&StyleSheet::metrics, readJsonObject<kMetricsSchema>>("metrics"),
+    jsonField<StyleSheet>(
+        [](JsonCursor& cursor, std::string& scratch, StyleSheet& sheet) {
+            return kTypographySchema.read(cursor, scratch, sheet);
+        },
+        "typography"),
+    jsonMember<&StyleSheet::hero, readJsonObject<kHeroSchema>>("hero"),
+    jsonMember<&StyleSheet::quickAmounts, readQuickAmounts>("quick_amounts"),
+    jsonMember<&StyleSheet::glassStrength, readJsonNumber<0.05, 0.5>>("glass_strength"),
+    jsonMember<&StyleSheet::accentGlow, readJsonNumber<0.05, 0.6>>("accent_glow"));
+
+}  // namespace
+
+namespace cashsloth {
+
+// The sheet is bound straight from the file with a JsonCursor; values of the wrong type
+// keep their defaults. The cursor validates what it skips and what follows the sheet, so the
+// file is read once, and a malformed file leaves the whole sheet at its defaults.
+StyleSheet StyleSheet::load(const std::filesystem::path& baseDir) {
+    StyleSheet sheet;
+    MappedFile file;
+    for (const auto& candidate : existingFiles(styleCandidates(baseDir))) {
+        file = MappedFile(candidate);
+        if (file.isOpen()) {
+            break;
+        }
+    }
+    if (!file.isOpen()) {
+        return sheet;
+    }
+    try {
+        JsonCursor cursor(file.view(), JsonCursor::Skipping::Validated);
+        StyleSheet parsed;
+        std::string scratch;
+        const bool complete = kStyleSheetSchema.read(cursor, scratch, parsed);
+        cursor.finish();
+        if (complete) {
+            sheet = std::move(parsed);
+        }
+    } catch (const cashsloth::JsonCursorError& error) {
+        std::cerr << "Warnung: Stylesheet konnte nicht geladen werden: " << error.what()
+                  << " (Byte " << error.offset() << ")\n";
+    } catch (const std::exception& exc) {
+        std::cerr << "Warnung: Stylesheet konnte nicht geladen werden: " << exc.what() << '\n';
+    }
+    return sheet;
 }
 
 COLORREF mixColor(COLORREF start, COLORREF target, double factor) {
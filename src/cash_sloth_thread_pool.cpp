@@ -0,0 +1,119 @@
+#include "cash_sloth_thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <utility>
+
+namespace {
+
+// Shared between the caller and helper tasks, which may start only after the caller has
+// already returned when every item was taken before they got a turn.
+struct ParallelForState {
+    explicit ParallelForState(std::size_t itemCount, const std::function<void(std::size_t)>& itemBody)
+        : count(itemCount), body(itemBody) {}
+
+    void run() {
+        for (std::size_t index = next.fetch_add(1); index < count; index = next.fetch_add(1)) {
+            try {
+                body(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            if (finished.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+
+    const std::size_t count;
+    const std::function<void(std::size_t)>& body;
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> finished{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+};
+
+}  // namespace
+
+namespace cashsloth {
+
+ThreadPool::ThreadPool(std::size_t workers) {
+    if (workers == 0) {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        workers = hardware > 1 ? hardware - 1 : 0;
+    }
+    workers_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    // Helpers only read `body` while items are left, and the caller does not return before
+    // the last item finished, so the reference stays valid for as long as it is used.
+    auto state = std::make_shared<ParallelForState>(count, body);
+    const std::size_t helpers = std::min(workers_.size(), count - 1);
+    for (std::size_t i = 0; i < helpers; ++i) {
+        post([state] { state->run(); });
+    }
+    state->run();
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&] { return state->finished.load() == count; });
+    }
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace cashsloth
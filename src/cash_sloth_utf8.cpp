@@ -0,0 +1,258 @@
+#include "cash_sloth_utf8.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CASHSLOTH_UTF8_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr char16_t kReplacement = 0xFFFD;
+
+// Result of decoding the sequence at the current position: the code point and its length,
+// or for an ill-formed sequence the length of its maximal subpart, which is skipped as a
+// unit.
+struct Utf8Sequence {
+    char32_t codepoint;
+    std::size_t length;
+    bool valid;
+};
+
+// Follows the well-formed byte sequences table of the Unicode standard (section 3.9): the
+// second byte range depends on the lead byte, which rules out overlong forms, surrogates and
+// code points above U+10FFFF without decoding first.
+Utf8Sequence decodeSequence(const unsigned char* data, std::size_t size) {
+    const unsigned lead = data[0];
+    std::size_t trailing = 0;
+    unsigned low = 0x80;
+    unsigned high = 0xBF;
+    char32_t codepoint = 0;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        trailing = 1;
+        codepoint = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        trailing = 2;
+        codepoint = lead & 0x0F;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        trailing = 3;
+        codepoint = lead & 0x07;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return {0, 1, false};
+    }
+    for (std::size_t i = 1; i <= trailing; ++i) {
+        if (i >= size || data[i] < low || data[i] > high) {
+            return {0, i, false};
+        }
+        codepoint = (codepoint << 6) | (data[i] & 0x3F);
+        low = 0x80;
+        high = 0xBF;
+    }
+    return {codepoint, trailing + 1, true};
+}
+
+// The ASCII kernels return how many leading units were ASCII; the widening and narrowing
+// ones also copy those units to `out`.
+std::size_t asciiPrefixScalar(const unsigned char* data, std::size_t size) {
+    std::size_t i = 0;
+    for (; std::endian::native == std::endian::little && i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        const std::uint64_t high = word & 0x8080808080808080ull;
+        if (high != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(high) / 8);
+        }
+    }
+    while (i < size && data[i] < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+#if defined(CASHSLOTH_UTF8_SSE2)
+
+std::size_t asciiPrefix(const unsigned char* data, std::size_t size) {
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(chunk));
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + asciiPrefixScalar(data + i, size - i);
+}
+
+std::size_t widenAscii(const unsigned char* data, std::size_t size, char16_t* out) {
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        if (_mm_movemask_epi8(chunk) != 0) {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(chunk, zero));
+    }
+    for (; i < size && data[i] < 0x80; ++i) {
+        out[i] = data[i];
+    }
+    return i;
+}
+
+std::size_t narrowAscii(const char16_t* data, std::size_t size, unsigned char* out) {
+    const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 8));
+        const __m128i high = _mm_and_si128(_mm_or_si128(first, second), nonAscii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) != 0xFFFF) {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(first, second));
+    }
+    for (; i < size && data[i] < 0x80; ++i) {
+        out[i] = static_cast<unsigned char>(data[i]);
+    }
+    return i;
+}
+
+#else
+
+std::size_t asciiPrefix(const unsigned char* data, std::size_t size) {
+    return asciiPrefixScalar(data, size);
+}
+
+std::size_t widenAscii(const unsigned char* data, std::size_t size, char16_t* out) {
+    const std::size_t count = asciiPrefixScalar(data, size);
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = data[i];
+    }
+    return count;
+}
+
+std::size_t narrowAscii(const char16_t* data, std::size_t size, unsigned char* out) {
+    std::size_t i = 0;
+    for (; i < size && data[i] < 0x80; ++i) {
+        out[i] = static_cast<unsigned char>(data[i]);
+    }
+    return i;
+}
+
+#endif
+
+unsigned char* writeUtf8(unsigned char* out, char32_t codepoint) {
+    if (codepoint < 0x80) {
+        *out++ = static_cast<unsigned char>(codepoint);
+    } else if (codepoint < 0x800) {
+        *out++ = static_cast<unsigned char>(0xC0 | (codepoint >> 6));
+        *out++ = static_cast<unsigned char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        *out++ = static_cast<unsigned char>(0xE0 | (codepoint >> 12));
+        *out++ = static_cast<unsigned char>(0x80 | ((codepoint >> 6) & 0x3F));
+        *out++ = static_cast<unsigned char>(0x80 | (codepoint & 0x3F));
+    } else {
+        *out++ = static_cast<unsigned char>(0xF0 | (codepoint >> 18));
+        *out++ = static_cast<unsigned char>(0x80 | ((codepoint >> 12) & 0x3F));
+        *out++ = static_cast<unsigned char>(0x80 | ((codepoint >> 6) & 0x3F));
+        *out++ = static_cast<unsigned char>(0x80 | (codepoint & 0x3F));
+    }
+    return out;
+}
+
+}  // namespace
+
+namespace cashsloth {
+
+std::size_t findInvalidUtf8(std::string_view text) {
+    const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+    const std::size_t size = text.size();
+    std::size_t i = 0;
+    while (true) {
+        i += asciiPrefix(data + i, size - i);
+        while (i < size && data[i] >= 0x80) {
+            const Utf8Sequence sequence = decodeSequence(data + i, size - i);
+            if (!sequence.valid) {
+                return i;
+            }
+            i += sequence.length;
+        }
+        if (i >= size) {
+            return size;
+        }
+    }
+}
+
+std::size_t utf8SequenceLength(const char* data, std::size_t size) {
+    const Utf8Sequence sequence = decodeSequence(reinterpret_cast<const unsigned char*>(data), size);
+    return sequence.valid ? sequence.length : 0;
+}
+
+std::size_t utf8ToUtf16(std::string_view text, char16_t* out) {
+    const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+    const std::size_t size = text.size();
+    std::size_t i = 0;
+    char16_t* const begin = out;
+    while (i < size) {
+        const std::size_t ascii = widenAscii(data + i, size - i, out);
+        i += ascii;
+        out += ascii;
+        while (i < size && data[i] >= 0x80) {
+            const Utf8Sequence sequence = decodeSequence(data + i, size - i);
+            i += sequence.length;
+            if (!sequence.valid) {
+                *out++ = kReplacement;
+            } else if (sequence.codepoint < 0x10000) {
+                *out++ = static_cast<char16_t>(sequence.codepoint);
+            } else {
+                const char32_t offset = sequence.codepoint - 0x10000;
+                *out++ = static_cast<char16_t>(0xD800 + (offset >> 10));
+                *out++ = static_cast<char16_t>(0xDC00 + (offset & 0x3FF));
+            }
+        }
+    }
+    return static_cast<std::size_t>(out - begin);
+}
+
+std::size_t utf16ToUtf8(std::u16string_view text, char* out) {
+    const char16_t* data = text.data();
+    const std::size_t size = text.size();
+    auto* cursor = reinterpret_cast<unsigned char*>(out);
+    std::size_t i = 0;
+    while (i < size) {
+        const std::size_t ascii = narrowAscii(data + i, size - i, cursor);
+        i += ascii;
+        cursor += ascii;
+        while (i < size && data[i] >= 0x80) {
+            char32_t codepoint = data[i++];
+            if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+                if (codepoint <= 0xDBFF && i < size && data[i] >= 0xDC00 && data[i] <= 0xDFFF) {
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (data[i++] - 0xDC00);
+                } else {
+                    codepoint = kReplacement;
+                }
+            }
+            cursor = writeUtf8(cursor, codepoint);
+        }
+    }
+    return static_cast<std::size_t>(cursor - reinterpret_cast<unsigned char*>(out));
+}
+
+void appendUtf8(std::string& out, char32_t codepoint) {
+    if ((codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF) {
+        codepoint = kReplacement;
+    }
+    unsigned char bytes[4];
+    const unsigned char* end = writeUtf8(bytes, codepoint);
+    out.append(reinterpret_cast<const char*>(bytes), static_cast<std::size_t>(end - bytes));
+}
+
+} // namespace cashsloth
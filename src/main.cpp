@@ -23,20 +23,28 @@ int main() {
 #include <commctrl.h>
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <cmath>
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <cstdlib>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <vector>
 
+#include "cash_sloth_asset_paths.h"
+#include "cash_sloth_catalogue.h"
+#include "cash_sloth_catalogue_diff.h"
+#include "cash_sloth_catalogue_watcher.h"
 #include "cash_sloth_json.h"
+#include "cash_sloth_scanner_input.h"
+#include "cash_sloth_startup_trace.h"
 #include "cash_sloth_style.h"
 #include "cash_sloth_utils.h"
 
@@ -71,284 +79,28 @@ struct Layout {
     int titleGap = 0;
 };
 
-struct Article {
-    std::string name;
-    double price = 0.0;
-    std::string barcode;
-};
-
-struct Category {
-    std::string name;
-    std::vector<Article> articles;
-};
-
-class Catalogue {
-public:
-    bool loadFromFile(const std::filesystem::path& path) {
-        std::ifstream input(path);
-        if (!input.is_open()) {
-            return false;
-        }
-        const std::string payload{
-            std::istreambuf_iterator<char>(input),
-            std::istreambuf_iterator<char>()
-        };
-        try {
-            JsonParser parser(payload);
-            JsonValue root = parser.parse();
-            std::vector<Category> newCategories = parseCategories(root);
-            if (newCategories.empty()) {
-                return false;
-            }
-            categories_ = std::move(newCategories);
-            rebuildBarcodeIndex();
-            loadedFile_ = path;
-            return true;
-        } catch (const std::exception& exc) {
-            std::cerr << "Warnung: Katalog konnte nicht aus \"" << path << "\" gelesen werden: "
-                      << exc.what() << '\n';
-            return false;
-        }
-    }
-
-    void loadDefault() {
-        categories_ = buildDefaultCatalogue();
-        rebuildBarcodeIndex();
-        loadedFile_.clear();
-    }
-
-    bool empty() const { return categories_.empty(); }
-    const std::vector<Category>& categories() const { return categories_; }
-
-    const Article* findByBarcode(const std::string& raw) const {
-        const std::string normalized = normalizeBarcode(raw);
-        if (normalized.empty()) {
-            return nullptr;
-        }
-        const auto it = barcodeIndex_.find(normalized);
-        return (it != barcodeIndex_.end()) ? it->second : nullptr;
-    }
-
-    const std::filesystem::path& loadedFile() const { return loadedFile_; }
-
-private:
-    static std::string normalizeBarcode(const std::string& raw) {
-        std::string result;
-        result.reserve(raw.size());
-        for (char ch : raw) {
-            if (!std::isspace(static_cast<unsigned char>(ch))) {
-                result.push_back(ch);
-            }
-        }
-        return result;
-    }
-
-    static std::optional<double> parsePrice(const JsonValue& value) {
-        if (value.isNumber()) {
-            return value.asNumber();
-        }
-        if (value.isString()) {
-            std::string text = value.asString();
-            text.erase(
-                std::remove_if(
-                    text.begin(),
-                    text.end(),
-                    [](unsigned char ch) { return std::isspace(ch); }),
-                text.end());
-            std::replace(text.begin(), text.end(), ',', '.');
-            if (text.empty()) {
-                return std::nullopt;
-            }
-            try {
-                size_t consumed = 0;
-                double parsed = std::stod(text, &consumed);
-                if (consumed == text.size()) {
-                    return parsed;
-                }
-            } catch (const std::exception&) {
-                return std::nullopt;
-            }
-        }
-        return std::nullopt;
-    }
-
-    static JsonValue::Object::const_iterator findAny(
-        const JsonValue::Object& object,
-        std::initializer_list<std::string_view> keys) {
-        for (auto key : keys) {
-            const auto it = object.find(std::string(key));
-            if (it != object.end()) {
-                return it;
-            }
-        }
-        return object.end();
-    }
-
-    static std::vector<Category> parseCategories(const JsonValue& root) {
-        std::vector<Category> result;
-
-        auto parseCategoryArray = [&](const JsonValue::Array& array) {
-            for (const JsonValue& entry : array) {
-                if (!entry.isObject()) {
-                    continue;
-                }
-                const auto& obj = entry.asObject();
-                const auto nameIt = obj.find("name");
-                if (nameIt == obj.end() || !nameIt->second.isString()) {
-                    continue;
-                }
-                Category category;
-                category.name = nameIt->second.asString();
-                const auto articlesIt = obj.find("articles");
-                if (articlesIt != obj.end() && articlesIt->second.isArray()) {
-                    for (const JsonValue& artValue : articlesIt->second.asArray()) {
-                        if (!artValue.isObject()) {
-                            continue;
-                        }
-                        const auto& artObj = artValue.asObject();
-                        const auto artNameIt = artObj.find("name");
-                        if (artNameIt == artObj.end() || !artNameIt->second.isString()) {
-                            continue;
-                        }
-                        const auto priceIt = findAny(artObj, {"price", "preis", "cost"});
-                        if (priceIt == artObj.end()) {
-                            continue;
-                        }
-                        const std::optional<double> maybePrice = parsePrice(priceIt->second);
-                        if (!maybePrice.has_value() || maybePrice.value() < 0.0) {
-                            continue;
-                        }
-
-                        Article article;
-                        article.name = artNameIt->second.asString();
-                        article.price = maybePrice.value();
-
-                        const auto barcodeIt = artObj.find("barcode");
-                        if (barcodeIt != artObj.end()) {
-                            if (barcodeIt->second.isString()) {
-                                article.barcode = normalizeBarcode(barcodeIt->second.asString());
-                            } else if (barcodeIt->second.isNull()) {
-                                article.barcode.clear();
-                            }
-                        }
-                        category.articles.push_back(std::move(article));
-                    }
-                }
-                if (!category.articles.empty()) {
-                    result.push_back(std::move(category));
-                }
-            }
-        };
-
-        if (root.isObject()) {
-            const auto& obj = root.asObject();
-            const auto categoriesIt = obj.find("categories");
-            if (categoriesIt != obj.end() && categoriesIt->second.isArray()) {
-                parseCategoryArray(categoriesIt->second.asArray());
-            } else {
-                for (const auto& [key, value] : obj) {
-                    if (!value.isArray()) {
-                        continue;
-                    }
-                    Category category;
-                    category.name = key;
-                    for (const JsonValue& artValue : value.asArray()) {
-                        if (!artValue.isObject()) {
-                            continue;
-                        }
-                        const auto& artObj = artValue.asObject();
-                        const auto artNameIt = artObj.find("name");
-                        const auto priceIt = findAny(artObj, {"price", "preis", "cost"});
-                        if (artNameIt == artObj.end() || priceIt == artObj.end()) {
-                            continue;
-                        }
-                        if (!artNameIt->second.isString()) {
-                            continue;
-                        }
-                        const std::optional<double> maybePrice = parsePrice(priceIt->second);
-                        if (!maybePrice.has_value() || maybePrice.value() < 0.0) {
-                            continue;
-                        }
-                        Article article;
-                        article.name = artNameIt->second.asString();
-                        article.price = maybePrice.value();
-                        const auto barcodeIt = artObj.find("barcode");
-                        if (barcodeIt != artObj.end() && barcodeIt->second.isString()) {
-                            article.barcode = normalizeBarcode(barcodeIt->second.asString());
-                        }
-                        category.articles.push_back(std::move(article));
-                    }
-                    if (!category.articles.empty()) {
-                        result.push_back(std::move(category));
-                    }
-                }
-            }
-        } else if (root.isArray()) {
-            parseCategoryArray(root.asArray());
-        }
-        return result;
-    }
-
-    static std::vector<Category> buildDefaultCatalogue() {
-        return {
-            {"Alkoholische Getraenke",
-             {
-                 {"Bier", 4.0, "761000000001"},
-                 {"Wein", 19.0, "761000000002"},
-                 {"Schnaps", 5.0, "761000000003"},
-             }},
-            {"Softgetraenke",
-             {
-                 {"3dl Getraenk", 2.0, "761000000101"},
-                 {"1.5l Getraenk", 7.0, "761000000102"},
-             }},
-            {"Snacks",
-             {
-                 {"Russenzopf & Kaffee", 3.0, "761000000201"},
-                 {"Sandwich Salami", 6.5, "761000000202"},
-             }},
-            {"Kaffee & Tee",
-             {
-                 {"Espresso", 2.5, "761000000301"},
-                 {"Cappuccino", 3.5, "761000000302"},
-                 {"Gruentee", 3.5, ""},
-                 {"Schwarztee", 4.0, ""},
-                 {"Lungo", 2.5, ""},
-             }},
-        };
-    }
-
-    void rebuildBarcodeIndex() {
-        barcodeIndex_.clear();
-        for (const Category& category : categories_) {
-            for (const Article& article : category.articles) {
-                if (!article.barcode.empty()) {
-                    barcodeIndex_[article.barcode] = &article;
-                }
-            }
-        }
-    }
-
-    std::vector<Category> categories_;
-    std::unordered_map<std::string, const Article*> barcodeIndex_;
-    std::filesystem::path loadedFile_;
-};
-
+// A cart line refers to its article by handle, so that scanning it again after a reload
+// still adds to the same line, and keeps the name and price the article was added with.
 struct CartItem {
-    const Article* article = nullptr;
+    ArticleHandle article;
     int quantity = 0;
+    std::wstring name;
+    Money price;
 };
 
 class Cart {
 public:
-    void add(const Article& article) {
+    void add(const Catalogue& catalogue, std::size_t article) {
+        const CatalogueStore& store = catalogue.store();
+        const ArticleHandle handle = store.handle(article);
+        const Money price = store.price(article);
         for (CartItem& item : items_) {
-            if (item.article == &article) {
+            if (item.article == handle && item.price == price) {
                 ++item.quantity;
                 return;
             }
         }
-        items_.push_back(CartItem{&article, 1});
+        items_.push_back(CartItem{handle, 1, std::wstring(asWide(catalogue.displayName(article))), price});
     }
 
     void remove(std::size_t index) {
@@ -360,49 +112,51 @@ public:
 
     void clear() {
         items_.clear();
-        credit_ = 0.0;
+        credit_ = Money();
         creditHistory_.clear();
     }
 
-    void addCredit(double amount) {
+    void addCredit(Money amount) {
         credit_ += amount;
         creditHistory_.push_back(amount);
     }
 
-    std::optional<double> undoCredit() {
+    std::optional<Money> undoCredit() {
         if (creditHistory_.empty()) {
             return std::nullopt;
         }
-        const double amount = creditHistory_.back();
+        const Money amount = creditHistory_.back();
         creditHistory_.pop_back();
-        credit_ = std::max(0.0, credit_ - amount);
+        credit_ -= amount;
         return amount;
     }
 
-    double total() const {
-        double sum = 0.0;
+    // Exact in Rappen, so the total does not drift however long the cart gets.
+    Money total() const {
+        Money sum;
         for (const CartItem& item : items_) {
-            if (item.article) {
-                sum += item.article->price * static_cast<double>(item.quantity);
-            }
+            sum += item.price * item.quantity;
         }
         return sum;
     }
 
-    double change() const {
-        const double diff = credit_ - total();
-        return diff > 0.0 ? diff : 0.0;
+    // What is due in cash: the total rounded to 5 Rappen, the smallest coin.
+    Money cashTotal() const { return total().roundedToFiveRappen(); }
+
+    Money change() const {
+        const Money diff = credit_ - cashTotal();
+        return diff > Money() ? diff : Money();
     }
 
     bool empty() const { return items_.empty(); }
     bool hasCreditHistory() const { return !creditHistory_.empty(); }
-    double credit() const { return credit_; }
+    Money credit() const { return credit_; }
     const std::vector<CartItem>& items() const { return items_; }
 
 private:
     std::vector<CartItem> items_;
-    double credit_ = 0.0;
-    std::vector<double> creditHistory_;
+    Money credit_;
+    std::vector<Money> creditHistory_;
 };
 
 
@@ -645,6 +399,15 @@ constexpr int ID_CATEGORY_BASE = 2000;
 constexpr int ID_PRODUCT_BASE = 3000;
 constexpr int ID_QUICK_AMOUNT_BASE = 4000;
 
+// GetMessageTime() is the tick count, in milliseconds, at which the current message was posted,
+// so keystrokes keep their spacing even when the UI thread was busy. It wraps every 49 days
+// and is widened here to the GetTickCount64() clock that the scanner input reads.
+std::uint64_t messageTimeMicros() {
+    const ULONGLONG now = GetTickCount64();
+    const DWORD age = static_cast<DWORD>(now) - static_cast<DWORD>(GetMessageTime());
+    return static_cast<std::uint64_t>(now - age) * 1000;
+}
+
 }  // namespace
 
 class CashSlothGUI {
@@ -657,6 +420,10 @@ public:
 private:
     static LRESULT CALLBACK WindowProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
     static constexpr UINT_PTR kAnimationTimerId = 1;
+    static constexpr UINT kCatalogueReloadedMessage = WM_APP + 1;
+    static constexpr UINT kStyleLoadedMessage = WM_APP + 2;
+    static constexpr UINT kCatalogueLoadedMessage = WM_APP + 3;
+    static constexpr UINT kScannerInputMessage = WM_APP + 4;
 
     void onCreate();
     void onDestroy();
@@ -679,14 +446,21 @@ private:
     void createCreditPanel();
     void createActionButtons();
     void toggleFullscreen();
-    void loadCatalogue();
+    void startLoadingAssets();
+    void onStyleLoaded();
+    void onCatalogueLoaded();
+    void finishStartupTrace();
+    void onCatalogueReloaded();
     void buildCategoryButtons();
     void rebuildProductButtons();
+    bool onSearchInput(std::wstring_view text);
+    void onScannerInput();
+    std::wstring productTitleText() const;
     void updateCategoryHighlight();
     void refreshCart();
     void refreshStatus();
     void showInfo(const std::wstring& text);
-    void addCredit(double amount);
+    void addCredit(Money amount);
     void onAddCredit();
     void onUndoCredit();
     void onRemoveCartItem();
@@ -701,7 +475,7 @@ private:
     void drawProductButton(LPDRAWITEMSTRUCT dis);
     void drawQuickAmountButton(LPDRAWITEMSTRUCT dis);
     void drawActionButton(LPDRAWITEMSTRUCT dis);
-    void drawRoundedButton(LPDRAWITEMSTRUCT dis, COLORREF baseColor, COLORREF textColor, const std::wstring& fallbackText, HFONT font, bool drawText);
+    void drawRoundedButton(LPDRAWITEMSTRUCT dis, COLORREF baseColor, COLORREF textColor, std::wstring_view fallbackText, HFONT font, bool drawText);
     void ensureBackBuffer(HDC referenceDC, int width, int height);
     void releaseBackBuffer();
     void drawPanel(HDC dc, const RECT& area) const;
@@ -717,10 +491,28 @@ private:
     HWND window_ = nullptr;
 
     StyleSheet style_;
-    Catalogue catalogue_;
+    // Replaced as a whole when the watcher has loaded a changed file; only the UI thread
+    // reads it.
+    std::shared_ptr<const Catalogue> catalogue_;
+    std::unique_ptr<CatalogueWatcher> catalogueWatcher_;
+    // Receives every character typed outside the credit field, tells barcode scans from
+    // typing and hands both back through kScannerInputMessage.
+    std::unique_ptr<ScannerInput> scanner_;
+    // Started in onCreate, while the window shows the built-in style and an empty
+    // catalogue; each posts a message to the window when its result is ready. A future is
+    // valid until the UI thread has taken its result.
+    std::future<StyleSheet> styleLoad_;
+    std::future<std::shared_ptr<Catalogue>> catalogueLoad_;
+    // Where the startup timeline is written once the first frame, the style and the
+    // catalogue are on screen; empty unless CASH_SLOTH_TRACE names a file.
+    std::filesystem::path startupTracePath_;
+    bool firstFramePainted_ = false;
     Cart cart_;
-    std::vector<const Category*> categoryOrder_;
-    std::vector<const Article*> visibleProducts_;
+    // Article numbers of the product tiles, in tile order.
+    std::vector<ArticleHandle> visibleProducts_;
+    // While not empty, the product tiles show the articles matching it instead of the
+    // selected category.
+    std::wstring searchQuery_;
     std::filesystem::path exeDirectory_;
     std::wstring catalogueErrorMessage_;
 
@@ -763,8 +555,8 @@ private:
     std::vector<HWND> productButtons_;
     std::vector<HWND> quickAmountButtons_;
 
-    std::vector<double> quickAmounts_;
-    std::vector<std::wstring> cartDisplayLines_;
+    std::vector<Money> quickAmounts_;
+    std::wstring cartLine_;
 
     std::wstring infoText_;
     bool minimalMode_ = false;
@@ -791,7 +583,12 @@ CashSlothGUI::CashSlothGUI(HINSTANCE instance)
     wchar_t modulePath[MAX_PATH]{};
     GetModuleFileNameW(instance_, modulePath, MAX_PATH);
     exeDirectory_ = std::filesystem::path(modulePath).parent_path();
-    style_ = StyleSheet::load(exeDirectory_);
+    wchar_t tracePath[MAX_PATH]{};
+    const DWORD tracePathLength = GetEnvironmentVariableW(L"CASH_SLOTH_TRACE", tracePath, MAX_PATH);
+    if (tracePathLength > 0 && tracePathLength < MAX_PATH) {
+        startupTracePath_ = tracePath;
+        StartupTrace::enable();
+    }
     quickAmounts_ = style_.quickAmounts;
     infoText_ = style_.hero.subtitle;
 }
@@ -852,6 +649,16 @@ int CashSlothGUI::run(int nCmdShow) {
     while (true) {
         const BOOL result = GetMessageW(&msg, nullptr, 0, 0);
         if (result > 0) {
+            // Characters typed outside the credit field go to the scanner input, whichever
+            // button has the focus, which passes on what was typed by hand to the article
+            // search. Should its queue be full, they go to the search directly.
+            if (msg.message == WM_CHAR && msg.hwnd != manualEntry_ && !minimalMode_) {
+                const wchar_t ch = static_cast<wchar_t>(msg.wParam);
+                if ((scanner_ && scanner_->push(Keystroke{static_cast<char16_t>(ch), messageTimeMicros()})) ||
+                    onSearchInput(std::wstring_view(&ch, 1))) {
+                    continue;
+                }
+            }
             TranslateMessage(&msg);
             DispatchMessageW(&msg);
             continue;
@@ -917,6 +724,18 @@ LRESULT CALLBACK CashSlothGUI::WindowProc(HWND hwnd, UINT message, WPARAM wParam
         case WM_TIMER:
             self->onTimer(static_cast<UINT_PTR>(wParam));
             return 0;
+        case kCatalogueReloadedMessage:
+            self->onCatalogueReloaded();
+            return 0;
+        case kStyleLoadedMessage:
+            self->onStyleLoaded();
+            return 0;
+        case kCatalogueLoadedMessage:
+            self->onCatalogueLoaded();
+            return 0;
+        case kScannerInputMessage:
+            self->onScannerInput();
+            return 0;
         case WM_DESTROY:
             self->onDestroy();
             return 0;
@@ -924,20 +743,27 @@ LRESULT CALLBACK CashSlothGUI::WindowProc(HWND hwnd, UINT message, WPARAM wParam
             return DefWindowProcW(hwnd, message, wParam, lParam);
     }
 }
+// The window is built with the built-in style and an empty catalogue, so it appears without
+// waiting for any file; the loaded style and catalogue are swapped in as they arrive.
 void CashSlothGUI::onCreate() {
+    const StartupTrace::Span span("create window");
+    startLoadingAssets();
     initDpiAndResources();
     calculateLayout();
     createInfoAndSummary();
     createCartArea();
     createCreditPanel();
     createActionButtons();
-    loadCatalogue();
+    catalogue_ = std::make_shared<Catalogue>();
+    scanner_ = std::make_unique<ScannerInput>(
+        [] { return static_cast<std::uint64_t>(GetTickCount64()) * 1000; },
+        [window = window_] { PostMessageW(window, kScannerInputMessage, 0, 0); });
     buildCategoryButtons();
     createCategoryFooter();
     rebuildProductButtons();
     refreshCart();
     refreshStatus();
-    showInfo(infoText_);
+    showInfo(L"Katalog wird geladen...");
 
     accentPulse_ = 0.5;
     animationTime_ = 0.0;
@@ -946,6 +772,8 @@ void CashSlothGUI::onCreate() {
 }
 
 void CashSlothGUI::onDestroy() {
+    catalogueWatcher_.reset();
+    scanner_.reset();
     if (animationTimerActive_) {
         KillTimer(window_, kAnimationTimerId);
         animationTimerActive_ = false;
@@ -961,6 +789,7 @@ void CashSlothGUI::onCommand(int controlId, int notificationCode) {
     if (controlId >= ID_CATEGORY_BASE && controlId < ID_CATEGORY_BASE + static_cast<int>(categoryButtons_.size())) {
         if (notificationCode == BN_CLICKED) {
             selectedCategoryIndex_ = controlId - ID_CATEGORY_BASE;
+            searchQuery_.clear();
             updateCategoryHighlight();
             rebuildProductButtons();
         }
@@ -971,9 +800,15 @@ void CashSlothGUI::onCommand(int controlId, int notificationCode) {
         if (notificationCode == BN_CLICKED) {
             int index = controlId - ID_PRODUCT_BASE;
             if (index >= 0 && index < static_cast<int>(visibleProducts_.size())) {
-                cart_.add(*visibleProducts_[static_cast<std::size_t>(index)]);
-                refreshCart();
-                showInfo(L"\"" + toWide(visibleProducts_[static_cast<std::size_t>(index)]->name) + L"\" hinzugefügt");
+                const CatalogueStore& store = catalogue_->store();
+                if (const auto article = store.resolve(visibleProducts_[static_cast<std::size_t>(index)])) {
+                    cart_.add(*catalogue_, *article);
+                    refreshCart();
+                    std::wstring message = L"\"";
+                    message += asWide(catalogue_->displayName(*article));
+                    message += L"\" hinzugefügt";
+                    showInfo(message);
+                }
             }
         }
         return;
@@ -1104,6 +939,12 @@ void CashSlothGUI::onPaint() {
     }
 
     EndPaint(window_, &ps);
+
+    if (!firstFramePainted_) {
+        firstFramePainted_ = true;
+        StartupTrace::mark("first frame");
+        finishStartupTrace();
+    }
 }
 
 void CashSlothGUI::onTimer(UINT_PTR timerId) {
@@ -1211,7 +1052,7 @@ void CashSlothGUI::applyLayout() {
 
     ensureSectionTitle(cartTitle_, L"Warenkorb", layout_.rcCartPanel.left + titleInset, layout_.rcCartPanel.top + titleInset, panelTitleWidth);
     ensureSectionTitle(categoryTitle_, L"Kategorien", layout_.rcCategoryPanel.left + titleInset, layout_.rcCategoryPanel.top + titleInset, layout_.rcCategoryPanel.right - layout_.rcCategoryPanel.left - titleInset * 2);
-    ensureSectionTitle(productTitle_, L"Produkte", layout_.rcProductPanel.left + titleInset, layout_.rcProductPanel.top + titleInset, layout_.rcProductPanel.right - layout_.rcProductPanel.left - titleInset * 2);
+    ensureSectionTitle(productTitle_, productTitleText(), layout_.rcProductPanel.left + titleInset, layout_.rcProductPanel.top + titleInset, layout_.rcProductPanel.right - layout_.rcProductPanel.left - titleInset * 2);
     ensureSectionTitle(creditTitle_, L"Kundengeld", layout_.rcCreditPanel.left + titleInset, layout_.rcCreditPanel.top + titleInset, layout_.rcCreditPanel.right - layout_.rcCreditPanel.left - titleInset * 2);
 
     if (summaryLabel_) {
@@ -1292,7 +1133,7 @@ void CashSlothGUI::applyLayout() {
                 int row = static_cast<int>(i / quickCols);
                 int x = layout_.rcQuickGrid.left + col * (quickWidth + quickGap);
                 int y = quickTop + row * (quickHeight + quickGap);
-                std::wstring text = L"+" + toWide(formatCurrency(quickAmounts_[i]));
+                std::wstring text = L"+" + formatCurrency(quickAmounts_[i]);
                 HWND button = CreateWindowExW(
                     0,
                     L"BUTTON",
@@ -1605,7 +1446,7 @@ void CashSlothGUI::createCreditPanel() {
         int row = static_cast<int>(i / quickCols);
         int x = layout_.rcQuickGrid.left + col * (quickWidth + quickGap);
         int y = quickTop + row * (quickHeight + quickGap);
-        std::wstring text = L"+" + toWide(formatCurrency(quickAmounts_[i]));
+        std::wstring text = L"+" + formatCurrency(quickAmounts_[i]);
         HWND button = CreateWindowExW(
             0,
             L"BUTTON",
@@ -1717,34 +1558,163 @@ void CashSlothGUI::toggleFullscreen() {
     calculateLayout();
 }
 
-void CashSlothGUI::loadCatalogue() {
-    const std::vector<std::filesystem::path> candidates = {
-        exeDirectory_ / "assets" / "cash_sloth_catalog.json",
-        exeDirectory_ / "assets" / "catalog.json",
-        exeDirectory_ / "cash_sloth_catalog.json",
-        exeDirectory_ / "cash_sloth_catalog_v25.11.json",
-        exeDirectory_ / "cash_sloth_catalog_v25.10.json",
-        exeDirectory_ / "konfiguration.json",
-        exeDirectory_ / "Configs" / "konfiguration.json",
-        exeDirectory_ / "configs" / "konfiguration.json"
-    };
+// Both files are looked for and read on their own threads, so the style does not wait for a
+// large catalogue. The tasks get copies of what they need and never touch the window object;
+// the futures' destructors wait for them when the window goes away.
+void CashSlothGUI::startLoadingAssets() {
+    HWND window = window_;
+    styleLoad_ = std::async(std::launch::async, [window, baseDir = exeDirectory_] {
+        StyleSheet sheet;
+        {
+            const StartupTrace::Span span("load style");
+            sheet = StyleSheet::load(baseDir);
+        }
+        PostMessageW(window, kStyleLoadedMessage, 0, 0);
+        return sheet;
+    });
+    catalogueLoad_ = std::async(std::launch::async, [window, baseDir = exeDirectory_] {
+        std::shared_ptr<Catalogue> loaded;
+        {
+            const StartupTrace::Span span("load catalogue");
+            std::vector<std::filesystem::path> found;
+            {
+                const StartupTrace::Span findSpan("find catalogue");
+                found = existingFiles(catalogueCandidates(baseDir));
+            }
+            auto catalogue = std::make_shared<Catalogue>();
+            for (const auto& candidate : found) {
+                if (catalogue->loadFromFile(candidate)) {
+                    loaded = std::move(catalogue);
+                    break;
+                }
+            }
+        }
+        PostMessageW(window, kCatalogueLoadedMessage, 0, 0);
+        return loaded;
+    });
+}
+
+// Fonts and brushes are made again from the loaded style. refreshFonts() only remakes the
+// fonts when the scale changes, so they are released here first. The quick-amount buttons
+// are recreated, as their labels come from the style.
+void CashSlothGUI::onStyleLoaded() {
+    if (!styleLoad_.valid()) {
+        return;
+    }
+    {
+        const StartupTrace::Span span("apply style");
+        style_ = styleLoad_.get();
+        quickAmounts_ = style_.quickAmounts;
+        releaseGdiResources();
+        initDpiAndResources();
+        for (HWND button : quickAmountButtons_) {
+            DestroyWindow(button);
+        }
+        quickAmountButtons_.clear();
+        calculateLayout();
+        if (infoLabel_) {
+            SendMessageW(infoLabel_, WM_SETFONT, reinterpret_cast<WPARAM>(smallFont_), FALSE);
+        }
+        RedrawWindow(window_, nullptr, nullptr, RDW_INVALIDATE | RDW_ALLCHILDREN);
+    }
+    finishStartupTrace();
+}
 
-    bool loaded = false;
-    for (const auto& candidate : candidates) {
-        if (catalogue_.loadFromFile(candidate)) {
-            infoText_ = std::wstring(L"Katalog geladen aus: ") + candidate.wstring();
+// Takes over the catalogue from the startup load, or the built-in one when no candidate could
+// be read, and watches its file so that price changes during service are picked up without a
+// restart.
+void CashSlothGUI::onCatalogueLoaded() {
+    if (!catalogueLoad_.valid()) {
+        return;
+    }
+    {
+        const StartupTrace::Span span("apply catalogue");
+        std::shared_ptr<Catalogue> catalogue = catalogueLoad_.get();
+        const bool loaded = catalogue != nullptr;
+        if (loaded) {
+            infoText_ = std::wstring(L"Katalog geladen aus: ") + catalogue->loadedFile().wstring();
             catalogueErrorMessage_.clear();
-            loaded = true;
-            break;
+        } else {
+            catalogue = std::make_shared<Catalogue>();
+            catalogue->loadDefault();
+            infoText_ = L"Standardkatalog geladen (assets/cash_sloth_catalog.json nicht gefunden).";
+            catalogueErrorMessage_ = L"Produktkatalog konnte nicht geladen werden. Es wird ein Standardkatalog verwendet.";
+        }
+        catalogue_ = std::move(catalogue);
+        scanner_->setCatalogue(catalogue_);
+
+        catalogueWatcher_.reset();
+        if (loaded) {
+            HWND window = window_;
+            catalogueWatcher_ = std::make_unique<CatalogueWatcher>(catalogue_, [window] {
+                PostMessageW(window, kCatalogueReloadedMessage, 0, 0);
+            });
         }
+
+        updateHeaderVisibility();
+        selectedCategoryIndex_ = 0;
+        buildCategoryButtons();
+        rebuildProductButtons();
+        showInfo(infoText_);
+        InvalidateRect(window_, nullptr, FALSE);
     }
-    if (!loaded) {
-        catalogue_.loadDefault();
-        infoText_ = L"Standardkatalog geladen (assets/cash_sloth_catalog.json nicht gefunden).";
-        catalogueErrorMessage_ = L"Produktkatalog konnte nicht geladen werden. Es wird ein Standardkatalog verwendet.";
+    finishStartupTrace();
+}
+
+// Writes the startup timeline once the first frame has been painted and both files have been
+// applied, whichever of them comes last.
+void CashSlothGUI::finishStartupTrace() {
+    if (startupTracePath_.empty() || !firstFramePainted_ || styleLoad_.valid() || catalogueLoad_.valid()) {
+        return;
     }
+    StartupTrace::mark("startup complete");
+    if (!StartupTrace::writeTo(startupTracePath_)) {
+        showInfo(L"Startprotokoll konnte nicht geschrieben werden: " + startupTracePath_.wstring());
+    }
+    startupTracePath_.clear();
+}
 
-    updateHeaderVisibility();
+// Runs on the UI thread, so the swap cannot race with drawing or input. The watcher has
+// already diffed the new catalogue against the current one and handed it the current
+// article handles, so the visible tiles and the cart lines keep referring to the same
+// articles and all that is left here is the pointer swap. Only what the diff touches is
+// rebuilt: a new price or name repaints its tile, and the category buttons are recreated
+// only when categories were added, removed or reordered. Search results are looked up again
+// in the new catalogue.
+void CashSlothGUI::onCatalogueReloaded() {
+    std::optional<CatalogueReload> reload = catalogueWatcher_ ? catalogueWatcher_->takeReloaded() : std::nullopt;
+    if (!reload) {
+        return;
+    }
+    const CatalogueDiff& diff = reload->diff;
+    catalogue_ = std::move(reload->catalogue);
+    scanner_->setCatalogue(catalogue_);
+
+    if (diff.categoriesChanged) {
+        const auto selected = std::find(diff.categorySources.begin(), diff.categorySources.end(),
+                                        static_cast<std::size_t>(selectedCategoryIndex_));
+        selectedCategoryIndex_ = selected != diff.categorySources.end() ? static_cast<int>(selected - diff.categorySources.begin()) : 0;
+        buildCategoryButtons();
+        rebuildProductButtons();
+    } else {
+        const auto selected = static_cast<std::size_t>(selectedCategoryIndex_);
+        const bool tilesMove = std::any_of(diff.changes.begin(), diff.changes.end(), [&](const ArticleChange& change) {
+            const bool arrives = change.kind == ArticleChange::Kind::Added || change.moved;
+            const bool leaves = change.kind == ArticleChange::Kind::Removed || change.moved;
+            return (arrives && change.toCategory == selected) || (leaves && change.fromCategory == selected);
+        });
+        if (tilesMove || categoryButtons_.empty() || !searchQuery_.empty()) {
+            rebuildProductButtons();
+        } else {
+            for (const ArticleChange& change : diff.changes) {
+                if (change.kind == ArticleChange::Kind::Updated && change.toCategory == selected &&
+                    change.toIndex < productButtons_.size()) {
+                    InvalidateRect(productButtons_[change.toIndex], nullptr, TRUE);
+                }
+            }
+        }
+    }
+    showInfo(std::wstring(L"Katalog aktualisiert aus: ") + catalogue_->loadedFile().wstring());
 }
 
 void CashSlothGUI::buildCategoryButtons() {
@@ -1752,14 +1722,12 @@ void CashSlothGUI::buildCategoryButtons() {
         DestroyWindow(button);
     }
     categoryButtons_.clear();
-    categoryOrder_.clear();
 
-    const auto& categories = catalogue_.categories();
-    categoryOrder_.reserve(categories.size());
+    const CatalogueStore& store = catalogue_->store();
 
     const int titleInset = std::max(scale(6), layout_.metrics.gap / 2);
     ensureSectionTitle(categoryTitle_, L"Kategorien", layout_.rcCategoryPanel.left + titleInset, layout_.rcCategoryPanel.top + titleInset, layout_.rcCategoryPanel.right - layout_.rcCategoryPanel.left - titleInset * 2);
-    ensureSectionTitle(productTitle_, L"Produkte", layout_.rcProductPanel.left + titleInset, layout_.rcProductPanel.top + titleInset, layout_.rcProductPanel.right - layout_.rcProductPanel.left - titleInset * 2);
+    ensureSectionTitle(productTitle_, productTitleText(), layout_.rcProductPanel.left + titleInset, layout_.rcProductPanel.top + titleInset, layout_.rcProductPanel.right - layout_.rcProductPanel.left - titleInset * 2);
 
     int buttonHeight = layout_.metrics.categoryHeight;
     int buttonSpacing = layout_.metrics.categorySpacing;
@@ -1768,16 +1736,15 @@ void CashSlothGUI::buildCategoryButtons() {
     int availableBottom = layout_.rcCategoryFooter.top - layout_.metrics.gap;
     int x = layout_.rcCategoryPanel.left + layout_.metrics.gap;
 
-    for (std::size_t i = 0; i < categories.size(); ++i) {
+    for (std::size_t i = 0; i < store.categoryCount(); ++i) {
         if (y + buttonHeight > availableBottom) {
             break;
         }
-        categoryOrder_.push_back(&categories[i]);
-        std::wstring text = toWide(categories[i].name);
+        const std::wstring_view text = asWide(catalogue_->displayCategoryName(i));
         HWND button = CreateWindowExW(
             0,
             L"BUTTON",
-            text.c_str(),
+            text.data(),
             WS_CHILD | WS_VISIBLE | WS_TABSTOP | BS_OWNERDRAW,
             x,
             y,
@@ -1806,13 +1773,10 @@ void CashSlothGUI::rebuildProductButtons() {
     productButtons_.clear();
     visibleProducts_.clear();
 
-    if (categoryOrder_.empty()) {
+    if (categoryButtons_.empty()) {
         return;
     }
 
-    const Category* category = categoryOrder_[static_cast<std::size_t>(selectedCategoryIndex_)];
-    visibleProducts_.reserve(category->articles.size());
-
     const int tilePadding = layout_.metrics.gap;
     const int availableWidth = layout_.rcProductPanel.right - layout_.rcProductPanel.left - tilePadding * 2;
     const int minTileWidth = scale(160);
@@ -1833,9 +1797,24 @@ void CashSlothGUI::rebuildProductButtons() {
     const int startX = layout_.rcProductPanel.left + tilePadding;
     const int startY = layout_.rcProductPanel.top + tilePadding;
 
-    for (const Article& article : category->articles) {
-        visibleProducts_.push_back(&article);
-        const std::size_t index = visibleProducts_.size() - 1;
+    // Search results are cut to the tiles that fit into the panel.
+    const CatalogueStore& store = catalogue_->store();
+    if (!searchQuery_.empty()) {
+        const int rows = std::max(1, static_cast<int>(layout_.rcProductPanel.bottom - startY) / (tileHeight + tilePadding));
+        for (const std::size_t article : catalogue_->search(toNarrow(searchQuery_), static_cast<std::size_t>(rows * columns))) {
+            visibleProducts_.push_back(store.handle(article));
+        }
+    } else {
+        const auto category = static_cast<std::size_t>(selectedCategoryIndex_);
+        for (std::size_t article = store.firstArticle(category); article < store.firstArticle(category + 1); ++article) {
+            visibleProducts_.push_back(store.handle(article));
+        }
+    }
+    if (productTitle_) {
+        SetWindowTextW(productTitle_, productTitleText().c_str());
+    }
+
+    for (std::size_t index = 0; index < visibleProducts_.size(); ++index) {
         const int row = static_cast<int>(index / static_cast<std::size_t>(columns));
         const int col = static_cast<int>(index % static_cast<std::size_t>(columns));
         const int x = startX + col * (tileWidth + tilePadding);
@@ -1851,7 +1830,7 @@ void CashSlothGUI::rebuildProductButtons() {
             tileWidth,
             tileHeight,
             window_,
-            reinterpret_cast<HMENU>(ID_PRODUCT_BASE + static_cast<int>(visibleProducts_.size() - 1)),
+            reinterpret_cast<HMENU>(ID_PRODUCT_BASE + static_cast<int>(index)),
             instance_,
             nullptr);
         SendMessageW(button, WM_SETFONT, reinterpret_cast<WPARAM>(tileFont_), FALSE);
@@ -1859,6 +1838,92 @@ void CashSlothGUI::rebuildProductButtons() {
     }
 }
 
+// Applies a run of typed characters to the name search, a single WM_CHAR or the typed text
+// of a scanner batch: Backspace takes back a character, Escape returns to the selected
+// category, other control characters are skipped. The tiles are rebuilt once for the whole
+// run. Returns whether any character was used.
+bool CashSlothGUI::onSearchInput(std::wstring_view text) {
+    if (minimalMode_ || !catalogue_) {
+        return false;
+    }
+    bool used = false;
+    for (const wchar_t ch : text) {
+        if (ch == L'\x1B' || ch == L'\b') {
+            if (searchQuery_.empty()) {
+                continue;
+            }
+            if (ch == L'\x1B') {
+                searchQuery_.clear();
+            } else {
+                const bool lowSurrogate = searchQuery_.back() >= 0xDC00 && searchQuery_.back() <= 0xDFFF;
+                searchQuery_.pop_back();
+                if (lowSurrogate && !searchQuery_.empty()) {
+                    searchQuery_.pop_back();
+                }
+            }
+        } else if (ch < L' ' || (ch == L' ' && searchQuery_.empty())) {
+            continue;
+        } else {
+            searchQuery_.push_back(ch);
+        }
+        used = true;
+    }
+    if (used) {
+        rebuildProductButtons();
+    }
+    return used;
+}
+
+// Everything scanned since the last message is added in one go, so the cart list is filled
+// once per batch however fast the scans come.
+void CashSlothGUI::onScannerInput() {
+    if (!scanner_) {
+        return;
+    }
+    const ScanBatch batch = scanner_->takeBatch();
+    onSearchInput(asWide(batch.typed));
+
+    const CatalogueStore& store = catalogue_->store();
+    std::size_t added = 0;
+    std::size_t lastArticle = 0;
+    for (const ArticleHandle handle : batch.articles) {
+        if (const auto article = store.resolve(handle)) {
+            cart_.add(*catalogue_, *article);
+            lastArticle = *article;
+            ++added;
+        }
+    }
+    if (added > 0) {
+        refreshCart();
+    }
+
+    if (!batch.unknownCodes.empty()) {
+        showInfo(L"Unbekannter Barcode: " + toWide(batch.unknownCodes.back()));
+        MessageBeep(MB_ICONWARNING);
+    } else if (added == 1) {
+        std::wstring message = L"\"";
+        message += asWide(catalogue_->displayName(lastArticle));
+        message += L"\" gescannt";
+        showInfo(message);
+    } else if (added > 1) {
+        showInfo(std::to_wstring(added) + L" Artikel gescannt");
+    }
+}
+
+std::wstring CashSlothGUI::productTitleText() const {
+    if (catalogueLoad_.valid()) {
+        return L"Produkte (Katalog wird geladen...)";
+    }
+    if (searchQuery_.empty()) {
+        return L"Produkte";
+    }
+    std::wstring title = L"Suche: " + searchQuery_;
+    if (visibleProducts_.empty()) {
+        title += L" (keine Treffer)";
+    }
+    return title;
+}
+
 void CashSlothGUI::updateCategoryHighlight() {
     for (HWND button : categoryButtons_) {
         InvalidateRect(button, nullptr, TRUE);
@@ -1871,16 +1936,25 @@ void CashSlothGUI::refreshCart() {
     }
     SendMessageW(cartList_, WM_SETREDRAW, FALSE, 0);
     SendMessageW(cartList_, LB_RESETCONTENT, 0, 0);
-    cartDisplayLines_.clear();
 
-    const auto& items = cart_.items();
+    // Lines are composed in one buffer that keeps its capacity from refresh to refresh.
+    const auto appendNumber = [this](std::int64_t value) {
+        char digits[24];
+        const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+        cartLine_.append(digits, result.ptr);
+    };
     std::size_t index = 1;
-    for (const CartItem& item : items) {
-        std::wstringstream ws;
-        ws << index << L". " << toWide(item.article->name) << L"  x" << item.quantity
-           << L"  " << toWide(formatCurrency(item.article->price * static_cast<double>(item.quantity)));
-        const std::wstring line = ws.str();
-        SendMessageW(cartList_, LB_ADDSTRING, 0, reinterpret_cast<LPARAM>(line.c_str()));
+    for (const CartItem& item : cart_.items()) {
+        cartLine_.clear();
+        appendNumber(static_cast<std::int64_t>(index));
+        cartLine_ += L". ";
+        cartLine_ += item.name;
+        cartLine_ += L"  x";
+        appendNumber(item.quantity);
+        cartLine_ += L"  ";
+        char16_t price[kPriceLabelCapacity];
+        cartLine_ += asWide(std::u16string_view(price, writePriceLabel((item.price * item.quantity).rappen(), price)));
+        SendMessageW(cartList_, LB_ADDSTRING, 0, reinterpret_cast<LPARAM>(cartLine_.c_str()));
         ++index;
     }
     SendMessageW(cartList_, WM_SETREDRAW, TRUE, 0);
@@ -1896,9 +1970,13 @@ void CashSlothGUI::refreshStatus() {
     if (minimalMode_) {
         return;
     }
-    std::wstring summary = L"Summe: " + toWide(formatCurrency(cart_.total()));
-    summary += L"    Kundengeld: " + toWide(formatCurrency(cart_.credit()));
-    summary += L"    Rückgeld: " + toWide(formatCurrency(cart_.change()));
+    const Money total = cart_.total();
+    std::wstring summary = L"Summe: " + formatCurrency(total);
+    if (cart_.cashTotal() != total) {
+        summary += L" (bar " + formatCurrency(cart_.cashTotal()) + L")";
+    }
+    summary += L"    Kundengeld: " + formatCurrency(cart_.credit());
+    summary += L"    Rückgeld: " + formatCurrency(cart_.change());
     summary += L"    Build " + std::wstring(kAppVersion);
     SetWindowTextW(summaryLabel_, summary.c_str());
 }
@@ -1916,13 +1994,13 @@ void CashSlothGUI::showInfo(const std::wstring& text) {
     }
 }
 
-void CashSlothGUI::addCredit(double amount) {
+void CashSlothGUI::addCredit(Money amount) {
     if (minimalMode_) {
         return;
     }
     cart_.addCredit(amount);
     refreshCart();
-    std::wstring message = L"Kundengeld +" + toWide(formatCurrency(amount));
+    std::wstring message = L"Kundengeld +" + formatCurrency(amount);
     showInfo(message);
 }
 
@@ -1932,9 +2010,8 @@ void CashSlothGUI::onAddCredit() {
     }
     wchar_t buffer[64]{};
     GetWindowTextW(manualEntry_, buffer, static_cast<int>(std::size(buffer)));
-    std::string text = toNarrow(buffer);
-    const std::optional<double> amount = parseAmount(text);
-    if (!amount.has_value() || amount.value() <= 0.0) {
+    const std::optional<Money> amount = parseAmount(buffer);
+    if (!amount.has_value() || amount.value() <= Money() || amount.value() >= kMaxPrice) {
         MessageBoxW(window_, L"Bitte einen gültigen Betrag eingeben.", L"Hinweis", MB_ICONWARNING | MB_OK);
         SetFocus(manualEntry_);
         return;
@@ -1954,7 +2031,7 @@ void CashSlothGUI::onUndoCredit() {
         return;
     }
     refreshCart();
-    std::wstring message = L"Kundengeld -" + toWide(formatCurrency(undone.value()));
+    std::wstring message = L"Kundengeld -" + formatCurrency(undone.value());
     showInfo(message);
 }
 
@@ -1980,15 +2057,15 @@ void CashSlothGUI::onPay() {
         MessageBoxW(window_, L"Der Warenkorb ist leer.", L"Hinweis", MB_ICONINFORMATION | MB_OK);
         return;
     }
-    const double total = cart_.total();
-    if (cart_.credit() + 1e-9 < total) {
+    const Money total = cart_.cashTotal();
+    if (cart_.credit() < total) {
         std::wstring message = L"Kundengeld nicht ausreichend.\nFehlender Betrag: ";
-        message += toWide(formatCurrency(total - cart_.credit()));
+        message += formatCurrency(total - cart_.credit());
         MessageBoxW(window_, message.c_str(), L"Hinweis", MB_ICONWARNING | MB_OK);
         return;
     }
-    double change = cart_.change();
-    std::wstring message = L"Zahlung erfolgreich!\nRückgeld: " + toWide(formatCurrency(change));
+    const Money change = cart_.change();
+    std::wstring message = L"Zahlung erfolgreich!\nRückgeld: " + formatCurrency(change);
     MessageBoxW(window_, message.c_str(), L"Bezahlen", MB_ICONINFORMATION | MB_OK);
     cart_.clear();
     refreshCart();
@@ -2004,9 +2081,9 @@ void CashSlothGUI::drawCategoryButton(LPDRAWITEMSTRUCT dis) {
     } else if (selected) {
         base = lighten(base, 0.04);
     }
-    std::wstring text;
-    if (index >= 0 && index < static_cast<int>(categoryOrder_.size())) {
-        text = toWide(categoryOrder_[static_cast<std::size_t>(index)]->name);
+    std::wstring_view text;
+    if (index >= 0 && index < static_cast<int>(categoryButtons_.size())) {
+        text = asWide(catalogue_->displayCategoryName(static_cast<std::size_t>(index)));
     }
     drawRoundedButton(dis, base, style_.palette.textPrimary, text, buttonFont_, true);
 }
@@ -2023,7 +2100,10 @@ void CashSlothGUI::drawProductButton(LPDRAWITEMSTRUCT dis) {
         return;
     }
 
-    const Article* article = visibleProducts_[static_cast<std::size_t>(index)];
+    const auto article = catalogue_->store().resolve(visibleProducts_[static_cast<std::size_t>(index)]);
+    if (!article) {
+        return;
+    }
     HDC dc = dis->hDC;
     RECT rc = dis->rcItem;
     InflateRect(&rc, -scale(16), -scale(14));
@@ -2036,13 +2116,13 @@ void CashSlothGUI::drawProductButton(LPDRAWITEMSTRUCT dis) {
     HFONT oldFont = reinterpret_cast<HFONT>(SelectObject(dc, tileFont_));
     SetTextColor(dc, style_.palette.textPrimary);
     SetBkMode(dc, TRANSPARENT);
-    const std::wstring name = toWide(article->name);
-    DrawTextW(dc, name.c_str(), -1, &nameRect, DT_CENTER | DT_WORDBREAK | DT_END_ELLIPSIS);
+    const std::wstring_view name = asWide(catalogue_->displayName(*article));
+    DrawTextW(dc, name.data(), static_cast<int>(name.size()), &nameRect, DT_CENTER | DT_WORDBREAK | DT_END_ELLIPSIS);
 
     SelectObject(dc, buttonFont_);
     SetTextColor(dc, style_.palette.accentSoft);
-    const std::wstring price = toWide(formatCurrency(article->price));
-    DrawTextW(dc, price.c_str(), -1, &priceRect, DT_CENTER | DT_VCENTER | DT_SINGLELINE | DT_NOPREFIX);
+    const std::wstring_view price = asWide(catalogue_->displayPrice(*article));
+    DrawTextW(dc, price.data(), static_cast<int>(price.size()), &priceRect, DT_CENTER | DT_VCENTER | DT_SINGLELINE | DT_NOPREFIX);
 
     SelectObject(dc, oldFont);
 }
@@ -2068,7 +2148,7 @@ void CashSlothGUI::drawActionButton(LPDRAWITEMSTRUCT dis) {
     drawRoundedButton(dis, base, style_.palette.textPrimary, buffer, buttonFont_, true);
 }
 
-void CashSlothGUI::drawRoundedButton(LPDRAWITEMSTRUCT dis, COLORREF baseColor, COLORREF textColor, const std::wstring& fallbackText, HFONT font, bool drawText) {
+void CashSlothGUI::drawRoundedButton(LPDRAWITEMSTRUCT dis, COLORREF baseColor, COLORREF textColor, std::wstring_view fallbackText, HFONT font, bool drawText) {
     HDC dc = dis->hDC;
     RECT rc = dis->rcItem;
     const int radius = scale(style_.metrics.buttonRadius);
@@ -2100,13 +2180,10 @@ void CashSlothGUI::drawRoundedButton(LPDRAWITEMSTRUCT dis, COLORREF baseColor, C
         return;
     }
 
-    const wchar_t* textPtr = nullptr;
     wchar_t buffer[256]{};
-    if (!fallbackText.empty()) {
-        textPtr = fallbackText.c_str();
-    } else {
-        GetWindowTextW(dis->hwndItem, buffer, static_cast<int>(std::size(buffer)));
-        textPtr = buffer;
+    std::wstring_view text = fallbackText;
+    if (text.empty()) {
+        text = std::wstring_view(buffer, static_cast<std::size_t>(GetWindowTextW(dis->hwndItem, buffer, static_cast<int>(std::size(buffer)))));
     }
 
     RECT textRect = rc;
@@ -2114,7 +2191,7 @@ void CashSlothGUI::drawRoundedButton(LPDRAWITEMSTRUCT dis, COLORREF baseColor, C
     SetBkMode(dc, TRANSPARENT);
     SetTextColor(dc, textColor);
     HFONT oldFont = reinterpret_cast<HFONT>(SelectObject(dc, font));
-    DrawTextW(dc, textPtr, -1, &textRect, DT_CENTER | DT_VCENTER | DT_SINGLELINE | DT_NOPREFIX | DT_END_ELLIPSIS);
+    DrawTextW(dc, text.data(), static_cast<int>(text.size()), &textRect, DT_CENTER | DT_VCENTER | DT_SINGLELINE | DT_NOPREFIX | DT_END_ELLIPSIS);
     SelectObject(dc, oldFont);
 }
 
@@ -2332,6 +2409,7 @@ void CashSlothGUI::ensureSectionTitle(HWND& handle, const std::wstring& text, in
     } else {
         SetWindowTextW(handle, text.c_str());
         MoveWindow(handle, x, y, width, height, FALSE);
+        SendMessageW(handle, WM_SETFONT, reinterpret_cast<WPARAM>(headingFont_), FALSE);
     }
 }
 
@@ -0,0 +1,290 @@
+// Checks JsonDocument against the JsonValue tree: random documents read back the same through
+// both, in copying and in-place mode, malformed text fails at the same offset, and a
+// document without escaped strings is built in one allocation and freed in one release.
+// Exits with the number of failed checks.
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "cash_sloth_json.h"
+#include "cash_sloth_json_document.h"
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+std::atomic<std::size_t> releases{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* block = std::malloc(size == 0 ? 1 : size)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    if (pointer) {
+        releases.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+namespace {
+
+using cashsloth::JsonDocument;
+using cashsloth::JsonNode;
+using cashsloth::JsonValue;
+
+int failures = 0;
+
+void check(bool ok, std::string_view what) {
+    if (!ok) {
+        ++failures;
+        std::cerr << "FAILED: " << what << '\n';
+    }
+}
+
+// Member order and duplicate keys aside, which the std::map in JsonValue does not keep.
+bool same(const JsonNode& node, const JsonValue& value) {
+    if (value.isNull()) {
+        return node.isNull();
+    }
+    if (value.isBool()) {
+        return node.isBool() && node.asBool() == value.asBool();
+    }
+    if (value.isNumber()) {
+        return node.isNumber() && node.asNumber() == value.asNumber();
+    }
+    if (value.isString()) {
+        return node.isString() && node.asString() == value.asString();
+    }
+    if (value.isArray()) {
+        if (!node.isArray() || node.asArray().size() != value.asArray().size()) {
+            return false;
+        }
+        auto element = node.asArray().begin();
+        for (const JsonValue& expected : value.asArray()) {
+            if (!same(*element++, expected)) {
+                return false;
+            }
+        }
+        return element == node.asArray().end();
+    }
+    if (!node.isObject() || node.asObject().size() != value.asObject().size()) {
+        return false;
+    }
+    for (const auto& [key, expected] : value.asObject()) {
+        const auto member = node.asObject().find(key);
+        if (member == node.asObject().end() || !same(member->second, expected)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class RandomDocument {
+public:
+    explicit RandomDocument(std::uint64_t seed) : random_(seed) {}
+
+    std::string next() {
+        std::string text;
+        value(text, 0);
+        return text;
+    }
+
+private:
+    void value(std::string& out, int depth) {
+        switch (random_() % (depth < 4 ? 7 : 5)) {
+        case 0:
+            out += "null";
+            break;
+        case 1:
+            out += random_() % 2 ? "true" : "false";
+            break;
+        case 2:
+            number(out);
+            break;
+        case 3:
+        case 4:
+            string(out);
+            break;
+        case 5: {
+            out += '[';
+            const std::size_t count = random_() % 6;
+            for (std::size_t i = 0; i < count; ++i) {
+                out += i == 0 ? "" : ", ";
+                value(out, depth + 1);
+            }
+            out += ']';
+            break;
+        }
+        default: {
+            out += "{ ";
+            const std::size_t count = random_() % 6;
+            for (std::size_t i = 0; i < count; ++i) {
+                out += i == 0 ? "\"k" : ",\n\"k";
+                out += std::to_string(i);
+                out += "\": ";
+                value(out, depth + 1);
+            }
+            out += '}';
+            break;
+        }
+        }
+    }
+
+    void number(std::string& out) {
+        constexpr std::string_view kNumbers[] = {"0", "-0", "3.50", "6.5", "-12.5e1", "1E-3", "9223372036854775807",
+                                                 "12345678901234567890123", "0.1", "2.2250738585072014e-308"};
+        out += kNumbers[random_() % std::size(kNumbers)];
+    }
+
+    // Plain text, UTF-8 and every kind of escape, including a surrogate pair.
+    void string(std::string& out) {
+        constexpr std::string_view kPieces[] = {"Tee", " ", "Grüntee", "Café", "\\n", "\\\"", "\\\\", "\\/",
+                                                "\\u00e4", "\\ud83d\\ude00", "\\t", "咖啡", ",", ":", "[{"};
+        out += '"';
+        const std::size_t count = random_() % 5;
+        for (std::size_t i = 0; i < count; ++i) {
+            out += kPieces[random_() % std::size(kPieces)];
+        }
+        out += '"';
+    }
+
+    std::mt19937_64 random_;
+};
+
+void testRandomDocuments() {
+    RandomDocument generator(20251016);
+    for (int i = 0; i < 20000; ++i) {
+        const std::string text = generator.next();
+        const JsonValue tree = cashsloth::JsonParser(text).parse();
+        if (!same(JsonDocument::parse(text).root(), tree) || !same(JsonDocument::parseInPlace(text).root(), tree)) {
+            check(false, "document matches the tree for " + text);
+            return;
+        }
+    }
+}
+
+void testAccessors() {
+    const std::string text = R"({"colors": {"primary": [1, 2, 3]}, "name": "a\"b", "name": "second", "on": true})";
+    const JsonDocument document = JsonDocument::parse(text);
+    const JsonNode root = document.root();
+    check(root.isObject() && root.asObject().size() == 4, "object with four members");
+    const auto colors = root.asObject().find("colors");
+    check(colors != root.asObject().end() && colors->second.isObject(), "find nested object");
+    const auto primary = colors->second.asObject().find("primary");
+    check(primary->second.isArray() && primary->second.asArray().size() == 3, "array of three");
+    check(primary->second.asArray()[2].asNumber() == 3.0, "array element by position");
+    check(root.asObject().find("name")->second.asString() == "a\"b", "first of duplicate keys wins");
+    check(root.asObject().find("missing") == root.asObject().end(), "missing key");
+    check(root.asObject().find("on")->second.asBool(), "bool member");
+    check(root.asObject().find("on")->second.asNumber(7.0) == 7.0, "fallback for the wrong type");
+    check(root.asObject().find("on")->second.asString().empty(), "no string for the wrong type");
+
+    const JsonDocument empty = JsonDocument::parse(" [ [], {} ] ");
+    check(empty.root().asArray().size() == 2 && (*empty.root().asArray().begin()).asArray().empty(),
+          "empty containers");
+}
+
+void testInPlace() {
+    const std::string text = R"(["plain", "esc\naped"])";
+    const JsonDocument document = JsonDocument::parseInPlace(text);
+    const std::string_view plain = document.root().asArray()[0].asString();
+    const std::string_view escaped = document.root().asArray()[1].asString();
+    check(plain.data() >= text.data() && plain.data() < text.data() + text.size(), "plain string borrowed");
+    check(escaped == "esc\naped" && (escaped.data() < text.data() || escaped.data() >= text.data() + text.size()),
+          "escaped string copied");
+    const JsonDocument copied = JsonDocument::parse(text);
+    const std::string_view owned = copied.root().asArray()[0].asString();
+    check(owned == "plain" && (owned.data() < text.data() || owned.data() >= text.data() + text.size()),
+          "parse() copies every string");
+}
+
+void testErrors() {
+    for (const std::string_view text : {"", "[1, 2", "{\"a\" 1}", "[1,]", "\"\\x\"", "[tru]", "01", "{} x",
+                                        "\"\xC3\x28\"", "[\"a\nb\"]"}) {
+        const cashsloth::JsonResult<JsonValue> tree = cashsloth::JsonParser(text).tryParse();
+        const cashsloth::JsonResult<JsonDocument> document = JsonDocument::tryParse(text);
+        const cashsloth::JsonResult<JsonDocument> inPlace = JsonDocument::tryParseInPlace(text);
+        check(!tree && !document && !inPlace, "malformed text rejected: " + std::string(text));
+        if (!tree && !document && !inPlace) {
+            check(document.error().code == tree.error().code && document.error().offset == tree.error().offset &&
+                      inPlace.error().offset == tree.error().offset,
+                  "same error as the parser: " + std::string(text));
+        }
+    }
+    bool threw = false;
+    try {
+        JsonDocument::parse("[1, 2");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    check(threw, "parse() throws on malformed text");
+}
+
+// Allocations made while building a document of `elements` articles without escapes, and
+// the releases when it is destroyed.
+std::size_t allocationsToBuild(std::size_t elements, std::size_t& freed) {
+    std::string text = "{\"articles\": [";
+    for (std::size_t i = 0; i < elements; ++i) {
+        text += i == 0 ? "" : ", ";
+        text += R"({"name": "Grüntee", "price": 3.50, "tags": ["a", "b"]})";
+    }
+    text += "]}";
+    const std::size_t before = allocations.load();
+    std::optional<JsonDocument> document = JsonDocument::parse(text);
+    const std::size_t built = allocations.load() - before;
+    const std::size_t releasedBefore = releases.load();
+    document.reset();
+    freed = releases.load() - releasedBefore;
+    return built;
+}
+
+void testAllocations() {
+    std::size_t freedSmall = 0;
+    std::size_t freedLarge = 0;
+    const std::size_t small = allocationsToBuild(10, freedSmall);
+    const std::size_t large = allocationsToBuild(10000, freedLarge);
+    check(small == 1 && large == 1,
+          "a document is built with one allocation, got " + std::to_string(small) + " and " + std::to_string(large));
+    check(freedSmall == 1 && freedLarge == 1, "a document is freed in one release");
+}
+
+}  // namespace
+
+int main() {
+    testRandomDocuments();
+    testAccessors();
+    testInPlace();
+    testErrors();
+    testAllocations();
+    if (failures == 0) {
+        std::cout << "json_document_test: all checks passed\n";
+    }
+    return failures;
+}
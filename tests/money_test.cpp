@@ -0,0 +1,285 @@
+// Checks Money, which holds every price, credit and cart total: parse and format round-trip,
+// checked arithmetic refuses to overflow, cash rounding goes to the nearest 5 Rappen, and
+// random carts come to the same totals as the double arithmetic the till used before.
+// Exits with the number of failed checks.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cash_sloth_money.h"
+
+namespace {
+
+using cashsloth::Money;
+
+constexpr std::int64_t kMax = std::numeric_limits<std::int64_t>::max();
+constexpr std::int64_t kMin = std::numeric_limits<std::int64_t>::min();
+
+int failures = 0;
+
+void check(bool ok, std::string_view what) {
+    if (!ok) {
+        ++failures;
+        std::cerr << "FAILED: " << what << '\n';
+    }
+}
+
+std::string format(Money amount) {
+    char text[cashsloth::kMoneyTextCapacity];
+    return std::string(text, amount.format(text));
+}
+
+bool parsesTo(std::string_view text, std::int64_t rappen) {
+    const std::optional<Money> parsed = Money::parse(text);
+    return parsed.has_value() && parsed->rappen() == rappen;
+}
+
+template <typename Operation>
+bool overflows(Operation operation) {
+    try {
+        operation();
+    } catch (const std::overflow_error&) {
+        return true;
+    }
+    return false;
+}
+
+void testRoundTrip() {
+    std::mt19937_64 random(20251016);
+    for (int i = 0; i < 1000000; ++i) {
+        // Every magnitude from single Rappen up to the int64 limits gets its share.
+        const int bits = static_cast<int>(random() % 64);
+        const std::int64_t rappen = static_cast<std::int64_t>(random() >> bits);
+        for (const std::int64_t value : {rappen, -rappen}) {
+            const Money amount = Money::fromRappen(value);
+            const std::string text = format(amount);
+            if (!parsesTo(text, value)) {
+                check(false, "parse(format(x)) == x for " + text);
+                return;
+            }
+        }
+    }
+    for (const std::int64_t value : {std::int64_t{0}, std::int64_t{1}, std::int64_t{-1}, std::int64_t{5}, std::int64_t{-5},
+                                     std::int64_t{100}, kMax, kMin, kMax - 1, kMin + 1}) {
+        check(parsesTo(format(Money::fromRappen(value)), value), "parse(format(x)) == x at " + std::to_string(value));
+    }
+    check(format(Money::fromRappen(kMin)) == "-92233720368547758.08", "INT64_MIN formats");
+    check(format(Money::fromRappen(-5)) == "-0.05", "-0.05 formats");
+    check(format(Money::fromRappen(350)) == "3.50", "3.50 formats");
+}
+
+void testParse() {
+    check(parsesTo("3,5", 350), "comma as decimal point");
+    check(parsesTo(" 1'250.00 CHF", 125000), "apostrophes and CHF suffix");
+    check(parsesTo("chf -2", -200), "CHF prefix and sign");
+    check(parsesTo(".5", 50), "no francs");
+    check(parsesTo("3.505", 351), "third decimal rounds up");
+    check(parsesTo("3.5049", 350), "third decimal rounds down");
+    check(parsesTo("-3.505", -351), "negative rounds away from zero");
+    check(parsesTo("92233720368547758.07", kMax), "largest amount");
+    check(!Money::parse("92233720368547758.08"), "one Rappen too many");
+    check(!Money::parse("92233720368547758.075"), "rounding past the largest amount");
+    check(!Money::parse("-92233720368547758.09"), "one Rappen too few");
+    check(!Money::parse("99999999999999999999"), "too many francs");
+    for (const std::string_view bad : {"", " ", "-", ".", "1e2", "nan", "inf", "1.2.3", "1,2.3", "--1", "1-", "'1", "1'", "12 CHF 3"}) {
+        check(!Money::parse(bad), "rejects \"" + std::string(bad) + '"');
+    }
+}
+
+void testFromDecimal() {
+    check(Money::fromDecimal(1005, -3)->rappen() == 101, "1.005 rounds half away from zero");
+    check(Money::fromDecimal(-1005, -3)->rappen() == -101, "-1.005 rounds half away from zero");
+    check(Money::fromDecimal(65, -1)->rappen() == 650, "6.5");
+    check(Money::fromDecimal(35, 1)->rappen() == 35000, "3.5e1");
+    check(Money::fromDecimal(kMax, -21)->rappen() == 1, "scaled down by 10^19");
+    check(Money::fromDecimal(kMax, -40)->rappen() == 0, "far below a Rappen");
+    check(!Money::fromDecimal(1, 20), "too large to scale up");
+}
+
+void testCheckedArithmetic() {
+    const Money max = Money::fromRappen(kMax);
+    const Money min = Money::fromRappen(kMin);
+    const Money one = Money::fromRappen(1);
+    check(overflows([&] { (void)(max + one); }), "max + 1 overflows");
+    check(overflows([&] { (void)(min - one); }), "min - 1 overflows");
+    check(overflows([&] { (void)(min + -one); }), "min + -1 overflows");
+    check(overflows([&] { (void)(one - min); }), "1 - min overflows");
+    check(overflows([&] { (void)(-min); }), "-min overflows");
+    check(overflows([&] { (void)(Money::fromRappen(kMax / 2 + 1) * 2); }), "multiple past max overflows");
+    check(overflows([&] { (void)(Money::fromRappen(kMax / 3 + 1) * -3); }), "negative multiple overflows");
+    check(overflows([&] { (void)(min * -1); }), "min * -1 overflows");
+    check(!overflows([&] { (void)(max - one + one); }), "max - 1 + 1 fits");
+    check((max + -max).rappen() == 0, "max - max");
+    check((Money::fromRappen(kMax / 2) * 2).rappen() == kMax - 1, "largest even multiple");
+    check((Money::fromRappen(-350) * 3).rappen() == -1050, "negative times quantity");
+    check((Money::fromRappen(350) * 0).rappen() == 0, "times zero");
+
+    Money total;
+    check(overflows([&] {
+        for (int i = 0; i < 3; ++i) {
+            total += Money::fromRappen(kMax / 2);
+        }
+    }), "running total overflows");
+    check(total.rappen() == kMax / 2 * 2, "a sum that overflows stays unchanged");
+}
+
+void testFiveRappenRounding() {
+    // Francs and Rappen the till sees, in both directions.
+    for (std::int64_t rappen = -100000; rappen <= 100000; ++rappen) {
+        const std::int64_t rounded = Money::fromRappen(rappen).roundedToFiveRappen().rappen();
+        const std::int64_t below = rappen - ((rappen % 5) + 5) % 5;
+        const std::int64_t expected = rappen - below >= 3 ? below + 5 : below;
+        if (rounded != expected) {
+            check(false, "rounding " + std::to_string(rappen) + " gave " + std::to_string(rounded));
+            return;
+        }
+    }
+    const auto cash = [](std::string_view text) { return Money::parse(text)->roundedToFiveRappen().rappen(); };
+    check(cash("0.02") == 0, "0.02 pays 0.00");
+    check(cash("0.03") == 5, "0.03 pays 0.05");
+    check(cash("0.07") == 5, "0.07 pays 0.05");
+    check(cash("0.08") == 10, "0.08 pays 0.10");
+    check(cash("0.025") == 5, "0.025 pays 0.05");
+    check(cash("0.075") == 10, "0.075 pays 0.10");
+    check(cash("0.0249") == 0, "0.0249 pays 0.00");
+    check(cash("-0.025") == -5, "-0.025 pays -0.05");
+    check(cash("-0.075") == -10, "-0.075 pays -0.10");
+    check(cash("-0.02") == 0, "-0.02 pays 0.00");
+    check(cash("-0.03") == -5, "-0.03 pays -0.05");
+    check(cash("3.52") == 350, "3.52 pays 3.50");
+    check(cash("3.53") == 355, "3.53 pays 3.55");
+    check(Money::fromRappen(kMax).roundedToFiveRappen().rappen() == kMax - 2, "largest amount rounds down");
+    check(overflows([] { (void)Money::fromRappen(kMin).roundedToFiveRappen(); }), "smallest amount cannot round away");
+}
+
+// Price text as a catalogue or a cashier writes it: two decimals, one, none, or a comma.
+std::string randomAmountText(std::mt19937_64& random, std::uint64_t maxFrancs) {
+    const std::uint64_t francs = random() % (maxFrancs + 1);
+    const std::uint64_t rappen = random() % 100;
+    std::string text = std::to_string(francs);
+    switch (random() % 4) {
+    case 0:
+        break;
+    case 1:
+        text += '.';
+        text += std::to_string(rappen / 10);
+        break;
+    case 2:
+        text += ',';
+        text += std::to_string(rappen / 10);
+        text += std::to_string(rappen % 10);
+        break;
+    default:
+        text += '.';
+        text += std::to_string(rappen / 10);
+        text += std::to_string(rappen % 10);
+        break;
+    }
+    return text;
+}
+
+// What parseAmount() did before Money: commas to points, then std::stod.
+double parseAsDouble(std::string text) {
+    std::replace(text.begin(), text.end(), ',', '.');
+    return std::stod(text);
+}
+
+std::int64_t toRappen(double francs) {
+    return std::llround(francs * 100.0);
+}
+
+struct CartLine {
+    Money price;
+    double priceDouble = 0.0;
+    std::int64_t quantity = 0;
+};
+
+// Sums the way Cart::total() does.
+Money cartTotal(const std::vector<CartLine>& lines) {
+    Money sum;
+    for (const CartLine& line : lines) {
+        sum += line.price * line.quantity;
+    }
+    return sum;
+}
+
+// Each cart is filled from price text, paid with typed credit of which some is taken back
+// again, and totalled once in Money and once in double. Rounded to the Rappen the double
+// results must agree with Money at every size a till sees, and the Money total must not
+// depend on the order of the lines.
+void testRandomCarts() {
+    std::mt19937_64 random(25);
+    for (int cart = 0; cart < 20000; ++cart) {
+        std::vector<CartLine> lines(1 + random() % 80);
+        for (CartLine& line : lines) {
+            const std::string text = randomAmountText(random, random() % 8 == 0 ? 9999 : 99);
+            line.price = *Money::parse(text);
+            line.priceDouble = parseAsDouble(text);
+            // Mostly a few of each, now and then a case of bottles.
+            const std::uint64_t maxQuantity = random() % 16 == 0 ? 500 : 6;
+            line.quantity = 1 + static_cast<std::int64_t>(random() % maxQuantity);
+        }
+        const Money total = cartTotal(lines);
+        double totalDouble = 0.0;
+        for (const CartLine& line : lines) {
+            totalDouble += line.priceDouble * static_cast<double>(line.quantity);
+        }
+
+        Money credit;
+        double creditDouble = 0.0;
+        std::vector<Money> history;
+        std::vector<double> historyDouble;
+        for (std::uint64_t typed = random() % 6; typed != 0; --typed) {
+            const std::string text = randomAmountText(random, 500);
+            history.push_back(*Money::parse(text));
+            historyDouble.push_back(parseAsDouble(text));
+            credit += history.back();
+            creditDouble += historyDouble.back();
+            if (random() % 4 == 0) {
+                credit -= history.back();
+                creditDouble -= historyDouble.back();
+                history.pop_back();
+                historyDouble.pop_back();
+            }
+        }
+        const Money change = credit - total > Money() ? credit - total : Money();
+        const double changeDouble = std::max(creditDouble - totalDouble, 0.0);
+
+        if (total.rappen() != toRappen(totalDouble) || credit.rappen() != toRappen(creditDouble) ||
+            change.rappen() != toRappen(changeDouble)) {
+            check(false, "cart " + std::to_string(cart) + ": total " + format(total) + " against " +
+                             std::to_string(totalDouble) + ", credit " + format(credit) + " against " +
+                             std::to_string(creditDouble));
+            return;
+        }
+        std::shuffle(lines.begin(), lines.end(), random);
+        if (cartTotal(lines) != total) {
+            check(false, "cart " + std::to_string(cart) + " total depends on the order of the lines");
+            return;
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    testRoundTrip();
+    testParse();
+    testFromDecimal();
+    testCheckedArithmetic();
+    testFiveRappenRounding();
+    testRandomCarts();
+    if (failures == 0) {
+        std::cout << "money_test: all checks passed\n";
+    }
+    return failures;
+}
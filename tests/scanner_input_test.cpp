@@ -0,0 +1,237 @@
+// Replays recorded keystroke streams with their timestamps: through BurstDetector to check
+// where typing ends and a scan begins, down to the microsecond at each boundary, and through
+// ScannerInput with a catalogue to check that scans come out as articles and unknown codes
+// and typing as typed text. Exits with the number of failed checks.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "cash_sloth_catalogue.h"
+#include "cash_sloth_scanner_input.h"
+
+namespace {
+
+using cashsloth::BurstDetector;
+using cashsloth::Keystroke;
+using cashsloth::ScannerOutput;
+
+constexpr std::uint64_t kMaxGap = cashsloth::ScanSettings{}.maxGapMicros;
+
+int failures = 0;
+
+void check(bool ok, std::string_view what) {
+    if (!ok) {
+        ++failures;
+        std::cerr << "FAILED: " << what << '\n';
+    }
+}
+
+// Appends `text` to `stream`, one keystroke every `gapMicros` after the previous one.
+void type(std::vector<Keystroke>& stream, std::u16string_view text, std::uint64_t gapMicros, std::uint64_t& now) {
+    for (const char16_t unit : text) {
+        now += gapMicros;
+        stream.push_back(Keystroke{unit, now});
+    }
+}
+
+// Feeds the whole stream and then flushes long after its last keystroke.
+ScannerOutput replay(const std::vector<Keystroke>& stream) {
+    BurstDetector detector;
+    ScannerOutput output;
+    for (const Keystroke& key : stream) {
+        detector.feed(key, output);
+    }
+    detector.flush(stream.empty() ? 0 : stream.back().timeMicros + 10 * kMaxGap, output);
+    return output;
+}
+
+void testTypedStream() {
+    // About 8 characters a second, a quick typist.
+    std::vector<Keystroke> stream;
+    std::uint64_t now = 1000000;
+    type(stream, u"Grüntee 12,50\r", 120000, now);
+    const ScannerOutput output = replay(stream);
+    check(output.codes.empty(), "typing yields no code");
+    check(output.typed == u"Grüntee 12,50\r", "typing comes out as typed, Enter included");
+}
+
+void testScannerBurst() {
+    // A scanner sends a character every few milliseconds and ends with Enter.
+    std::vector<Keystroke> stream;
+    std::uint64_t now = 1000000;
+    type(stream, u"7610000000017\r", 4000, now);
+    ScannerOutput output = replay(stream);
+    check(output.codes == std::vector<std::string>{"7610000000017"}, "burst with Enter is one code");
+    check(output.typed.empty(), "the Enter after a scan is swallowed");
+
+    // Without a suffix the pause after the burst ends it.
+    stream.clear();
+    type(stream, u"4711", 8000, now);
+    output = replay(stream);
+    check(output.codes == std::vector<std::string>{"4711"}, "burst ended by a pause is one code");
+
+    // Typing, a scan and more typing keep their order and their kinds. Reaching for the
+    // scanner takes longer than maxGapMicros, so a scan never starts with the last typed key.
+    stream.clear();
+    type(stream, u"ab", 150000, now);
+    now += 500000;
+    type(stream, u"7610000000024\t", 3000, now);
+    type(stream, u"3", 200000, now);
+    now += 500000;
+    type(stream, u"7610000000031\r", 3000, now);
+    output = replay(stream);
+    check(output.codes == std::vector<std::string>{"7610000000024", "7610000000031"}, "two scans between typing");
+    check(output.typed == u"ab3", "typing around scans");
+}
+
+void testBoundaries() {
+    std::vector<Keystroke> stream;
+    std::uint64_t now = 1000000;
+    type(stream, u"1234\r", kMaxGap, now);
+    check(replay(stream).codes.size() == 1, "a gap of exactly maxGapMicros still belongs to the scan");
+
+    stream.clear();
+    type(stream, u"1234\r", kMaxGap + 1, now);
+    ScannerOutput output = replay(stream);
+    check(output.codes.empty() && output.typed == u"1234\r", "one microsecond more splits the run");
+
+    stream.clear();
+    type(stream, u"123\r", 2000, now);
+    output = replay(stream);
+    check(output.codes.empty() && output.typed == u"123\r", "three fast characters are typing");
+
+    stream.clear();
+    type(stream, u"12 4\r", 2000, now);
+    output = replay(stream);
+    check(output.codes.empty() && output.typed == u"12 4\r", "a space makes a burst typing");
+
+    stream.clear();
+    type(stream, u"Käse\r", 2000, now);
+    output = replay(stream);
+    check(output.codes.empty() && output.typed == u"Käse\r", "non-ASCII makes a burst typing");
+
+    // A keystroke is held until the pause after it is longer than maxGapMicros.
+    BurstDetector detector;
+    output.clear();
+    check(!detector.deadline(), "no deadline while nothing is held");
+    detector.feed(Keystroke{u'9', 5000000}, output);
+    check(detector.deadline() == 5000000 + kMaxGap + 1, "deadline just past the longest gap");
+    detector.flush(5000000 + kMaxGap, output);
+    check(output.empty(), "not decided at exactly maxGapMicros");
+    detector.flush(5000000 + kMaxGap + 1, output);
+    check(output.typed == u"9" && !detector.deadline(), "decided one microsecond later");
+}
+
+// A fake clock the test moves forward, and a batch collector the worker notifies.
+class Replay {
+public:
+    Replay()
+        : input_([this] { return now_.load(); },
+                 [this] {
+                     const std::lock_guard<std::mutex> lock(mutex_);
+                     ++notified_;
+                     ready_.notify_one();
+                 }) {}
+
+    cashsloth::ScannerInput& input() { return input_; }
+
+    // Pushes each keystroke with the clock at its time, as the message loop does.
+    void play(const std::vector<Keystroke>& stream) {
+        for (const Keystroke& key : stream) {
+            now_.store(key.timeMicros);
+            check(input_.push(key), "keystroke fits into the ring");
+        }
+    }
+
+    // Moves the clock past every deadline and collects batches until `done` holds.
+    template <typename Done>
+    cashsloth::ScanBatch collect(Done&& done) {
+        now_.store(now_.load() + 10 * kMaxGap);
+        cashsloth::ScanBatch collected;
+        const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!done(collected) && std::chrono::steady_clock::now() < give_up) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait_for(lock, std::chrono::milliseconds(50), [this] { return notified_ != 0; });
+                notified_ = 0;
+            }
+            cashsloth::ScanBatch batch = input_.takeBatch();
+            collected.articles.insert(collected.articles.end(), batch.articles.begin(), batch.articles.end());
+            collected.unknownCodes.insert(collected.unknownCodes.end(), batch.unknownCodes.begin(),
+                                          batch.unknownCodes.end());
+            collected.typed += batch.typed;
+        }
+        return collected;
+    }
+
+private:
+    std::atomic<std::uint64_t> now_{0};
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    int notified_ = 0;
+    cashsloth::ScannerInput input_;
+};
+
+void testScannerInput() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "cash_sloth_scanner_test.json";
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << R"({"categories": [{"name": "Getraenke", "articles": [
+            {"name": "Gruentee", "price": 3.50, "barcode": "7610000000017"},
+            {"name": "Kaffee", "price": 4.20, "barcode": "4711"}]}]})";
+    }
+    auto catalogue = std::make_shared<cashsloth::Catalogue>();
+    const bool loaded = catalogue->loadFromFile(path, cashsloth::Catalogue::SnapshotCache::Bypass);
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+    check(loaded, "test catalogue loads");
+    if (!loaded) {
+        return;
+    }
+
+    Replay replay;
+    replay.input().setCatalogue(catalogue);
+    std::vector<Keystroke> stream;
+    std::uint64_t now = 1000000;
+    type(stream, u"Tee", 130000, now);
+    now += 500000;
+    type(stream, u"7610000000017\r", 4000, now);
+    type(stream, u"4711\r", 5000, now);
+    type(stream, u"9999999999994\r", 4000, now);
+    type(stream, u"x", 300000, now);
+    replay.play(stream);
+    const cashsloth::ScanBatch batch = replay.collect([](const cashsloth::ScanBatch& collected) {
+        return collected.articles.size() + collected.unknownCodes.size() == 3 && collected.typed.size() == 4;
+    });
+
+    const cashsloth::CatalogueStore& store = catalogue->store();
+    check(batch.articles.size() == 2 && batch.articles[0] == store.handle(*catalogue->findByBarcode("7610000000017")) &&
+              batch.articles[1] == store.handle(*catalogue->findByBarcode("4711")),
+          "scans come out as articles in scan order");
+    check(batch.unknownCodes == std::vector<std::string>{"9999999999994"}, "a code not in the catalogue is unknown");
+    check(batch.typed == u"Teex", "typing comes out as typed text");
+}
+
+}  // namespace
+
+int main() {
+    testTypedStream();
+    testScannerBurst();
+    testBoundaries();
+    testScannerInput();
+    if (failures == 0) {
+        std::cout << "scanner_input_test: all checks passed\n";
+    }
+    return failures;
+}
@@ -0,0 +1,73 @@
+// Reports how one catalogue file differs from another, for reviewing an update before it
+// is rolled out to the tills. Exits with 0 when the catalogues are the same, 1 when they
+// differ and 2 when a file cannot be read, like diff(1).
+
+#include <exception>
+#include <filesystem>
+#include <iostream>
+
+#include "cash_sloth_catalogue.h"
+#include "cash_sloth_catalogue_diff.h"
+
+namespace {
+
+// Reviewing a catalogue must not leave snapshots next to the files.
+bool load(cashsloth::Catalogue& catalogue, const std::filesystem::path& path) {
+    if (catalogue.loadFromFile(path, cashsloth::Catalogue::SnapshotCache::Bypass)) {
+        return true;
+    }
+    std::cerr << "Fehler: Katalog \"" << path.string() << "\" konnte nicht gelesen werden\n";
+    return false;
+}
+
+bool sameCatalogue(const cashsloth::CatalogueStore& left, const cashsloth::CatalogueStore& right) {
+    if (left.categoryCount() != right.categoryCount() || left.articleCount() != right.articleCount()) {
+        return false;
+    }
+    for (std::size_t category = 0; category < left.categoryCount(); ++category) {
+        if (left.categoryName(category) != right.categoryName(category) ||
+            left.firstArticle(category) != right.firstArticle(category)) {
+            return false;
+        }
+    }
+    for (std::size_t article = 0; article < left.articleCount(); ++article) {
+        if (left.name(article) != right.name(article) || left.barcode(article) != right.barcode(article) ||
+            left.priceCents(article) != right.priceCents(article)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Aufruf: cash-sloth-diff <alter-katalog.json> <neuer-katalog.json>\n";
+        return 2;
+    }
+    cashsloth::Catalogue before;
+    cashsloth::Catalogue after;
+    if (!load(before, argv[1]) || !load(after, argv[2])) {
+        return 2;
+    }
+
+    const cashsloth::CatalogueDiff diff = cashsloth::diffCatalogues(before.store(), after.store());
+    cashsloth::writeCatalogueDiff(std::cout, diff, before.store());
+
+    // The report is only as good as the change set, so check that applying it to the old
+    // catalogue really produces the new one.
+    try {
+        cashsloth::Catalogue patched;
+        patched.copyFrom(before);
+        patched.apply(diff);
+        if (!sameCatalogue(patched.store(), after.store())) {
+            std::cerr << "Fehler: Aenderungen ergeben nicht den neuen Katalog\n";
+            return 2;
+        }
+    } catch (const std::exception& exc) {
+        std::cerr << "Fehler: Aenderungen lassen sich nicht anwenden: " << exc.what() << '\n';
+        return 2;
+    }
+    return diff.empty() ? 0 : 1;
+}